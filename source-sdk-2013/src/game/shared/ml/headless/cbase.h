@@ -0,0 +1,20 @@
+#pragma once
+
+// -------------------------------------------------------------------------------------------------
+// Headless stand-in for the game DLL precompiled header. Put headless/ ahead of game/server and
+// game/client on the include path and build with MOTIONLAB_HEADLESS defined - the ml sources then
+// only need public/, tier0, tier1 and mathlib, no engine or game DLL.
+// -------------------------------------------------------------------------------------------------
+#ifndef MOTIONLAB_HEADLESS
+	#error "headless/cbase.h picked up in a non-headless build - check your include paths"
+#endif
+
+#include "tier0/platform.h"
+#include "tier0/dbg.h"
+#include "tier1/strtools.h"
+#include "tier1/convar.h"
+#include "tier1/utlvector.h"
+#include "mathlib/mathlib.h"
+#include "mathlib/vector.h"
+#include "const.h"
+#include "bspflags.h"
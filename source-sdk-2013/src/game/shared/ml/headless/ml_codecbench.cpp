@@ -0,0 +1,150 @@
+// -------------------------------------------------------------------------------------------------
+// Headless benchmark for ml_statecodec. Runs a crowd through the arena, captures every player's
+// PlayerNetState every tick, then delta-encodes each tick against the previous one the way a
+// snapshot stream would, decodes it back and checks the decode matches the quantized state exactly.
+// Reports bits per player per tick (delta and full), encode/decode ns per player, and the worst
+// quantization error against the raw floats.
+//
+//   ml_codecbench [players] [ticks]
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_statecodec.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+
+int main( int argc, char** argv )
+{
+	int   numPlayers = argc > 1 ? atoi( argv[1] ) : 256;
+	int   ticks      = argc > 2 ? atoi( argv[2] ) : 2000;
+	float frameTime  = 1.0f / 128.0f;
+	int   count      = numPlayers * ticks;
+
+	SimWorld world;
+	BuildArena( world );
+	SimBackend backend;
+	backend.Setup( &world );
+	MotionDriver driver;
+	driver.SetBackend( &backend );
+	driver.GetGroundMemory().Reserve( numPlayers );
+
+	CUtlVector<SimPlayer> players;
+	CUtlVector<CMoveData> moves;
+	players.SetCount( numPlayers );
+	moves.SetCount( numPlayers );
+	for ( int i=0; i < numPlayers; ++i )
+	{
+		InitSimMoveData( moves[i], ArenaSpawnPoint( world, i ) );
+		players[i].EntIndex = i + 1;
+	}
+
+	// Simulate once up front, so the timed loops below are just the codec
+	CUtlVector<PlayerNetState>       raw;
+	CUtlVector<QuantizedPlayerState> quantized;
+	raw.SetCount( count );
+	quantized.SetCount( count );
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			ScriptRunInput( tick, i, moves[i] );
+			driver.ProcessMovement( &players[i], &moves[i], frameTime );
+			driver.GetPlayerNetState( raw[ tick * numPlayers + i ] );
+		}
+	}
+
+	// Encode: tick 0 against nothing, every later tick against the one before
+	int bytesPerTick = ( numPlayers * CODEC_MAX_BITS + 7 ) / 8 + 4;
+	CUtlVector<uint8> stream;
+	CUtlVector<int>   tickBits;
+	stream.SetCount( bytesPerTick * ticks );
+	tickBits.SetCount( ticks );
+
+	double t0 = Plat_FloatTime();
+	for ( int n=0; n < count; ++n )
+	{
+		QuantizePlayerState( raw[n], quantized[n] );
+	}
+	double t1 = Plat_FloatTime();
+	int64 deltaBits = 0;
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		bf_write buf( &stream[ tick * bytesPerTick ], bytesPerTick );
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			const QuantizedPlayerState* baseline = tick ? &quantized[ ( tick - 1 ) * numPlayers + i ] : NULL;
+			WritePlayerStateDelta( buf, quantized[ tick * numPlayers + i ], baseline );
+		}
+		tickBits[ tick ] = buf.GetNumBitsWritten();
+		if ( tick )
+		{
+			deltaBits += tickBits[ tick ];
+		}
+	}
+	double t2 = Plat_FloatTime();
+
+	// Decode into a separate copy and hold it to the encoder's side
+	CUtlVector<QuantizedPlayerState> decoded;
+	decoded.SetCount( count );
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		bf_read buf( &stream[ tick * bytesPerTick ], bytesPerTick );
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			const QuantizedPlayerState* baseline = tick ? &decoded[ ( tick - 1 ) * numPlayers + i ] : NULL;
+			if ( !ReadPlayerStateDelta( buf, decoded[ tick * numPlayers + i ], baseline ) )
+			{
+				printf( "OVERFLOW at tick %d, player %d\n", tick, i );
+				return 1;
+			}
+		}
+	}
+	double t3 = Plat_FloatTime();
+
+	float worstVel      = 0.0f;
+	float worstNormal   = 0.0f;
+	float worstFriction = 0.0f;
+	for ( int n=0; n < count; ++n )
+	{
+		if ( !( decoded[n] == quantized[n] ) )
+		{
+			printf( "MISMATCH at tick %d, player %d\n", n / numPlayers, n % numPlayers );
+			return 1;
+		}
+		PlayerNetState back;
+		DequantizePlayerState( decoded[n], back );
+		for ( int i=0; i < 3; ++i )
+		{
+			worstVel = MAX( worstVel, fabsf( back.Velocity[i] - raw[n].Velocity[i] ) );
+		}
+		worstNormal   = MAX( worstNormal, ( back.GroundNormal - raw[n].GroundNormal ).Length() );
+		worstFriction = MAX( worstFriction, fabsf( back.GroundFriction - raw[n].GroundFriction ) );
+	}
+
+	// A full (no baseline) write of every player on the last tick, for comparison
+	bf_write fullBuf( stream.Base(), bytesPerTick );
+	for ( int i=0; i < numPlayers; ++i )
+	{
+		WritePlayerStateDelta( fullBuf, quantized[ ( ticks - 1 ) * numPlayers + i ], NULL );
+	}
+
+	int64 deltaCount = (int64)numPlayers * MAX( ticks - 1, 1 );
+	printf( "players:        %d\n", numPlayers );
+	printf( "ticks:          %d\n", ticks );
+	printf( "raw state:      %d bytes/player\n", (int)sizeof( PlayerNetState ) );
+	printf( "full:           %.2f bits/player (%.2f bytes)\n", (double)fullBuf.GetNumBitsWritten() / numPlayers,
+	        (double)fullBuf.GetNumBitsWritten() / numPlayers / 8.0 );
+	printf( "delta:          %.2f bits/player/tick (%.2f bytes)\n", (double)deltaBits / deltaCount, (double)deltaBits / deltaCount / 8.0 );
+	printf( "quantize:       %.1f ns/player\n", ( t1 - t0 ) * 1e9 / count );
+	printf( "encode:         %.1f ns/player\n", ( t2 - t1 ) * 1e9 / count );
+	printf( "decode:         %.1f ns/player\n", ( t3 - t2 ) * 1e9 / count );
+	printf( "max error:      vel %.4f u/s, normal %.5f, friction %.4f\n", worstVel, worstNormal, worstFriction );
+	printf( "results:        decode matches encode\n" );
+	return 0;
+}
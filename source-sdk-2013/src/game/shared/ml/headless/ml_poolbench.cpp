@@ -0,0 +1,196 @@
+// -------------------------------------------------------------------------------------------------
+// Headless MovementPool benchmark + equivalence check. Moves the same crowd of simulated players
+// twice - once serially through a single MotionDriver, once through a MovementPool - and checks
+// every player's end state matches bit for bit every tick.
+//
+//   ml_poolbench [players] [ticks] [threads] [telemetry.bin]
+//
+// With a telemetry file, every pool worker publishes through its own ring (ml_telemetry.h) for the
+// whole run, so the pooled time includes that, and drops get reported.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_movepool.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+
+struct Crowd
+{
+	CUtlVector<SimPlayer> Players;
+	CUtlVector<CMoveData> Moves;
+	CUtlVector<MoveJob>   Jobs;
+
+	void Spawn( const SimWorld& world, int count )
+	{
+		Players.SetCount( count );
+		Moves.SetCount( count );
+		Jobs.SetCount( count );
+		for ( int i=0; i < count; ++i )
+		{
+			InitSimMoveData( Moves[i], ArenaSpawnPoint( world, i ) );
+			Players[i].EntIndex = i + 1;
+			Jobs[i].Player   = &Players[i];
+			Jobs[i].MoveData = &Moves[i];
+		}
+	}
+
+	void Script( int tick )
+	{
+		for ( int i=0; i < Moves.Count(); ++i )
+		{
+			ScriptRunInput( tick, i, Moves[i] );
+			Players[i].m_nTickBase = tick;  // MovePlayer skips ProcessMovement, which would bump it
+		}
+	}
+};
+
+
+// Bitwise compare of everything PlayerMove writes that we care about
+static bool SameState( const Crowd& a, const Crowd& b, int& firstBad )
+{
+	for ( int i=0; i < a.Moves.Count(); ++i )
+	{
+		const CMoveData& ma = a.Moves[i];
+		const CMoveData& mb = b.Moves[i];
+		if ( Q_memcmp( &ma.GetAbsOrigin(), &mb.GetAbsOrigin(), sizeof( Vector ) ) ||
+		     Q_memcmp( &ma.m_vecVelocity,  &mb.m_vecVelocity,  sizeof( Vector ) ) ||
+		     Q_memcmp( &ma.m_outWishVel,   &mb.m_outWishVel,   sizeof( Vector ) ) ||
+		     ma.m_outStepHeight != mb.m_outStepHeight ||
+		     a.Players[i].GroundEntity != b.Players[i].GroundEntity )
+		{
+			firstBad = i;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+int main( int argc, char** argv )
+{
+	int   numPlayers = argc > 1 ? atoi( argv[1] ) : 1024;
+	int   ticks      = argc > 2 ? atoi( argv[2] ) : 2000;
+	int   numThreads = argc > 3 ? atoi( argv[3] ) : (int)std::thread::hardware_concurrency();
+	const char* telemetryPath = argc > 4 ? argv[4] : NULL;
+	float frameTime  = 1.0f / 128.0f;
+
+	SimWorld world;
+	BuildArena( world );
+
+	// Serial reference
+	Crowd        serial;
+	SimBackend   serialBackend;
+	MotionDriver serialDriver;
+	serial.Spawn( world, numPlayers );
+	serialBackend.Setup( &world );
+	serialDriver.SetBackend( &serialBackend );
+	serialDriver.GetGroundMemory().Reserve( numPlayers );
+
+	// Pooled
+	Crowd        pooled;
+	MovementPool pool;
+	pooled.Spawn( world, numPlayers );
+	pool.Init( numThreads );
+	pool.GetGroundMemory().Reserve( numPlayers );
+	pool.GetHistory().Reserve( numPlayers, 256 );
+	CUtlVector<SimBackend> backends;
+	backends.SetCount( pool.WorkerCount() );
+	for ( int i=0; i < pool.WorkerCount(); ++i )
+	{
+		backends[i].Setup( &world );
+		pool.Driver( i ).SetBackend( &backends[i] );
+	}
+
+	TelemetryStream telemetry;
+	if ( telemetryPath )
+	{
+		if ( !telemetry.Start( telemetryPath, numPlayers * 4 ) )
+		{
+			printf( "couldn't open %s\n", telemetryPath );
+			return 1;
+		}
+		for ( int i=0; i < pool.WorkerCount(); ++i )
+		{
+			pool.Driver( i ).SetTelemetry( telemetry.AddProducer() );
+		}
+	}
+
+	double serialTime = 0.0;
+	double pooledTime = 0.0;
+	int64  steals     = 0;
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		serial.Script( tick );
+		pooled.Script( tick );
+
+		double t0 = Plat_FloatTime();
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			serialDriver.MovePlayer( serial.Jobs[i].Player, serial.Jobs[i].MoveData, frameTime );
+		}
+		double t1 = Plat_FloatTime();
+		pool.Run( pooled.Jobs.Base(), numPlayers, frameTime );
+		double t2 = Plat_FloatTime();
+
+		serialTime += t1 - t0;
+		pooledTime += t2 - t1;
+		for ( int w=0; w < pool.WorkerCount(); ++w )
+		{
+			steals += pool.JobsStolen( w );
+		}
+
+		int bad;
+		if ( !SameState( serial, pooled, bad ) )
+		{
+			printf( "MISMATCH at tick %d, player %d\n", tick, bad );
+			return 1;
+		}
+	}
+
+	printf( "players:        %d\n",    numPlayers );
+	printf( "ticks:          %d\n",    ticks );
+	printf( "threads:        %d\n",    pool.WorkerCount() );
+	printf( "serial:         %.3f ms/tick\n", serialTime * 1000.0 / ticks );
+	printf( "pooled:         %.3f ms/tick\n", pooledTime * 1000.0 / ticks );
+	printf( "speedup:        %.2fx\n", serialTime / pooledTime );
+	printf( "steals/tick:    %.1f\n",  (double)steals / ticks );
+	printf( "results:        identical\n" );
+	printf( "history:        %d KB (%d players x %d ticks)\n", pool.GetHistory().MemoryUsed() / 1024, numPlayers, pool.GetHistory().Ticks() );
+	if ( telemetry.IsRunning() )
+	{
+		for ( int i=0; i < pool.WorkerCount(); ++i )
+		{
+			pool.Driver( i ).SetTelemetry( NULL );
+		}
+		uint64 published = telemetry.Published();
+		uint64 dropped   = telemetry.Dropped();
+		telemetry.Stop();
+		printf( "telemetry:      %llu published, %llu dropped, %llu written\n", published, dropped, telemetry.Written() );
+	}
+
+	MoveCounters counters;
+	for ( int i=0; i < pool.WorkerCount(); ++i )
+	{
+		counters.Merge( pool.Driver( i ).GetMoveCounters() );
+	}
+	printf( "\npooled collision work:\n" );
+	counters.Dump();
+
+#ifdef MOTIONLAB_PROFILE
+	// Every worker kept its own timings, fold them together for one report
+	TickProfiler combined;
+	for ( int i=0; i < pool.WorkerCount(); ++i )
+	{
+		combined.Merge( pool.Driver( i ).GetProfiler() );
+	}
+	printf( "\npooled stage timings:\n" );
+	combined.Dump( 5 );
+#endif
+	return 0;
+}
@@ -0,0 +1,171 @@
+// -------------------------------------------------------------------------------------------------
+// Offline movement replay. Re-runs every PlayerMove in a recording (ml_record on a server, or
+// MotionDriver::StartRecording anywhere) against a ReplayBackend, and checks each tick's output
+// matches what was recorded bit for bit. Doubles as a real-traffic benchmark - pass > 1 to loop.
+//
+//   ml_replay <file> [passes]
+//
+// Bit-identical output assumes the same float codegen as the recording build (SSE2, same
+// compiler flags). Each tick starts from its recorded state, so a mismatch doesn't snowball.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "movevars_shared.h"
+#include "ml_motiondriver.h"
+#include "ml_recording.h"
+#include "ml_replaybackend.h"
+
+using namespace motionlab;
+
+
+static bool LoadFile( const char* path, CUtlBuffer& buf )
+{
+	FILE* fp = fopen( path, "rb" );
+	if ( !fp )
+	{
+		return false;
+	}
+	fseek( fp, 0, SEEK_END );
+	long size = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+
+	buf.EnsureCapacity( size );
+	bool ok = fread( buf.Base(), 1, size, fp ) == (size_t)size;
+	buf.SeekPut( CUtlBuffer::SEEK_HEAD, size );
+	fclose( fp );
+	return ok;
+}
+
+
+// Put player + movedata back exactly how the recorded tick found them
+static void LoadTickStart( const RecTickStart& st, SimPlayer& player, CMoveData& mv )
+{
+	InitSimMoveData( mv, st.Origin );
+	mv.m_flForwardMove = st.ForwardMove;
+	mv.m_flSideMove    = st.SideMove;
+	mv.m_flUpMove      = st.UpMove;
+	mv.m_nButtons      = st.Buttons;
+	mv.m_nOldButtons   = st.OldButtons;
+	mv.m_vecViewAngles = st.ViewAngles;
+	mv.m_vecVelocity   = st.Velocity;
+	mv.m_outWishVel    = st.OutWishVel;
+	mv.m_outJumpVel    = st.OutJumpVel;
+	mv.m_outStepHeight = st.OutStepHeight;
+
+	player.EntIndex                 = st.Player;
+	player.BaseVelocity             = st.BaseVelocity;
+	player.GroundEntity             = ReplayBackend::EntityForId( st.GroundEnt );
+	player.m_Local.m_flFallVelocity = st.FallVelocity;
+	player.HullMins                 = st.HullMins;
+	player.HullMaxs                 = st.HullMaxs;
+	player.StepSize                 = st.StepHeight;
+	player.Observer                 = st.Observer != 0;
+	player.m_surfaceFriction        = st.SurfaceFriction;
+	player.m_chPreviousTextureType  = (char)st.TextureType;
+}
+
+
+int main( int argc, char** argv )
+{
+	if ( argc < 2 )
+	{
+		printf( "usage: ml_replay <file> [passes]\n" );
+		return 2;
+	}
+	int passes = argc > 2 ? MAX( 1, atoi( argv[2] ) ) : 1;
+
+	CUtlBuffer buf;
+	if ( !LoadFile( argv[1], buf ) )
+	{
+		printf( "couldn't read %s\n", argv[1] );
+		return 2;
+	}
+
+	ReplayBackend backend;
+	MotionDriver  driver;
+	SimPlayer     player;
+	CMoveData     mv;
+	driver.SetBackend( &backend );
+
+	int64  ticks      = 0;
+	int64  mismatches = 0;
+	int64  desyncs    = 0;
+	double moveTime   = 0.0;
+	for ( int pass=0; pass < passes; ++pass )
+	{
+		buf.SeekGet( CUtlBuffer::SEEK_HEAD, 0 );
+		if ( !backend.Setup( &buf ) )
+		{
+			printf( "%s isn't a motionlab recording (or is a different version)\n", argv[1] );
+			return 2;
+		}
+		driver.GetGroundMemory().Clear();
+		driver.GetBuildProfiles().Clear();
+
+		int64        tick = 0;
+		RecTickStart st;
+		while ( backend.ReadTickStart( st ) )
+		{
+			LoadTickStart( st, player, mv );
+			driver.SetOptions( UnpackOptions( st.Options ) );
+
+			// Headless the config comes straight off these (GetCurrentGravity is just sv_gravity)
+			sv_gravity.SetValue( st.Gravity );
+			cl_forwardspeed.SetValue( st.ForwardSpeed );
+			cl_backspeed.SetValue( st.BackSpeed );
+			cl_sidespeed.SetValue( st.SideSpeed );
+
+			BuildProfile build( st.Mass, st.DragCoeff, st.BoostForce, st.JumpForce, (MovementArchetype)st.Archetype );
+			BuildProfileStore& builds = driver.GetBuildProfiles();
+			builds.Reserve( st.Player );
+			builds.AssignPlayer( st.Player, builds.FindOrAddProfile( build ) );
+
+			double t0 = Plat_FloatTime();
+			driver.MovePlayer( &player, &mv, st.FrameTime );
+			moveTime += Plat_FloatTime() - t0;
+
+			RecTickEnd recorded;
+			RecTickEnd replayed;
+			backend.SkipToTickEnd( recorded );
+			MakeTickEnd( &player, &mv, ReplayBackend::IdForEntity( player.GetGroundEntity() ), replayed );
+
+			bool desync   = backend.Desynced();
+			bool mismatch = Q_memcmp( &recorded, &replayed, sizeof( RecTickEnd ) ) != 0;
+			if ( pass == 0 && ( desync || mismatch ) )
+			{
+				if ( !mismatches && !desyncs )
+				{
+					printf( "first bad tick: %lld (player %d)%s\n", tick, st.Player, desync ? " - backend queries diverged" : "" );
+					printf( "  recorded origin %.9g %.9g %.9g vel %.9g %.9g %.9g\n", recorded.Origin.x, recorded.Origin.y,
+					        recorded.Origin.z, recorded.Velocity.x, recorded.Velocity.y, recorded.Velocity.z );
+					printf( "  replayed origin %.9g %.9g %.9g vel %.9g %.9g %.9g\n", replayed.Origin.x, replayed.Origin.y,
+					        replayed.Origin.z, replayed.Velocity.x, replayed.Velocity.y, replayed.Velocity.z );
+				}
+				desyncs    += desync ? 1 : 0;
+				mismatches += mismatch ? 1 : 0;
+			}
+			++tick;
+		}
+
+		if ( buf.GetBytesRemaining() > 0 )
+		{
+			printf( "warning: junk after tick %lld, recording truncated?\n", tick );
+		}
+		ticks += tick;
+	}
+
+	if ( !ticks )
+	{
+		printf( "no ticks in %s\n", argv[1] );
+		return 2;
+	}
+
+	printf( "player ticks:   %lld (%d pass%s)\n", ticks, passes, passes > 1 ? "es" : "" );
+	printf( "ticks/sec:      %.0f\n", ticks / moveTime );
+	printf( "ns/tick:        %.1f\n", moveTime * 1e9 / ticks );
+	printf( "mismatches:     %lld\n", mismatches );
+	printf( "desyncs:        %lld\n", desyncs );
+	return ( mismatches || desyncs ) ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include "cbase.h"
+#include "ml_replaybackend.h"
+
+using namespace motionlab;
+
+// Stand-in entity identities, indexed by recording entity id
+static const int REPLAY_MAX_ENTITIES = 1 << 16;
+static char      s_ReplayEntityTags[ REPLAY_MAX_ENTITIES ];
+
+
+ReplayBackend::ReplayBackend()
+{
+	Buf          = NULL;
+	TickDesynced = false;
+}
+
+
+bool ReplayBackend::Setup( CUtlBuffer* buf )
+{
+	Buf          = buf;
+	TickDesynced = false;
+	return ReadRecordingHeader( *Buf, SurfTable );
+}
+
+
+// Consume the next record if it's the expected kind, otherwise leave it and flag the desync
+bool ReplayBackend::Expect( RecordTag tag, void* rec, int size ) const
+{
+	if ( Buf->GetBytesRemaining() < 1 + size || *(const unsigned char*)Buf->PeekGet() != tag )
+	{
+		TickDesynced = true;
+		return false;
+	}
+	Buf->GetUnsignedChar();
+	Buf->Get( rec, size );
+	return true;
+}
+
+
+bool ReplayBackend::ReadTickStart( RecTickStart& rec )
+{
+	if ( Buf->GetBytesRemaining() <= 0 )
+	{
+		return false;
+	}
+	TickDesynced = false;
+	return Expect( REC_TICK_START, &rec, sizeof( rec ) );  // false here = truncated or corrupt
+}
+
+
+int ReplayBackend::SkipToTickEnd( RecTickEnd& rec )
+{
+	int skipped = 0;
+	while ( Buf->GetBytesRemaining() > 0 )
+	{
+		unsigned char tag = *(const unsigned char*)Buf->PeekGet();
+		if ( tag == REC_TICK_END )
+		{
+			Expect( REC_TICK_END, &rec, sizeof( rec ) );
+			break;
+		}
+
+		int size = tag == REC_TRACE      ? sizeof( RecTrace )
+		         : tag == REC_ENTITY_VEL ? sizeof( RecEntityVel )
+		         : tag == REC_TOUCH      ? sizeof( RecTouch ) : -1;
+		if ( size < 0 )
+		{
+			break;  // ran into the next tick (or garbage) without seeing an end
+		}
+		Buf->SeekGet( CUtlBuffer::SEEK_CURRENT, 1 + size );
+		++skipped;
+	}
+
+	if ( skipped )
+	{
+		TickDesynced = true;
+	}
+	return skipped;
+}
+
+
+bool ReplayBackend::Desynced() const
+{
+	return TickDesynced;
+}
+
+
+CBaseEntity* ReplayBackend::EntityForId( int id )
+{
+	if ( id == REC_ENT_NONE )
+	{
+		return NULL;
+	}
+	return reinterpret_cast<CBaseEntity*>( &s_ReplayEntityTags[ clamp( id, 1, REPLAY_MAX_ENTITIES - 1 ) ] );
+}
+
+
+int ReplayBackend::IdForEntity( CBaseEntity* ent )
+{
+	return ent ? (int)( reinterpret_cast<char*>( ent ) - s_ReplayEntityTags ) : REC_ENT_NONE;
+}
+
+
+void ReplayBackend::TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                               unsigned int mask, int collisionGroup, hulltrace& tr )
+{
+	Q_memset( &tr, 0, sizeof( tr ) );
+	tr.startpos = start;
+
+	RecTrace rec;
+	if ( !Expect( REC_TRACE, &rec, sizeof( rec ) ) )
+	{
+		// Already off the rails, just let the tick run out
+		tr.fraction = 1.0f;
+		tr.endpos   = end;
+		return;
+	}
+
+	if ( rec.Start != start || rec.End != end || rec.Mins != mins || rec.Maxs != maxs || rec.Mask != mask )
+	{
+		TickDesynced = true;
+	}
+
+	tr.fraction             = rec.Fraction;
+	tr.endpos               = rec.EndPos;
+	tr.plane.normal         = rec.Normal;
+	tr.plane.dist           = rec.Dist;
+	tr.startsolid           = rec.StartSolid != 0;
+	tr.allsolid             = rec.AllSolid != 0;
+	tr.contents             = rec.Contents;
+	tr.surface.surfaceProps = (unsigned short)rec.SurfaceProps;
+	tr.surface.name         = "**replay**";
+	tr.m_pEnt               = EntityForId( rec.Ent );
+}
+
+
+bool ReplayBackend::TraceHitWorld( const hulltrace& tr ) const
+{
+	return tr.m_pEnt == EntityForId( REC_ENT_WORLD );
+}
+
+
+// Only the flattened table made it into the recording
+surfacedata* ReplayBackend::SurfaceData( int surfaceProps ) const
+{
+	return NULL;
+}
+
+
+int ReplayBackend::SurfacePropCount() const
+{
+	return SurfTable.Count();
+}
+
+
+const SurfaceTable& ReplayBackend::Surfaces() const
+{
+	return SurfTable;
+}
+
+
+Vector ReplayBackend::EntityVelocity( CBaseEntity* ent ) const
+{
+	RecEntityVel rec;
+	if ( !Expect( REC_ENTITY_VEL, &rec, sizeof( rec ) ) )
+	{
+		return vec3_origin;
+	}
+	if ( rec.Ent != IdForEntity( ent ) )
+	{
+		TickDesynced = true;
+	}
+	return rec.Velocity;
+}
+
+
+void ReplayBackend::ResetTouchList()
+{
+}
+
+
+bool ReplayBackend::AddToTouched( const hulltrace& tr, const Vector& impactVel )
+{
+	RecTouch rec;
+	if ( !Expect( REC_TOUCH, &rec, sizeof( rec ) ) )
+	{
+		return false;
+	}
+	return rec.Result != 0;
+}
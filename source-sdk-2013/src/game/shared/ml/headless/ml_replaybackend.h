@@ -0,0 +1,48 @@
+#pragma once
+
+#include "tier1/utlbuffer.h"
+#include "ml_defs.h"
+#include "ml_backend.h"
+#include "ml_recording.h"
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// MotionBackend that answers from a recording (see ml_recording.h) instead of a world. Every
+// query has to arrive in the same order, with the same arguments, as when it was recorded - the
+// first one that doesn't flags the tick as desynced. Recorded entity ids come back as stand-in
+// CBaseEntity pointers (never dereferenced, only compared), same trick as SimWorld's world entity.
+// -------------------------------------------------------------------------------------------------
+class ReplayBackend : public MotionBackend
+{
+	private:
+		CUtlBuffer*  Buf;
+		SurfaceTable SurfTable;
+		mutable bool TickDesynced;
+
+		bool         Expect( RecordTag tag, void* rec, int size ) const;
+
+	public:
+		ReplayBackend();
+		bool         Setup( CUtlBuffer* buf );  // reads the header, false if it's not a recording
+
+		// Tick framing, driven by the replay tool
+		bool         ReadTickStart( RecTickStart& rec );      // false at end of stream
+		int          SkipToTickEnd( RecTickEnd& rec );        // returns how many unconsumed records it skipped
+		bool         Desynced() const;
+
+		static CBaseEntity* EntityForId( int id );
+		static int          IdForEntity( CBaseEntity* ent );
+
+		virtual void         TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                                unsigned int mask, int collisionGroup, hulltrace& tr ) OVERRIDE;
+		virtual bool         TraceHitWorld( const hulltrace& tr ) const OVERRIDE;
+		virtual surfacedata* SurfaceData( int surfaceProps ) const OVERRIDE;
+		virtual int          SurfacePropCount() const OVERRIDE;
+		virtual const SurfaceTable& Surfaces() const OVERRIDE;
+		virtual Vector       EntityVelocity( CBaseEntity* ent ) const OVERRIDE;
+		virtual void         ResetTouchList() OVERRIDE;
+		virtual bool         AddToTouched( const hulltrace& tr, const Vector& impactVel ) OVERRIDE;
+};
+
+} // namespace motionlab
@@ -0,0 +1,129 @@
+// -------------------------------------------------------------------------------------------------
+// Headless per-scenario benchmark. Runs every scenario in ml_scenarios (or just the named one) on a
+// fresh driver and world and reports, per scenario, ns/tick, hull traces per tick by caller and
+// what Slide/Step/StayOnGround ended up doing - so a change's cost or saving shows up against the
+// movement situation that caused it.
+//
+//   ml_scenariobench [ticks] [scenario]
+//
+// MOTIONLAB_PROFILE builds also print per-function times per scenario: CategorizePosition,
+// CalcCurrentForces, Move and, inside it, Slide, SolveClipVelocity, Step and StayOnGround.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_simworld.h"
+#include "ml_scenarios.h"
+
+using namespace motionlab;
+
+#ifdef MOTIONLAB_PROFILE
+static const int s_ProfiledStages[] =
+{
+	MLSTAGE_CATEGORIZE,
+	MLSTAGE_FORCES,
+	MLSTAGE_MOVE,
+	MLSTAGE_MOVE_SLIDE,
+	MLSTAGE_MOVE_CLIPVELOCITY,
+	MLSTAGE_MOVE_STEP,
+	MLSTAGE_MOVE_STAYONGROUND,
+};
+#endif
+
+
+static void RunScenario( const MoveScenario& scenario, int ticks, float frameTime )
+{
+	SimWorld world;
+	scenario.Build( world );
+	world.BuildTree();
+	SimBackend backend;
+	backend.Setup( &world );
+	MotionDriver driver;
+	driver.SetBackend( &backend );
+
+	SimPlayer player;
+	CMoveData mv;
+
+	double start = Plat_FloatTime();
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		ScenarioInput( scenario, tick, player, mv );
+		driver.ProcessMovement( &player, &mv, frameTime );
+	}
+	double elapsed = Plat_FloatTime() - start;
+
+	const MoveCounters& c = driver.GetMoveCounters();
+	int64 slides    = 0;
+	int64 bumps     = 0;
+	int64 requested = 0;
+	for ( int i=0; i < TRACE_CALLER_COUNT; ++i )
+	{
+		requested += c.TracesRequested[i];
+	}
+	for ( int i=0; i <= MAX_BUMPS; ++i )
+	{
+		slides += c.SlideBumps[i];
+		bumps  += c.SlideBumps[i] * i;
+	}
+
+	printf( "\n%s - %s\n", scenario.Name, scenario.Path );
+	printf( "  %.1f ns/tick, %.2f traces/tick (%.2f asked for), %.2f bumps/slide\n", elapsed * 1e9 / ticks,
+	        (double)c.TotalTracesIssued() / ticks, (double)requested / ticks, slides ? (double)bumps / slides : 0.0 );
+
+	printf( "  traces/tick:" );
+	for ( int i=0; i < TRACE_CALLER_COUNT; ++i )
+	{
+		if ( c.TracesRequested[i] )
+		{
+			printf( " %s %.2f", TraceCallerName( i ), (double)c.TracesIssued[i] / ticks );
+		}
+	}
+	printf( "\n" );
+	printf( "  per 1k ticks: creases %.1f, corners %.1f, steps taken %.1f / straight %.1f / steep %.1f / skipped %.1f, snaps %.1f\n",
+	        c.Creases * 1000.0 / ticks, c.Corners * 1000.0 / ticks, c.StepsTaken * 1000.0 / ticks, c.StepsStraight * 1000.0 / ticks,
+	        c.StepsSteep * 1000.0 / ticks, c.StepsSkipped * 1000.0 / ticks, c.GroundSnaps * 1000.0 / ticks );
+
+#ifdef MOTIONLAB_PROFILE
+	const TickProfiler& prof = driver.GetProfiler();
+	printf( "  %-24s %9s %9s %9s %9s\n", "function", "calls/tick", "mean ns", "p99 ns", "ns/tick" );
+	for ( int i=0; i < ARRAYSIZE( s_ProfiledStages ); ++i )
+	{
+		const StageHistogram& h = prof.GetStage( s_ProfiledStages[i] );
+		printf( "  %-24s %9.2f %9.1f %9.1f %9.1f\n", StageName( s_ProfiledStages[i] ), (double)h.Count / ticks,
+		        h.Mean(), h.Percentile( 0.99f ), h.Total / ticks );
+	}
+#endif
+}
+
+
+int main( int argc, char** argv )
+{
+	int         ticks     = argc > 1 ? atoi( argv[1] ) : 200000;
+	const char* only      = argc > 2 ? argv[2] : NULL;
+	float       frameTime = 1.0f / 128.0f;
+
+	int first = 0;
+	int last  = ScenarioCount() - 1;
+	if ( only )
+	{
+		first = last = FindScenario( only );
+		if ( first < 0 )
+		{
+			printf( "no scenario '%s', have:\n", only );
+			for ( int i=0; i < ScenarioCount(); ++i )
+			{
+				printf( "  %-16s %s\n", GetScenario( i ).Name, GetScenario( i ).Path );
+			}
+			return 1;
+		}
+	}
+
+	printf( "ticks:          %d per scenario @ %.0f Hz\n", ticks, 1.0f / frameTime );
+	for ( int i=first; i <= last; ++i )
+	{
+		RunScenario( GetScenario( i ), ticks, frameTime );
+	}
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include "cbase.h"
+#include "igamemovement.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+#include "ml_simplayer.h"
+#include "ml_simmovement.h"
+#include "ml_scenarios.h"
+
+using namespace motionlab;
+
+// 320u/s at 128 tick is 2.5u a tick - loop lengths below are sized off that
+
+
+// ----- Geometry helpers --------------------------------------------------------------------------
+
+static void AddFloor( SimWorld& world, const Vector& center )
+{
+	world.AddBox( center + Vector( -512.0f, -512.0f, -64.0f ), center + Vector( 2048.0f, 512.0f, 0.0f ) );
+}
+
+
+// Vertical wall slab facing along a horizontal normal, its face through point. Arbitrary angles
+// on purpose: axis-aligned walls land hull faces on nice round coordinates, these don't.
+static void AddWallSlab( SimWorld& world, const Vector& point, float yaw, float halfWidth, float height )
+{
+	Vector normal( cosf( DEG2RAD( yaw ) ), sinf( DEG2RAD( yaw ) ), 0.0f );
+	Vector side( -normal.y, normal.x, 0.0f );
+	plane sides[ 6 ] = {
+		MakePlane( normal,           point ),
+		MakePlane( -normal,          point - normal * 64.0f ),
+		MakePlane( side,             point + side * halfWidth ),
+		MakePlane( -side,            point - side * halfWidth ),
+		MakePlane( Vector( 0.0f, 0.0f,  1.0f ), point + Vector( 0.0f, 0.0f, height ) ),
+		MakePlane( Vector( 0.0f, 0.0f, -1.0f ), point ),
+	};
+	world.AddBrush( sides, ARRAYSIZE( sides ) );
+}
+
+
+// ----- Scenario worlds ---------------------------------------------------------------------------
+
+static void BuildFlat( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+}
+
+// ~27 deg, normal.z 0.89
+static void BuildSlopeWalkable( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	AddRamp( world, 64.0f, 512.0f, 256.0f, -256.0f, 256.0f );
+}
+
+// ~51 deg, normal.z 0.62
+static void BuildSlopeSteep( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	AddRamp( world, 64.0f, 128.0f, 160.0f, -256.0f, 256.0f );
+}
+
+// Risers exactly one default step (18u) high
+static void BuildStairs( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	for ( int i=0; i < 16; ++i )
+	{
+		float x = 64.0f + i * 24.0f;
+		world.AddBox( Vector( x, -256.0f, 0.0f ), Vector( 1024.0f, 256.0f, ( i + 1 ) * 18.0f ) );
+	}
+}
+
+// Steep slope with a wall along its side - running diagonally into both slides up the edge between them
+static void BuildCrease( SimWorld& world )
+{
+	BuildSlopeSteep( world );
+	world.AddBox( Vector( -512.0f, 64.0f, 0.0f ), Vector( 1024.0f, 128.0f, 256.0f ) );
+}
+
+// Inside corner of two walls under a low ceiling
+static void BuildCorner3( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	world.AddBox( Vector(  128.0f, -256.0f,  0.0f ), Vector( 192.0f, 256.0f, 256.0f ) );
+	world.AddBox( Vector( -256.0f,  128.0f,  0.0f ), Vector( 256.0f, 192.0f, 256.0f ) );
+	world.AddBox( Vector( -256.0f, -256.0f, 80.0f ), Vector( 256.0f, 256.0f, 144.0f ) );
+}
+
+// Wall at 213 deg through an off-grid point, faced head on
+static void BuildStuckEdge( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	AddWallSlab( world, Vector( 96.37f, 17.91f, 0.0f ), 213.0f, 256.0f, 256.0f );
+}
+
+// Same again ~15000u out, where float spacing is a good chunk of DIST_EPSILON
+static void BuildStuckEdgeFar( SimWorld& world )
+{
+	Vector offset( 12000.0f, 9000.0f, 0.0f );
+	AddFloor( world, offset );
+	AddWallSlab( world, offset + Vector( 96.37f, 17.91f, 0.0f ), 213.0f, 256.0f, 256.0f );
+}
+
+// Walking down 12u drops, each one under a step - StayOnGround should hold us to every tread
+static void BuildLedgeSteps( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	world.AddBox( Vector( -256.0f, -256.0f, 0.0f ), Vector( 32.0f, 256.0f, 132.0f ) );
+	for ( int i=1; i <= 10; ++i )
+	{
+		float x = i * 32.0f;
+		world.AddBox( Vector( x, -256.0f, 0.0f ), Vector( x + 32.0f, 256.0f, 132.0f - i * 12.0f ) );
+	}
+}
+
+// One 64u drop - too far for StayOnGround, we should fall
+static void BuildLedgeHigh( SimWorld& world )
+{
+	AddFloor( world, vec3_origin );
+	world.AddBox( Vector( -256.0f, -256.0f, 0.0f ), Vector( 64.0f, 256.0f, 64.0f ) );
+}
+
+
+static const MoveScenario s_Scenarios[] =
+{
+	{ "flat_run",       "Slide, no contacts; CategorizePosition on flat ground",
+	  BuildFlat,          Vector( 0.0f, 0.0f, 1.0f ),        Vector( 320.0f, 0.0f, 0.0f ),     192 },
+	{ "slope_walkable", "run up a slope above GROUND_MIN_DOT",
+	  BuildSlopeWalkable, Vector( 0.0f, 0.0f, 1.0f ),        Vector( 320.0f, 0.0f, 0.0f ),     160 },
+	{ "slope_steep",    "run into a slope below GROUND_MIN_DOT",
+	  BuildSlopeSteep,    Vector( 0.0f, 0.0f, 1.0f ),        Vector( 320.0f, 0.0f, 0.0f ),     128 },
+	{ "stairs",         "Step up risers exactly StepHeight() tall",
+	  BuildStairs,        Vector( 0.0f, 0.0f, 1.0f ),        Vector( 320.0f, 0.0f, 0.0f ),     160 },
+	{ "crease",         "Slide along the edge between a steep slope and a wall",
+	  BuildCrease,        Vector( 0.0f, 16.0f, 1.0f ),       Vector( 226.0f, 226.0f, 0.0f ),   128 },
+	{ "corner3",        "jump into two walls and a ceiling at once",
+	  BuildCorner3,       Vector( 64.0f, 64.0f, 1.0f ),      Vector( 226.0f, 226.0f, 220.0f ),  48 },
+	{ "stuck_edge",     "CheckTraceStuck against an off-grid angled wall",
+	  BuildStuckEdge,     Vector( 0.0f, 0.0f, 1.0f ),        Vector( 268.4f, 174.3f, 0.0f ),   256 },
+	{ "stuck_edge_far", "...and the same far from the origin",
+	  BuildStuckEdgeFar,  Vector( 12000.0f, 9000.0f, 1.0f ), Vector( 268.4f, 174.3f, 0.0f ),   256 },
+	{ "ledge_steps",    "StayOnGround down 12u drops",
+	  BuildLedgeSteps,    Vector( 0.0f, 0.0f, 133.0f ),      Vector( 320.0f, 0.0f, 0.0f ),     160 },
+	{ "ledge_high",     "StayOnGround giving up on a 64u drop",
+	  BuildLedgeHigh,     Vector( 0.0f, 0.0f, 65.0f ),       Vector( 320.0f, 0.0f, 0.0f ),      64 },
+};
+
+
+int motionlab::ScenarioCount()
+{
+	return ARRAYSIZE( s_Scenarios );
+}
+
+
+const MoveScenario& motionlab::GetScenario( int index )
+{
+	return s_Scenarios[ index ];
+}
+
+
+int motionlab::FindScenario( const char* name )
+{
+	for ( int i=0; i < ARRAYSIZE( s_Scenarios ); ++i )
+	{
+		if ( !Q_stricmp( s_Scenarios[i].Name, name ) )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+void motionlab::ScenarioInput( const MoveScenario& scenario, int tick, SimPlayer& player, CMoveData& mv )
+{
+	if ( tick % scenario.LoopTicks == 0 )
+	{
+		int entIndex = player.EntIndex;
+		player = SimPlayer();
+		player.EntIndex = entIndex;
+		InitSimMoveData( mv, scenario.Start );
+		mv.m_vecVelocity = scenario.Velocity;
+	}
+
+	// Face where we're going. Velocity is scripted directly, same as ScriptRunInput.
+	QAngle angles;
+	VectorAngles( Vector( scenario.Velocity.x, scenario.Velocity.y, 0.0f ), angles );
+	mv.m_vecViewAngles = angles;
+	mv.m_vecAngles     = angles;
+	mv.m_flForwardMove = scenario.Velocity.Length2D();
+	mv.m_flSideMove    = 0.0f;
+	mv.m_nButtons      = 0;
+	mv.m_vecVelocity.x = scenario.Velocity.x;
+	mv.m_vecVelocity.y = scenario.Velocity.y;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+
+class CMoveData;
+
+namespace motionlab {
+
+class SimWorld;
+class SimPlayer;
+
+// -------------------------------------------------------------------------------------------------
+// Canned collision scenarios, each a tiny world plus one player doing one thing over and over, so
+// a bench can pin a performance change on a specific movement situation instead of on the arena
+// as a whole. The player is put back at Start every LoopTicks, so a scenario keeps hitting its
+// code path however long it runs.
+// -------------------------------------------------------------------------------------------------
+struct MoveScenario
+{
+	const char* Name;
+	const char* Path;        // what it's there to exercise
+	void      (*Build)( SimWorld& world );
+	Vector      Start;
+	Vector      Velocity;    // set on every reset; x/y are held every tick after that
+	int         LoopTicks;
+};
+
+int                 ScenarioCount();
+const MoveScenario& GetScenario( int index );
+int                 FindScenario( const char* name );  // -1 if there's no such scenario
+
+// Input for one tick. Resets player and move data on loop boundaries.
+void                ScenarioInput( const MoveScenario& scenario, int tick, SimPlayer& player, CMoveData& mv );
+
+} // namespace motionlab
@@ -0,0 +1,198 @@
+#include "cbase.h"
+#include "igamemovement.h"
+#include "in_buttons.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+static const float ARENA_HALF = 1024.0f;
+static const float ARENA_WALL = 256.0f;
+
+
+// Build a plane from an outward normal and a point on it
+plane motionlab::MakePlane( const Vector& normal, const Vector& point )
+{
+	plane pl;
+	Q_memset( &pl, 0, sizeof( pl ) );
+	pl.normal = normal;
+	VectorNormalize( pl.normal );
+	pl.dist   = DotProduct( pl.normal, point );
+	return pl;
+}
+
+
+// Wedge running along +x, rising from z=0 at x=x0 to z=height at x=x0+length
+void motionlab::AddRamp( SimWorld& world, float x0, float length, float height, float y0, float y1, int surfaceProps )
+{
+	plane sides[ 5 ] = {
+		MakePlane( Vector( -height, 0.0f, length ), Vector( x0, 0.0f, 0.0f ) ),  // slope
+		MakePlane( Vector(  0.0f,  0.0f, -1.0f ),   Vector( 0.0f, 0.0f, 0.0f ) ),
+		MakePlane( Vector(  1.0f,  0.0f,  0.0f ),   Vector( x0 + length, 0.0f, 0.0f ) ),
+		MakePlane( Vector(  0.0f, -1.0f,  0.0f ),   Vector( 0.0f, y0, 0.0f ) ),
+		MakePlane( Vector(  0.0f,  1.0f,  0.0f ),   Vector( 0.0f, y1, 0.0f ) ),
+	};
+	world.AddBrush( sides, ARRAYSIZE( sides ), surfaceProps );
+}
+
+
+void motionlab::BuildArena( SimWorld& world )
+{
+	const float half = ARENA_HALF;
+	const float wall = ARENA_WALL;
+
+	// Floor and surrounding walls
+	world.AddBox( Vector( -half, -half, -64.0f ), Vector( half, half, 0.0f ) );
+	world.AddBox( Vector( -half - 64.0f, -half, 0.0f ), Vector( -half, half, wall ) );
+	world.AddBox( Vector(  half, -half, 0.0f ), Vector( half + 64.0f, half, wall ) );
+	world.AddBox( Vector( -half, -half - 64.0f, 0.0f ), Vector( half, -half, wall ) );
+	world.AddBox( Vector( -half,  half, 0.0f ), Vector( half, half + 64.0f, wall ) );
+
+	// Stair flight, 16u risers (under the default 18u step height)
+	for ( int i=0; i < 8; ++i )
+	{
+		float x = 256.0f + i * 32.0f;
+		world.AddBox( Vector( x, -128.0f, 0.0f ), Vector( half, 0.0f, ( i + 1 ) * 16.0f ) );
+	}
+
+	// Walkable ramp (~27 deg) and one too steep to stand on (~56 deg)
+	AddRamp( world, -512.0f, 256.0f, 128.0f, 128.0f, 256.0f );
+	AddRamp( world, -512.0f, 128.0f, 192.0f, -256.0f, -128.0f );
+
+	// Some pillars to grind against
+	for ( int i=0; i < 4; ++i )
+	{
+		float y = -640.0f + i * 160.0f;
+		world.AddBox( Vector( -64.0f, y, 0.0f ), Vector( 64.0f, y + 64.0f, 192.0f ) );
+	}
+
+	world.BuildTree();
+}
+
+
+// Walks a grid over the arena floor, skipping cells whose hull would start in solid
+Vector motionlab::ArenaSpawnPoint( const SimWorld& world, int index )
+{
+	const float spacing  = 48.0f;
+	const int   gridSide = (int)( ( ARENA_HALF * 2.0f - 64.0f ) / spacing );
+	const Vector hullMins( -16.0f, -16.0f, 0.0f );
+	const Vector hullMaxs(  16.0f,  16.0f, 72.0f );
+
+	int found = -1;
+	for ( int cell=0; ; ++cell )
+	{
+		int    wrapped = cell % ( gridSide * gridSide );
+		int    layer   = cell / ( gridSide * gridSide );  // stack players up once the floor runs out
+		Vector pos( -ARENA_HALF + 32.0f + ( wrapped % gridSide ) * spacing,
+		            -ARENA_HALF + 32.0f + ( wrapped / gridSide ) * spacing,
+		            1.0f + layer * 80.0f );
+
+		hulltrace tr;
+		world.TraceHull( pos, pos, hullMins, hullMaxs, MASK_PLAYERSOLID, tr );
+		if ( !tr.startsolid && ++found == index )
+		{
+			return pos;
+		}
+	}
+}
+
+
+static const char* s_ScriptPatternNames[ SCRIPT_PATTERN_COUNT ] =
+{
+	"run",
+	"strafe",
+	"jump",
+	"wallhug",
+	"idle",
+};
+
+
+const char* motionlab::ScriptPatternName( int pattern )
+{
+	return ( pattern >= 0 && pattern < SCRIPT_PATTERN_COUNT ) ? s_ScriptPatternNames[ pattern ] : "?";
+}
+
+
+void motionlab::ScriptRunInput( int tick, int playerIndex, CMoveData& mv )
+{
+	const float runSpeed = 320.0f;
+	const int   phase    = playerIndex * 37;
+
+	float yaw = fmodf( ( tick + phase ) * 0.35f, 360.0f );
+	mv.m_vecViewAngles.Init( 0.0f, yaw, 0.0f );
+	mv.m_vecAngles     = mv.m_vecViewAngles;
+	mv.m_flForwardMove = runSpeed;
+	mv.m_nButtons      = ( ( tick + phase ) % 97 ) == 0 ? IN_JUMP : 0;
+
+	Vector fwd;
+	AngleVectors( mv.m_vecViewAngles, &fwd );
+	mv.m_vecVelocity.x = fwd.x * runSpeed;
+	mv.m_vecVelocity.y = fwd.y * runSpeed;
+}
+
+
+void motionlab::ScriptInput( ScriptPattern pattern, int tick, int playerIndex, CMoveData& mv )
+{
+	const float runSpeed = 320.0f;
+	const int   phase    = playerIndex * 37;
+
+	switch ( pattern )
+	{
+		case SCRIPT_RUN:
+		{
+			ScriptRunInput( tick, playerIndex, mv );
+			return;
+		}
+		case SCRIPT_STRAFE:
+		{
+			float side = ( ( tick + phase ) / 64 ) & 1 ? runSpeed : -runSpeed;
+			mv.m_vecViewAngles.Init( 0.0f, (float)( phase % 360 ), 0.0f );
+			mv.m_vecAngles     = mv.m_vecViewAngles;
+			mv.m_flForwardMove = 0.0f;
+			mv.m_flSideMove    = side;
+			mv.m_nButtons      = 0;
+
+			Vector fwd, right;
+			AngleVectors( mv.m_vecViewAngles, &fwd, &right, NULL );
+			mv.m_vecVelocity.x = right.x * side;
+			mv.m_vecVelocity.y = right.y * side;
+			return;
+		}
+		case SCRIPT_JUMP:
+		{
+			ScriptRunInput( tick, playerIndex, mv );
+			mv.m_nButtons = IN_JUMP;
+			return;
+		}
+		case SCRIPT_WALLHUG:
+		{
+			// Into whichever wall is nearest, 20 degrees off parallel, turning around every few seconds
+			// so nobody just sits in a corner
+			const Vector& pos = mv.GetAbsOrigin();
+			Vector into    = fabsf( pos.x ) > fabsf( pos.y ) ? Vector( pos.x < 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f )
+			                                                 : Vector( 0.0f, pos.y < 0.0f ? -1.0f : 1.0f, 0.0f );
+			Vector along   = CrossProduct( into, WORLD_UP ) * ( ( ( tick + phase ) / 512 ) & 1 ? 1.0f : -1.0f );
+			Vector dir     = into * 0.342f + along * 0.940f;
+
+			QAngle angles;
+			VectorAngles( dir, angles );
+			mv.m_vecViewAngles = angles;
+			mv.m_vecAngles     = angles;
+			mv.m_flForwardMove = runSpeed;
+			mv.m_flSideMove    = 0.0f;
+			mv.m_nButtons      = 0;
+			mv.m_vecVelocity.x = dir.x * runSpeed;
+			mv.m_vecVelocity.y = dir.y * runSpeed;
+			return;
+		}
+		default:
+		{
+			mv.m_flForwardMove = 0.0f;
+			mv.m_flSideMove    = 0.0f;
+			mv.m_nButtons      = 0;
+			mv.m_vecVelocity.x = 0.0f;
+			mv.m_vecVelocity.y = 0.0f;
+			return;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+
+class CMoveData;
+
+namespace motionlab {
+
+class SimWorld;
+
+// -------------------------------------------------------------------------------------------------
+// Shared fixtures for the headless benches: a small arena with a bit of everything (walls, stairs,
+// ramps either side of GROUND_MIN_DOT, pillars) plus scripted per-player input.
+// -------------------------------------------------------------------------------------------------
+
+plane  MakePlane( const Vector& normal, const Vector& point );
+void   AddRamp( SimWorld& world, float x0, float length, float height, float y0, float y1, int surfaceProps = 0 );
+void   BuildArena( SimWorld& world );
+
+// Spread-out spawn spots that don't start inside a brush. Deterministic per index.
+Vector ArenaSpawnPoint( const SimWorld& world, int index );
+
+// Run in a slowly turning circle, hopping now and then. Phase varies by player so a crowd doesn't
+// move in lockstep. Velocity is scripted directly, since the placeholder build constants in
+// MLabPlayer can't move a player through WASD on their own.
+void   ScriptRunInput( int tick, int playerIndex, CMoveData& mv );
+
+// More input patterns for crowd benches. SCRIPT_RUN is ScriptRunInput.
+enum ScriptPattern
+{
+	SCRIPT_RUN = 0,
+	SCRIPT_STRAFE,   // side to side, flipping every half second or so
+	SCRIPT_JUMP,     // jump held, running in a slow circle
+	SCRIPT_WALLHUG,  // run at a shallow angle into the nearest arena wall and grind along it
+	SCRIPT_IDLE,     // no input at all
+
+	SCRIPT_PATTERN_COUNT
+};
+
+const char* ScriptPatternName( int pattern );
+void        ScriptInput( ScriptPattern pattern, int tick, int playerIndex, CMoveData& mv );
+
+} // namespace motionlab
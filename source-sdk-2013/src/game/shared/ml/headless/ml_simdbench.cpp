@@ -0,0 +1,164 @@
+// -------------------------------------------------------------------------------------------------
+// Headless microbenchmark for the ml_simd.h kernels. Runs each kernel over the same batch of random
+// inputs against a plain-Vector reference (what motionlab used to do: separate Length() and
+// VectorNormalize() calls, each with its own sqrt), and reports ns/op for both plus the worst
+// relative difference between them.
+//
+//   ml_simdbench [count] [reps]
+//
+// For the in-tick effect, build ml_tickbench with and without MOTIONLAB_SCALAR_MATH and compare
+// ns/tick - this file builds either way too, in which case both columns are scalar.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "ml_simd.h"
+#include "ml_forcemath.h"
+
+using namespace motionlab;
+
+
+// ----- Reference versions ------------------------------------------------------------------------
+
+static Vector RefProject( const Vector& v, const Vector& n )
+{
+	return v - n * DotProduct( v, n );
+}
+
+static Vector RefNormalize( const Vector& v )
+{
+	Vector r = v;
+	VectorNormalize( r );
+	return r;
+}
+
+static Vector RefRescale( const Vector& v, float len )
+{
+	Vector r = v;
+	VectorNormalize( r );
+	return r * len;
+}
+
+static Vector RefDeflect( const Vector& v, const Vector& n, float overbounce )
+{
+	Vector d = v - n * ( DotProduct( v, n ) * overbounce );
+	float  adjust = DotProduct( d, n );
+	if ( adjust < 0.0f )
+	{
+		d -= n * adjust;
+	}
+	return d;
+}
+
+static Vector RefCross( const Vector& a, const Vector& b )
+{
+	return CrossProduct( a, b );
+}
+
+// Old FrictionForce: project, Length(), then renormalize the tangent for the direction
+static Vector RefFriction( const Vector& vel, const Vector& n, float friction, float mass, float gravity, float dt )
+{
+	Vector tangentV = RefProject( vel, n );
+	float  tanSpeed = tangentV.Length();
+	if ( tanSpeed <= 0.0f )
+	{
+		return vec3_origin;
+	}
+	float f = MIN( friction * mass * gravity * n.z, tanSpeed * mass / dt );
+	Vector fDir = tangentV * -1.0f;
+	VectorNormalize( fDir );
+	return fDir * f;
+}
+
+
+// ----- Harness -----------------------------------------------------------------------------------
+
+static CUtlVector<Vector> InA;
+static CUtlVector<Vector> InB;  // unit length
+static CUtlVector<Vector> OutRef;
+static CUtlVector<Vector> OutFast;
+
+static float RandF()
+{
+	return ( rand() / (float)RAND_MAX ) * 2.0f - 1.0f;
+}
+
+static double RelDiff( const Vector& a, const Vector& ref )
+{
+	double refLen = ref.Length();
+	double diff   = ( a - ref ).Length();
+	return refLen > 1e-6 ? diff / refLen : diff;
+}
+
+template< typename Fn >
+static double TimeIt( int count, int reps, CUtlVector<Vector>& out, Fn fn )
+{
+	double start = Plat_FloatTime();
+	for ( int r=0; r < reps; ++r )
+	{
+		for ( int i=0; i < count; ++i )
+		{
+			out[i] = fn( i );
+		}
+	}
+	return ( Plat_FloatTime() - start ) * 1e9 / ( (double)count * reps );
+}
+
+template< typename RefFn, typename FastFn >
+static void Bench( const char* name, int count, int reps, RefFn ref, FastFn fast )
+{
+	double refNs  = TimeIt( count, reps, OutRef, ref );
+	double fastNs = TimeIt( count, reps, OutFast, fast );
+	double worst  = 0.0;
+	for ( int i=0; i < count; ++i )
+	{
+		worst = MAX( worst, RelDiff( OutFast[i], OutRef[i] ) );
+	}
+	printf( "%-12s %8.2f %8.2f   %5.2fx   %.2e\n", name, refNs, fastNs, fastNs > 0.0 ? refNs / fastNs : 0.0, worst );
+}
+
+
+int main( int argc, char** argv )
+{
+	int count = argc > 1 ? atoi( argv[1] ) : 4096;  // small enough to stay in L1/L2
+	int reps  = argc > 2 ? atoi( argv[2] ) : 2000;
+
+	InA.SetCount( count );
+	InB.SetCount( count );
+	OutRef.SetCount( count );
+	OutFast.SetCount( count );
+	srand( 1 );
+	for ( int i=0; i < count; ++i )
+	{
+		InA[i] = Vector( RandF(), RandF(), RandF() ) * 500.0f;
+		InB[i] = Vector( RandF(), RandF(), RandF() + 1.5f );  // mostly up-facing, like ground normals
+		VectorNormalize( InB[i] );
+	}
+
+#ifdef MOTIONLAB_SSE
+	printf( "kernels: SSE\n" );
+#else
+	printf( "kernels: scalar (MOTIONLAB_SCALAR_MATH or no SSE)\n" );
+#endif
+	printf( "%-12s %8s %8s   %6s   %s\n", "kernel", "ref ns", "vec4 ns", "speed", "max rel diff" );
+
+	Bench( "project", count, reps,
+	       []( int i ) { return RefProject( InA[i], InB[i] ); },
+	       []( int i ) { return Vec4Store( Vec4ProjectOntoPlane( Vec4Load( InA[i] ), Vec4Load( InB[i] ) ) ); } );
+	Bench( "normalize", count, reps,
+	       []( int i ) { return RefNormalize( InA[i] ); },
+	       []( int i ) { return Vec4Store( Vec4Normalize( Vec4Load( InA[i] ) ) ); } );
+	Bench( "rescale", count, reps,
+	       []( int i ) { return RefRescale( InA[i], 7.0f ); },
+	       []( int i ) { return Vec4Store( Vec4Rescale( Vec4Load( InA[i] ), 7.0f ) ); } );
+	Bench( "deflect", count, reps,
+	       []( int i ) { return RefDeflect( InA[i], InB[i], OVERCLIP ); },
+	       []( int i ) { return Vec4Store( Vec4Deflect( Vec4Load( InA[i] ), Vec4Load( InB[i] ), OVERCLIP ) ); } );
+	Bench( "cross", count, reps,
+	       []( int i ) { return RefCross( InA[i], InB[i] ); },
+	       []( int i ) { return Vec4Store( Vec4Cross( Vec4Load( InA[i] ), Vec4Load( InB[i] ) ) ); } );
+	Bench( "friction", count, reps,
+	       []( int i ) { return RefFriction( InA[i], InB[i], 1.0f, 100.0f, 800.0f, 1.0f / 128.0f ); },
+	       []( int i ) { return FrictionForce( InA[i], InB[i], 1.0f, 100.0f, 800.0f, 1.0f / 128.0f ); } );
+	return 0;
+}
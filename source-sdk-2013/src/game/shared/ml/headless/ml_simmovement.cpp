@@ -0,0 +1,78 @@
+#include "cbase.h"
+#include "igamemovement.h"
+#include "ml_simmovement.h"
+
+using namespace motionlab;
+
+
+SimGameMovement::SimGameMovement()
+{
+	player       = NULL;
+	mv           = NULL;
+	SimFrameTime = 0.0f;
+	m_vecForward.Init();
+	m_vecRight.Init();
+	m_vecUp.Init();
+}
+
+
+SimGameMovement::~SimGameMovement() = default;
+
+
+void SimGameMovement::ProcessMovement( SimPlayer* pPlayer, CMoveData* pMove, float frameTime )
+{
+	player       = pPlayer;
+	mv           = pMove;
+	SimFrameTime = frameTime;
+	PlayerMove();
+	++player->m_nTickBase;
+}
+
+
+const Vector& SimGameMovement::GetPlayerMins() const
+{
+	return player->HullMins;
+}
+
+
+const Vector& SimGameMovement::GetPlayerMaxs() const
+{
+	return player->HullMaxs;
+}
+
+
+unsigned int SimGameMovement::PlayerSolidMask( bool brushOnly ) const
+{
+	return brushOnly ? MASK_PLAYERSOLID_BRUSHONLY : MASK_PLAYERSOLID;
+}
+
+
+void motionlab::InitSimMoveData( CMoveData& moveData, const Vector& origin )
+{
+	moveData.m_bFirstRunOfFunctions = true;
+	moveData.m_bGameCodeMovedPlayer = false;
+	moveData.m_nImpulseCommand      = 0;
+	moveData.m_vecViewAngles.Init();
+	moveData.m_vecAbsViewAngles.Init();
+	moveData.m_nButtons             = 0;
+	moveData.m_nOldButtons          = 0;
+	moveData.m_flForwardMove        = 0.0f;
+	moveData.m_flSideMove           = 0.0f;
+	moveData.m_flUpMove             = 0.0f;
+	moveData.m_flMaxSpeed           = 0.0f;
+	moveData.m_flClientMaxSpeed     = 0.0f;
+	moveData.m_vecVelocity.Init();
+	moveData.m_vecAngles.Init();
+	moveData.m_vecOldAngles.Init();
+	moveData.m_outStepHeight        = 0.0f;
+	moveData.m_outWishVel.Init();
+	moveData.m_outJumpVel.Init();
+	moveData.SetAbsOrigin( origin );
+}
+
+
+// Normally lives in gamemovement.cpp, which we don't link headless
+void CMoveData::SetAbsOrigin( const Vector &vec )
+{
+	m_vecAbsOrigin = vec;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "bspflags.h"
+#include "ml_simplayer.h"
+
+class CMoveData;
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Headless replacement for the bits of CGameMovement that MotionDriver inherits. Holds the same
+// player/mv pointers and hull accessors, so the movement pipeline reads identically either way.
+// All the engine housekeeping (punch angles, timers, stuck checks) simply doesn't exist here.
+// -------------------------------------------------------------------------------------------------
+class SimGameMovement
+{
+	public:
+		SimGameMovement();
+		virtual ~SimGameMovement();
+
+		// Headless equivalent of IGameMovement::ProcessMovement - frametime replaces gpGlobals
+		void          ProcessMovement( SimPlayer* pPlayer, CMoveData* pMove, float frameTime );
+		virtual void  PlayerMove() = 0;
+
+		SimPlayer*    player;
+
+	protected:
+		CMoveData*    mv;
+		float         SimFrameTime;
+
+		// Native Source names kept for parity with CGameMovement
+		Vector        m_vecForward;
+		Vector        m_vecRight;
+		Vector        m_vecUp;
+
+		const Vector& GetPlayerMins() const;
+		const Vector& GetPlayerMaxs() const;
+		unsigned int  PlayerSolidMask( bool brushOnly = false ) const;
+};
+
+// Puts a CMoveData into a sane standing-still state (it has no constructor of its own)
+void InitSimMoveData( CMoveData& moveData, const Vector& origin );
+
+} // namespace motionlab
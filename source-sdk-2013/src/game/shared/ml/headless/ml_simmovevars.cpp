@@ -0,0 +1,17 @@
+// Headless definitions of the movement ConVars motionlab reads. In the game DLLs these come from
+// movevars_shared.cpp and in_main.cpp; here they're plain unregistered ConVars with stock defaults,
+// which is enough for GetFloat() to work. Harnesses can SetValue() them directly.
+#include "cbase.h"
+#include "movevars_shared.h"
+
+ConVar sv_gravity      ( "sv_gravity",       "800", FCVAR_NONE, "World gravity." );
+ConVar cl_forwardspeed ( "cl_forwardspeed",  "450", FCVAR_NONE );
+ConVar cl_backspeed    ( "cl_backspeed",     "450", FCVAR_NONE );
+ConVar cl_sidespeed    ( "cl_sidespeed",     "450", FCVAR_NONE );
+
+
+// No gamerules headless, so no per-mode gravity scaling either
+float GetCurrentGravity( void )
+{
+	return sv_gravity.GetFloat();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "mathlib/vector.h"
+
+class CBaseEntity;
+struct surfacedata_t;
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Headless stand-in for the slice of CBasePlayer that MLabPlayer talks to. Member names match
+// CBasePlayer on purpose so ml_player.cpp compiles unchanged against either - don't "fix" them.
+// Anything the engine would normally network/predict is just a plain field here.
+// -------------------------------------------------------------------------------------------------
+class SimPlayer
+{
+	public:
+		SimPlayer();
+
+		// CBasePlayer mirror
+		struct LocalData
+		{
+			float m_flFallVelocity;
+		};
+		LocalData       m_Local;
+		float           m_surfaceFriction;
+		char            m_chPreviousTextureType;
+		surfacedata_t*  m_pSurfaceData;
+		int             m_nTickBase;  // bumped by SimGameMovement::ProcessMovement, like RunCommand does
+
+		const Vector&   GetBaseVelocity() const                   { return BaseVelocity; }
+		void            SetBaseVelocity( const Vector& v )        { BaseVelocity = v; }
+		CBaseEntity*    GetGroundEntity() const                   { return GroundEntity; }
+		void            SetGroundEntity( CBaseEntity* ground )    { GroundEntity = ground; }
+		float           GetStepHeight() const                     { return StepSize; }
+		bool            IsObserver() const                        { return Observer; }
+		int             entindex() const                          { return EntIndex; }
+		void            UpdateStepSound( surfacedata_t*, const Vector&, const Vector& ) {}  // no audio headless
+
+		// Harness-side state
+		Vector          HullMins;
+		Vector          HullMaxs;
+		Vector          BaseVelocity;
+		CBaseEntity*    GroundEntity;
+		float           StepSize;
+		bool            Observer;
+		int             EntIndex;
+};
+
+
+inline SimPlayer::SimPlayer()
+{
+	m_Local.m_flFallVelocity = 0.0f;
+	m_surfaceFriction        = 1.0f;
+	m_chPreviousTextureType  = 0;
+	m_pSurfaceData           = NULL;
+	m_nTickBase              = 0;
+
+	// Standing HL2 player hull and default sv_stepsize
+	HullMins.Init( -16.0f, -16.0f,  0.0f );
+	HullMaxs.Init(  16.0f,  16.0f, 72.0f );
+	BaseVelocity.Init();
+	GroundEntity = NULL;
+	StepSize     = 18.0f;
+	Observer     = false;
+	EntIndex     = 1;  // first player slot, as in the engine
+}
+
+} // namespace motionlab
@@ -0,0 +1,858 @@
+#include "cbase.h"
+#include <float.h>
+#include <stdio.h>
+#include <algorithm>
+#include "collisionutils.h"
+#include "tier1/utlstring.h"
+#include "ml_simd.h"
+#include "ml_simworld.h"
+
+using namespace motionlab;
+
+// Stand-in identity for the world entity in trace results. Never dereferenced, only compared.
+static char s_WorldEntityTag;
+
+static const float BRUSH_VERT_EPS = 0.01f;
+
+static const int TREE_LEAF_BRUSHES = 4;    // at most this many brushes under one leaf
+static const int TREE_STACK        = 128;  // traversal stack, way past any depth a median split makes
+static const int TRACE_CANDIDATES  = 256;  // more than this under one trace and it just checks everything
+
+
+SimWorld::SimWorld()
+{
+	Clear();
+}
+
+
+void SimWorld::Clear()
+{
+	Planes.RemoveAll();
+	Brushes.RemoveAll();
+	Nodes.RemoveAll();
+	LeafBrushes.RemoveAll();
+	SurfaceProps.RemoveAll();
+	SurfTable.Clear();
+	AddSurface( 0.8f, 'C' );  // surfaceProps 0 = "default", same as the stock surfaceproperties
+}
+
+
+int SimWorld::AddSurface( float friction, char gameMaterial )
+{
+	surfacedata srf;
+	Q_memset( &srf, 0, sizeof( srf ) );
+	srf.physics.friction = friction;
+	srf.game.material    = gameMaterial;
+	SurfTable.Add( srf );
+	return SurfaceProps.AddToTail( srf );
+}
+
+
+int SimWorld::AddBox( const Vector& mins, const Vector& maxs, int surfaceProps )
+{
+	plane sides[ 6 ];
+	Q_memset( sides, 0, sizeof( sides ) );
+	for ( int axis=0; axis < 3; ++axis )
+	{
+		sides[ axis*2 ].normal[ axis ]     =  1.0f;
+		sides[ axis*2 ].dist               =  maxs[ axis ];
+		sides[ axis*2 + 1 ].normal[ axis ] = -1.0f;
+		sides[ axis*2 + 1 ].dist           = -mins[ axis ];
+	}
+	return AddBrush( sides, 6, surfaceProps );
+}
+
+
+// Takes the brush as a set of outward-facing planes. Bounds come from the plane intersections, and
+// any missing axial sides get added as bevels so hull sweeps don't snag on the expanded corners.
+// Returns the brush index, or -1 if the planes don't enclose anything.
+int SimWorld::AddBrush( const plane* planes, int numPlanes, int surfaceProps )
+{
+	// Bounds = extents of every triple-plane intersection that lies inside all the planes
+	Vector mins(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+	Vector maxs( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+	bool   foundVert = false;
+	for ( int i=0; i < numPlanes; ++i )
+	{
+		for ( int j=i+1; j < numPlanes; ++j )
+		{
+			for ( int k=j+1; k < numPlanes; ++k )
+			{
+				Vector jk    = CrossProduct( planes[j].normal, planes[k].normal );
+				float  denom = DotProduct( planes[i].normal, jk );
+				if ( fabs( denom ) < 1e-6f )
+				{
+					continue;  // parallel-ish, no single intersection point
+				}
+
+				Vector vert = ( jk * planes[i].dist
+				              + CrossProduct( planes[k].normal, planes[i].normal ) * planes[j].dist
+				              + CrossProduct( planes[i].normal, planes[j].normal ) * planes[k].dist ) / denom;
+
+				bool inside = true;
+				for ( int p=0; p < numPlanes && inside; ++p )
+				{
+					inside = DotProduct( vert, planes[p].normal ) - planes[p].dist <= BRUSH_VERT_EPS;
+				}
+				if ( inside )
+				{
+					VectorMin( mins, vert, mins );
+					VectorMax( maxs, vert, maxs );
+					foundVert = true;
+				}
+			}
+		}
+	}
+
+	if ( !foundVert )
+	{
+		return -1;
+	}
+
+	SimBrush brush;
+	brush.FirstPlane   = Planes.Count();
+	brush.SurfaceProps = surfaceProps;
+	brush.Mins         = mins;
+	brush.Maxs         = maxs;
+	for ( int i=0; i < numPlanes; ++i )
+	{
+		Planes.AddToTail( planes[i] );
+	}
+
+	// Axial bevels
+	for ( int axis=0; axis < 3; ++axis )
+	{
+		for ( int sign=-1; sign <= 1; sign += 2 )
+		{
+			bool hasSide = false;
+			for ( int i=0; i < numPlanes && !hasSide; ++i )
+			{
+				hasSide = planes[i].normal[ axis ] * sign > 0.9999f;
+			}
+			if ( !hasSide )
+			{
+				plane bevel;
+				Q_memset( &bevel, 0, sizeof( bevel ) );
+				bevel.normal[ axis ] = (float)sign;
+				bevel.dist           = sign > 0 ? maxs[ axis ] : -mins[ axis ];
+				Planes.AddToTail( bevel );
+			}
+		}
+	}
+
+	brush.NumPlanes = Planes.Count() - brush.FirstPlane;
+
+	// Tree no longer covers everything, back to brute force until it's rebuilt
+	Nodes.RemoveAll();
+	LeafBrushes.RemoveAll();
+	return Brushes.AddToTail( brush );
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Brush tree
+// ------------------------------------------------------------------------------------------------
+
+void SimWorld::BuildTree()
+{
+	Nodes.RemoveAll();
+	LeafBrushes.RemoveAll();
+	if ( !Brushes.Count() )
+	{
+		return;
+	}
+
+	CUtlVector<int> all;
+	all.SetCount( Brushes.Count() );
+	for ( int i=0; i < all.Count(); ++i )
+	{
+		all[i] = i;
+	}
+	BuildNode( all.Base(), all.Count() );
+}
+
+
+bool SimWorld::HasTree() const
+{
+	return Nodes.Count() > 0;
+}
+
+
+// Median split along the longest axis of the brush centers. Returns where the second half starts.
+static int SplitBrushes( const CUtlVector<SimBrush>& brushes, int* list, int count )
+{
+	Vector lo(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+	Vector hi( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+	for ( int i=0; i < count; ++i )
+	{
+		Vector center = brushes[ list[i] ].Mins + brushes[ list[i] ].Maxs;  // x2, doesn't matter for ordering
+		VectorMin( lo, center, lo );
+		VectorMax( hi, center, hi );
+	}
+	Vector extent = hi - lo;
+	int    axis   = extent.x >= extent.y ? ( extent.x >= extent.z ? 0 : 2 ) : ( extent.y >= extent.z ? 1 : 2 );
+
+	int mid = count / 2;
+	std::nth_element( list, list + mid, list + count, [&]( int a, int b )
+	{
+		return brushes[a].Mins[ axis ] + brushes[a].Maxs[ axis ] < brushes[b].Mins[ axis ] + brushes[b].Maxs[ axis ];
+	} );
+	return mid;
+}
+
+
+// Splits the list in two and each half in two again for the four children. Anything small enough
+// becomes a leaf in place, the rest recurse. Returns the node's index.
+int SimWorld::BuildNode( int* brushes, int count )
+{
+	int index = Nodes.AddToTail();
+	for ( int i=0; i < 4; ++i )
+	{
+		// Empty lanes get inside-out bounds so they never pass the overlap test
+		Nodes[ index ].MinX[i] = Nodes[ index ].MinY[i] = Nodes[ index ].MinZ[i] =  FLT_MAX;
+		Nodes[ index ].MaxX[i] = Nodes[ index ].MaxY[i] = Nodes[ index ].MaxZ[i] = -FLT_MAX;
+		Nodes[ index ].Child[i] = -1;
+		Nodes[ index ].Count[i] = 0;
+	}
+
+	int* groups[4];
+	int  counts[4];
+	if ( count <= TREE_LEAF_BRUSHES )
+	{
+		// Only the root ever gets here (small world), everything else splits before recursing
+		groups[0] = brushes;
+		counts[0] = count;
+		counts[1] = counts[2] = counts[3] = 0;
+	}
+	else
+	{
+		int half   = SplitBrushes( Brushes, brushes, count );
+		int first  = SplitBrushes( Brushes, brushes, half );
+		int second = SplitBrushes( Brushes, brushes + half, count - half );
+		groups[0] = brushes;                 counts[0] = first;
+		groups[1] = brushes + first;         counts[1] = half - first;
+		groups[2] = brushes + half;          counts[2] = second;
+		groups[3] = brushes + half + second; counts[3] = count - half - second;
+	}
+
+	for ( int i=0; i < 4; ++i )
+	{
+		if ( !counts[i] )
+		{
+			continue;
+		}
+
+		Vector mins(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+		Vector maxs( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+		for ( int j=0; j < counts[i]; ++j )
+		{
+			VectorMin( mins, Brushes[ groups[i][j] ].Mins, mins );
+			VectorMax( maxs, Brushes[ groups[i][j] ].Maxs, maxs );
+		}
+
+		int child;
+		if ( counts[i] <= TREE_LEAF_BRUSHES )
+		{
+			child = -( LeafBrushes.Count() + 1 );
+			LeafBrushes.AddMultipleToTail( counts[i], groups[i] );
+		}
+		else
+		{
+			child = BuildNode( groups[i], counts[i] );  // may grow Nodes, so no references across this
+		}
+
+		TreeNode& node = Nodes[ index ];
+		node.MinX[i]  = mins.x;  node.MinY[i] = mins.y;  node.MinZ[i] = mins.z;
+		node.MaxX[i]  = maxs.x;  node.MaxY[i] = maxs.y;  node.MaxZ[i] = maxs.z;
+		node.Child[i] = child;
+		node.Count[i] = counts[i];
+	}
+	return index;
+}
+
+
+// Every brush whose bounds overlap the box, in ascending order. Returns how many, or -1 if there
+// were more than maxOut.
+int SimWorld::QueryTree( const Vector& mins, const Vector& maxs, int* out, int maxOut ) const
+{
+#ifdef MOTIONLAB_SSE
+	__m128 qMinX = _mm_set1_ps( mins.x ), qMinY = _mm_set1_ps( mins.y ), qMinZ = _mm_set1_ps( mins.z );
+	__m128 qMaxX = _mm_set1_ps( maxs.x ), qMaxY = _mm_set1_ps( maxs.y ), qMaxZ = _mm_set1_ps( maxs.z );
+#endif
+
+	int stack[ TREE_STACK ];
+	int depth = 0;
+	int found = 0;
+	stack[ depth++ ] = 0;
+	while ( depth )
+	{
+		const TreeNode& node = Nodes[ stack[ --depth ] ];
+
+		// Same test as IsBoxIntersectingBox, all four children at once
+	#ifdef MOTIONLAB_SSE
+		__m128 hit = _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( node.MinX ), qMaxX ), _mm_cmpge_ps( _mm_loadu_ps( node.MaxX ), qMinX ) );
+		hit = _mm_and_ps( hit, _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( node.MinY ), qMaxY ), _mm_cmpge_ps( _mm_loadu_ps( node.MaxY ), qMinY ) ) );
+		hit = _mm_and_ps( hit, _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( node.MinZ ), qMaxZ ), _mm_cmpge_ps( _mm_loadu_ps( node.MaxZ ), qMinZ ) ) );
+		int lanes = _mm_movemask_ps( hit );
+	#else
+		int lanes = 0;
+		for ( int i=0; i < 4; ++i )
+		{
+			if ( node.MinX[i] <= maxs.x && node.MaxX[i] >= mins.x && node.MinY[i] <= maxs.y && node.MaxY[i] >= mins.y
+			     && node.MinZ[i] <= maxs.z && node.MaxZ[i] >= mins.z )
+			{
+				lanes |= 1 << i;
+			}
+		}
+	#endif
+
+		for ( int i=0; lanes; ++i, lanes >>= 1 )
+		{
+			if ( !( lanes & 1 ) )
+			{
+				continue;
+			}
+			if ( node.Child[i] >= 0 )
+			{
+				Assert( depth < TREE_STACK );
+				stack[ depth++ ] = node.Child[i];
+				continue;
+			}
+
+			const int* leaf = &LeafBrushes[ -node.Child[i] - 1 ];
+			for ( int j=0; j < node.Count[i]; ++j )
+			{
+				const SimBrush& brush = Brushes[ leaf[j] ];
+				if ( !IsBoxIntersectingBox( mins, maxs, brush.Mins, brush.Maxs ) )
+				{
+					continue;
+				}
+				if ( found == maxOut )
+				{
+					return -1;
+				}
+				out[ found++ ] = leaf[j];
+			}
+		}
+	}
+
+	// Tree order isn't index order, and ties in ClipBoxToBrush go to whoever's first
+	std::sort( out, out + found );
+	return found;
+}
+
+
+// Swept box vs convex brush, same approach as the engine's CM_ClipBoxToBrush: push each plane out
+// by the hull's support distance and clip the box center as a point. Returns true if the brush
+// touched the sweep at all (hit or started inside).
+bool SimWorld::ClipBoxToBrush( const SimBrush& brush, const Vector& start, const Vector& end,
+                               const Vector& mins, const Vector& maxs, hulltrace& tr ) const
+{
+	float        enterFrac = -1.0f;
+	float        leaveFrac =  1.0f;
+	const plane* clipPlane = NULL;
+	bool         startOut  = false;
+	bool         getOut    = false;
+
+	for ( int i=0; i < brush.NumPlanes; ++i )
+	{
+		const plane& pl = Planes[ brush.FirstPlane + i ];
+
+		// Corner of the hull furthest behind the plane
+		Vector ofs( pl.normal.x < 0.0f ? maxs.x : mins.x,
+		            pl.normal.y < 0.0f ? maxs.y : mins.y,
+		            pl.normal.z < 0.0f ? maxs.z : mins.z );
+		float dist = pl.dist - DotProduct( ofs, pl.normal );
+		float d1   = DotProduct( start, pl.normal ) - dist;
+		float d2   = DotProduct( end,   pl.normal ) - dist;
+
+		if ( d1 > 0.0f )
+		{
+			startOut = true;
+		}
+		if ( d2 > 0.0f )
+		{
+			getOut = true;
+		}
+
+		// Entirely in front of this face - can't be touching the brush
+		if ( d1 > 0.0f && ( d2 >= DIST_EPSILON || d2 >= d1 ) )
+		{
+			return false;
+		}
+
+		// Entirely behind it - this face doesn't clip anything
+		if ( d1 <= 0.0f && d2 <= 0.0f )
+		{
+			continue;
+		}
+
+		if ( d1 > d2 )  // crossing into the brush
+		{
+			float f = ( d1 - DIST_EPSILON ) / ( d1 - d2 );
+			if ( f > enterFrac )
+			{
+				enterFrac = f;
+				clipPlane = &pl;
+			}
+		}
+		else  // crossing out of it
+		{
+			float f = ( d1 + DIST_EPSILON ) / ( d1 - d2 );
+			if ( f < leaveFrac )
+			{
+				leaveFrac = f;
+			}
+		}
+	}
+
+	if ( !startOut )  // started inside the brush
+	{
+		tr.startsolid = true;
+		tr.contents   = CONTENTS_SOLID;
+		if ( !getOut )
+		{
+			tr.allsolid = true;
+			tr.fraction = 0.0f;
+		}
+		return true;
+	}
+
+	// Clamp before comparing, same as the engine. A brush entered just behind the start point is a
+	// hit at 0 and doesn't beat another brush already hit at 0.
+	if ( clipPlane && enterFrac < leaveFrac && enterFrac > -1.0f && MAX( 0.0f, enterFrac ) < tr.fraction )
+	{
+		tr.fraction             = MAX( 0.0f, enterFrac );
+		tr.plane                = *clipPlane;
+		tr.surface.surfaceProps = brush.SurfaceProps;
+		tr.contents             = CONTENTS_SOLID;
+		return true;
+	}
+
+	return false;
+}
+
+
+// Through the tree if it's built, otherwise brute force over every brush with a bounds reject up front
+void SimWorld::TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                          unsigned int mask, hulltrace& tr ) const
+{
+	TraceBrushList( start, end, mins, maxs, mask, NULL, Brushes.Count(), tr );
+}
+
+
+// Same as TraceHull, but only against the listed brushes (e.g. from GatherBrushes). Lists in
+// ascending index order give bitwise identical results to a full trace, as long as they hold
+// every brush overlapping the trace's swept bounds.
+void SimWorld::TraceHullSubset( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                                unsigned int mask, const CUtlVector<int>& brushes, hulltrace& tr ) const
+{
+	TraceBrushList( start, end, mins, maxs, mask, brushes.Base(), brushes.Count(), tr );
+}
+
+
+// Indices of every brush whose bounds overlap the box, in ascending order
+void SimWorld::GatherBrushes( const Vector& mins, const Vector& maxs, CUtlVector<int>& out ) const
+{
+	out.RemoveAll();
+	if ( HasTree() )
+	{
+		out.SetCount( MIN( Brushes.Count(), 64 ) );
+		int found;
+		while ( ( found = QueryTree( mins, maxs, out.Base(), out.Count() ) ) < 0 )
+		{
+			out.SetCount( MIN( Brushes.Count(), out.Count() * 2 ) );
+		}
+		out.SetCountNonDestructively( found );
+		return;
+	}
+
+	for ( int i=0; i < Brushes.Count(); ++i )
+	{
+		if ( IsBoxIntersectingBox( mins, maxs, Brushes[i].Mins, Brushes[i].Maxs ) )
+		{
+			out.AddToTail( i );
+		}
+	}
+}
+
+
+// NULL brush list = every brush in the world, narrowed down by the tree if there is one
+void SimWorld::TraceBrushList( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                               unsigned int mask, const int* brushes, int numBrushes, hulltrace& tr ) const
+{
+	Q_memset( &tr, 0, sizeof( tr ) );
+	tr.fraction     = 1.0f;
+	tr.startpos     = start;
+	tr.surface.name = "**sim**";
+
+	if ( mask & CONTENTS_SOLID )
+	{
+		Vector sweepMins, sweepMaxs;
+		SweptHullBounds( start, end, mins, maxs, sweepMins, sweepMaxs );
+
+		int candidates[ TRACE_CANDIDATES ];
+		if ( !brushes && HasTree() )
+		{
+			int found = QueryTree( sweepMins, sweepMaxs, candidates, TRACE_CANDIDATES );
+			if ( found >= 0 )
+			{
+				brushes    = candidates;
+				numBrushes = found;
+			}
+		}
+
+		bool touched = false;
+		for ( int i=0; i < numBrushes && !tr.allsolid; ++i )
+		{
+			const SimBrush& brush = Brushes[ brushes ? brushes[i] : i ];
+			if ( !IsBoxIntersectingBox( sweepMins, sweepMaxs, brush.Mins, brush.Maxs ) )
+			{
+				continue;
+			}
+			touched |= ClipBoxToBrush( brush, start, end, mins, maxs, tr );
+		}
+
+		if ( touched )
+		{
+			tr.m_pEnt = WorldEntity();
+		}
+	}
+
+	if ( tr.fraction == 1.0f )
+	{
+		tr.endpos = end;
+	}
+	else
+	{
+		VectorLerp( start, end, tr.fraction, tr.endpos );
+	}
+}
+
+
+surfacedata* SimWorld::SurfaceData( int surfaceProps )
+{
+	return SurfaceProps.IsValidIndex( surfaceProps ) ? &SurfaceProps[ surfaceProps ] : NULL;
+}
+
+
+int SimWorld::SurfaceCount() const
+{
+	return SurfaceProps.Count();
+}
+
+
+const SurfaceTable& SimWorld::Surfaces() const
+{
+	return SurfTable;
+}
+
+
+CBaseEntity* SimWorld::WorldEntity() const
+{
+	return reinterpret_cast<CBaseEntity*>( &s_WorldEntityTag );
+}
+
+
+int SimWorld::BrushCount() const
+{
+	return Brushes.Count();
+}
+
+
+void SimWorld::GetBounds( Vector& mins, Vector& maxs ) const
+{
+	mins = maxs = vec3_origin;
+	for ( int i=0; i < Brushes.Count(); ++i )
+	{
+		if ( i )
+		{
+			VectorMin( mins, Brushes[i].Mins, mins );
+			VectorMax( maxs, Brushes[i].Maxs, maxs );
+		}
+		else
+		{
+			mins = Brushes[i].Mins;
+			maxs = Brushes[i].Maxs;
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Brush files
+// ------------------------------------------------------------------------------------------------
+
+static int FindSurfaceName( const CUtlVector<CUtlString>& names, const char* name )
+{
+	for ( int i=0; i < names.Count(); ++i )
+	{
+		if ( !Q_stricmp( names[i].Get(), name ) )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+bool motionlab::LoadBrushFile( SimWorld& world, const char* path )
+{
+	FILE* f = fopen( path, "r" );
+	if ( !f )
+	{
+		Warning( "LoadBrushFile: couldn't open %s\n", path );
+		return false;
+	}
+
+	world.Clear();
+	CUtlVector<CUtlString> surfaceNames;  // index = surfaceProps
+	surfaceNames.AddToTail( CUtlString( "default" ) );
+
+	CUtlVector<plane> planes;
+	bool inBrush      = false;
+	int  brushSurface = 0;
+	int  lineNum      = 0;
+	bool ok           = true;
+	char line[ 512 ];
+	while ( ok && fgets( line, sizeof( line ), f ) )
+	{
+		++lineNum;
+		char* comment = strchr( line, '#' );
+		if ( comment )
+		{
+			*comment = 0;
+		}
+
+		char cmd[ 32 ], name[ 64 ] = "";
+		if ( sscanf( line, "%31s", cmd ) != 1 )
+		{
+			continue;  // blank
+		}
+
+		if ( inBrush )
+		{
+			plane pl;
+			Q_memset( &pl, 0, sizeof( pl ) );
+			float length = 0.0f;
+			if ( !Q_stricmp( cmd, "plane" ) && sscanf( line, "%*s %f %f %f %f", &pl.normal.x, &pl.normal.y, &pl.normal.z, &pl.dist ) == 4 )
+			{
+				length = VectorNormalize( pl.normal );
+			}
+			if ( length > 0.0f )
+			{
+				pl.dist /= length;  // normals don't have to be unit length in the file
+				planes.AddToTail( pl );
+			}
+			else if ( !Q_stricmp( cmd, "end" ) )
+			{
+				inBrush = false;
+				if ( world.AddBrush( planes.Base(), planes.Count(), brushSurface ) < 0 )
+				{
+					Warning( "%s:%d: brush planes don't enclose anything\n", path, lineNum );
+					ok = false;
+				}
+			}
+			else
+			{
+				Warning( "%s:%d: expected \"plane <nx> <ny> <nz> <dist>\" or \"end\"\n", path, lineNum );
+				ok = false;
+			}
+			continue;
+		}
+
+		if ( !Q_stricmp( cmd, "surface" ) )
+		{
+			float friction;
+			char  material;
+			if ( sscanf( line, "%*s %63s %f %c", name, &friction, &material ) != 3 || FindSurfaceName( surfaceNames, name ) >= 0 )
+			{
+				Warning( "%s:%d: expected \"surface <new name> <friction> <material>\"\n", path, lineNum );
+				ok = false;
+				continue;
+			}
+			world.AddSurface( friction, material );
+			surfaceNames.AddToTail( CUtlString( name ) );
+			continue;
+		}
+
+		int    fields = 0;
+		Vector mins, maxs;
+		if ( !Q_stricmp( cmd, "box" ) )
+		{
+			fields = sscanf( line, "%*s %f %f %f %f %f %f %63s", &mins.x, &mins.y, &mins.z, &maxs.x, &maxs.y, &maxs.z, name );
+			if ( fields < 6 || mins.x >= maxs.x || mins.y >= maxs.y || mins.z >= maxs.z )
+			{
+				Warning( "%s:%d: expected \"box <mins> <maxs> [surface]\"\n", path, lineNum );
+				ok = false;
+				continue;
+			}
+		}
+		else if ( !Q_stricmp( cmd, "brush" ) )
+		{
+			sscanf( line, "%*s %63s", name );
+		}
+		else
+		{
+			Warning( "%s:%d: unknown command \"%s\"\n", path, lineNum, cmd );
+			ok = false;
+			continue;
+		}
+
+		int surface = name[0] ? FindSurfaceName( surfaceNames, name ) : 0;
+		if ( surface < 0 )
+		{
+			Warning( "%s:%d: no surface called \"%s\"\n", path, lineNum, name );
+			ok = false;
+			continue;
+		}
+
+		if ( !Q_stricmp( cmd, "box" ) )
+		{
+			world.AddBox( mins, maxs, surface );
+		}
+		else
+		{
+			planes.RemoveAll();
+			brushSurface = surface;
+			inBrush      = true;
+		}
+	}
+	fclose( f );
+
+	if ( ok && inBrush )
+	{
+		Warning( "%s: brush with no \"end\"\n", path );
+		ok = false;
+	}
+	if ( !ok )
+	{
+		world.Clear();
+		return false;
+	}
+
+	world.BuildTree();
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// SimBackend
+// ------------------------------------------------------------------------------------------------
+
+SimBackend::SimBackend()
+{
+	Setup( NULL );
+}
+
+
+void SimBackend::Setup( SimWorld* world )
+{
+	World       = world;
+	LocalActive = false;
+	LocalBrushes.RemoveAll();
+	ResetCounters();
+}
+
+
+void SimBackend::ResetCounters()
+{
+	TraceCount      = 0;
+	TouchCount      = 0;
+	LocalTraceCount = 0;
+	SnapshotBrushes = 0;
+	SnapshotCount   = 0;
+}
+
+
+void SimBackend::TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                            unsigned int mask, int collisionGroup, hulltrace& tr )
+{
+	++TraceCount;
+
+	if ( LocalActive )
+	{
+		Vector sweepMins, sweepMaxs;
+		SweptHullBounds( start, end, mins, maxs, sweepMins, sweepMaxs );
+		if ( BoxContainsBox( LocalMins, LocalMaxs, sweepMins, sweepMaxs ) )
+		{
+			++LocalTraceCount;
+			World->TraceHullSubset( start, end, mins, maxs, mask, LocalBrushes, tr );
+			return;
+		}
+	}
+
+	World->TraceHull( start, end, mins, maxs, mask, tr );
+}
+
+
+bool SimBackend::TraceHitWorld( const hulltrace& tr ) const
+{
+	return tr.m_pEnt == World->WorldEntity();
+}
+
+
+surfacedata* SimBackend::SurfaceData( int surfaceProps ) const
+{
+	return World->SurfaceData( surfaceProps );
+}
+
+
+int SimBackend::SurfacePropCount() const
+{
+	return World->SurfaceCount();
+}
+
+
+const SurfaceTable& SimBackend::Surfaces() const
+{
+	return World->Surfaces();
+}
+
+
+// Nothing moves in a SimWorld
+Vector SimBackend::EntityVelocity( CBaseEntity* ent ) const
+{
+	return vec3_origin;
+}
+
+
+// Touches are only counted headless, there's no touch list to dedupe against
+void SimBackend::ResetTouchList()
+{
+}
+
+
+bool SimBackend::AddToTouched( const hulltrace& tr, const Vector& impactVel )
+{
+	++TouchCount;
+	return true;
+}
+
+
+// World is immutable and everything mutable lives in the backend, so one backend per driver is safe
+bool SimBackend::SupportsParallelMoves() const
+{
+	return true;
+}
+
+
+// Anything a trace inside [mins, maxs] could clip overlaps [mins, maxs] itself, so the local list
+// is complete for those traces by construction
+bool SimBackend::BeginLocalQueries( const Vector& mins, const Vector& maxs )
+{
+	World->GatherBrushes( mins, maxs, LocalBrushes );
+	LocalMins   = mins;
+	LocalMaxs   = maxs;
+	LocalActive = true;
+
+	SnapshotBrushes += LocalBrushes.Count();
+	++SnapshotCount;
+	return true;
+}
+
+
+void SimBackend::EndLocalQueries()
+{
+	LocalActive = false;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "ml_defs.h"
+#include "ml_backend.h"
+
+class CBaseEntity;
+
+namespace motionlab {
+
+// One convex brush - a run of planes in SimWorld's plane list plus its bounds for cheap rejects.
+// Same layout idea as the BSP's cbrush_t/cbrushside_t.
+struct SimBrush
+{
+	int    FirstPlane;
+	int    NumPlanes;
+	int    SurfaceProps;
+	Vector Mins;
+	Vector Maxs;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// In-process collision world for headless runs. A static set of convex brushes answering the same
+// axis-aligned hull sweeps the engine does for TracePlayerBBox. Immutable once built, so any
+// number of threads can trace against one world at a time.
+//
+// BuildTree() puts a 4-wide bounding volume tree over the brushes, each node testing all four
+// children's bounds against the swept box at once (SSE, see ml_simd.h). Queries go through the
+// tree when there is one and check every brush when there isn't - either way the brushes that get
+// clipped are the same ones in the same (index) order, so results are bitwise identical.
+// -------------------------------------------------------------------------------------------------
+class SimWorld
+{
+	public:
+		SimWorld();
+
+		// World building
+		void          Clear();
+		int           AddSurface( float friction, char gameMaterial );
+		int           AddBox( const Vector& mins, const Vector& maxs, int surfaceProps = 0 );
+		int           AddBrush( const plane* planes, int numPlanes, int surfaceProps = 0 );
+		void          BuildTree();  // call once everything's added, any later AddBrush drops it again
+		bool          HasTree() const;
+
+		// Queries
+		void          TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                         unsigned int mask, hulltrace& tr ) const;
+		void          TraceHullSubset( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                               unsigned int mask, const CUtlVector<int>& brushes, hulltrace& tr ) const;
+		void          GatherBrushes( const Vector& mins, const Vector& maxs, CUtlVector<int>& out ) const;
+		surfacedata*  SurfaceData( int surfaceProps );
+		int           SurfaceCount() const;
+		const SurfaceTable& Surfaces() const;
+		CBaseEntity*  WorldEntity() const;
+		int           BrushCount() const;
+		void          GetBounds( Vector& mins, Vector& maxs ) const;  // around every brush, zero when empty
+
+	private:
+		// Child bounds SoA so one node is one 4-wide overlap test. Child >= 0 is another node,
+		// otherwise a leaf of Count[i] brushes starting at LeafBrushes[ -Child[i] - 1 ].
+		struct TreeNode
+		{
+			float MinX[4], MinY[4], MinZ[4];
+			float MaxX[4], MaxY[4], MaxZ[4];
+			int   Child[4];
+			int   Count[4];
+		};
+
+		CUtlVector<plane>       Planes;
+		CUtlVector<SimBrush>    Brushes;
+		CUtlVector<surfacedata> SurfaceProps;
+		SurfaceTable            SurfTable;  // kept in step with SurfaceProps
+		CUtlVector<TreeNode>    Nodes;      // [0] is the root, empty = no tree
+		CUtlVector<int>         LeafBrushes;
+
+		int           BuildNode( int* brushes, int count );
+		int           QueryTree( const Vector& mins, const Vector& maxs, int* out, int maxOut ) const;
+
+		bool          ClipBoxToBrush( const SimBrush& brush, const Vector& start, const Vector& end,
+		                              const Vector& mins, const Vector& maxs, hulltrace& tr ) const;
+		void          TraceBrushList( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                              unsigned int mask, const int* brushes, int numBrushes, hulltrace& tr ) const;
+};
+
+
+// Text brush files, for harness maps that aren't built in code. One command per line, # comments:
+//
+//   surface <name> <friction> <material char>    define a surface; "default" (0.8, C) always exists
+//   box <minx> <miny> <minz> <maxx> <maxy> <maxz> [surface]
+//   brush [surface]                              convex brush from outward planes, up to "end"
+//     plane <nx> <ny> <nz> <dist>
+//   end
+//
+// Replaces whatever was in the world and builds the tree at the end. Returns false (and says where) on anything it can't make sense of.
+bool LoadBrushFile( SimWorld& world, const char* path );
+
+
+// -------------------------------------------------------------------------------------------------
+// MotionBackend over a SimWorld. Holds the per-driver bits (touch list, work counters), so use one
+// of these per MotionDriver even when the world itself is shared.
+// -------------------------------------------------------------------------------------------------
+class SimBackend : public MotionBackend
+{
+	private:
+		SimWorld*       World;
+
+		// Local snapshot state, see MotionBackend::BeginLocalQueries
+		bool            LocalActive;
+		Vector          LocalMins;
+		Vector          LocalMaxs;
+		CUtlVector<int> LocalBrushes;
+
+	public:
+		SimBackend();
+		void Setup( SimWorld* world );
+
+		// Work counters, accumulated until ResetCounters()
+		int64     TraceCount;
+		int64     TouchCount;
+		int64     LocalTraceCount;  // traces answered from a local snapshot
+		int64     SnapshotBrushes;  // sum of snapshot sizes, for average-size reporting
+		int64     SnapshotCount;
+		void      ResetCounters();
+
+		virtual void         TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                                unsigned int mask, int collisionGroup, hulltrace& tr ) OVERRIDE;
+		virtual bool         TraceHitWorld( const hulltrace& tr ) const OVERRIDE;
+		virtual surfacedata* SurfaceData( int surfaceProps ) const OVERRIDE;
+		virtual int          SurfacePropCount() const OVERRIDE;
+		virtual const SurfaceTable& Surfaces() const OVERRIDE;
+		virtual Vector       EntityVelocity( CBaseEntity* ent ) const OVERRIDE;
+		virtual void         ResetTouchList() OVERRIDE;
+		virtual bool         AddToTouched( const hulltrace& tr, const Vector& impactVel ) OVERRIDE;
+		virtual bool         SupportsParallelMoves() const OVERRIDE;
+		virtual bool         BeginLocalQueries( const Vector& mins, const Vector& maxs ) OVERRIDE;
+		virtual void         EndLocalQueries() OVERRIDE;
+};
+
+} // namespace motionlab
@@ -0,0 +1,262 @@
+// -------------------------------------------------------------------------------------------------
+// Headless scaling benchmark. Spawns swarms of simulated players in the arena - an even mix of
+// running, strafing, jumping, wall-hugging and idle - and moves them through a MovementPool at
+// every combination of swarm size (10 up to maxPlayers, x10 each step) and thread count (1, 2,
+// 4... up to maxThreads). Per combination it reports ticks/sec, ms/tick, cost per player-tick,
+// speedup over 1 thread and the movement state memory it needed.
+// Then, per swarm size, one serial pass timed player by player for the per-player cost spread,
+// overall and per input pattern.
+//
+//   ml_swarmbench [maxPlayers] [ticks] [maxThreads]
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _LINUX
+#include <unistd.h>
+#endif
+#include "tier0/fasttimer.h"
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_movepool.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+static const int   WARMUP_TICKS  = 32;
+static const int   SAMPLE_TICKS  = 64;   // serially timed ticks per swarm size
+static const int   HISTORY_TICKS = 256;
+static const float FRAME_TIME    = 1.0f / 128.0f;
+
+
+struct Swarm
+{
+	CUtlVector<SimPlayer> Players;
+	CUtlVector<CMoveData> Moves;
+	CUtlVector<MoveJob>   Jobs;
+
+	void Spawn( const SimWorld& world, int count )
+	{
+		Players.SetCount( count );
+		Moves.SetCount( count );
+		Jobs.SetCount( count );
+		for ( int i=0; i < count; ++i )
+		{
+			Players[i] = SimPlayer();
+			InitSimMoveData( Moves[i], ArenaSpawnPoint( world, i ) );
+			Players[i].EntIndex = i + 1;
+			Jobs[i].Player   = &Players[i];
+			Jobs[i].MoveData = &Moves[i];
+		}
+	}
+
+	static ScriptPattern Pattern( int i )
+	{
+		return (ScriptPattern)( i % SCRIPT_PATTERN_COUNT );
+	}
+
+	void Script( int tick )
+	{
+		for ( int i=0; i < Moves.Count(); ++i )
+		{
+			ScriptInput( Pattern( i ), tick, i, Moves[i] );
+			Players[i].m_nTickBase = tick;  // MovePlayer skips ProcessMovement, which would bump it
+		}
+	}
+
+	int MemoryUsed() const
+	{
+		return Players.Count() * ( sizeof( SimPlayer ) + sizeof( CMoveData ) + sizeof( MoveJob ) );
+	}
+};
+
+
+// Resident set size in KB, -1 if we can't tell
+static int ResidentKB()
+{
+#ifdef _LINUX
+	FILE* f = fopen( "/proc/self/statm", "r" );
+	if ( !f )
+	{
+		return -1;
+	}
+	long pages = 0, resident = 0;
+	int  read  = fscanf( f, "%ld %ld", &pages, &resident );
+	fclose( f );
+	return read == 2 ? (int)( resident * ( sysconf( _SC_PAGESIZE ) / 1024 ) ) : -1;
+#else
+	return -1;
+#endif
+}
+
+
+static int CompareFloat( const float* a, const float* b )
+{
+	return *a < *b ? -1 : ( *a > *b ? 1 : 0 );
+}
+
+// Sorts in place
+static void PrintSpread( const char* label, CUtlVector<float>& us )
+{
+	if ( !us.Count() )
+	{
+		return;
+	}
+	us.Sort( CompareFloat );
+
+	double sum = 0.0;
+	for ( int i=0; i < us.Count(); ++i )
+	{
+		sum += us[i];
+	}
+	int last = us.Count() - 1;
+	printf( "  %-10s %8.2f %8.2f %8.2f %8.2f %8.2f\n", label, sum / us.Count(),
+	        us[ last * 50 / 100 ], us[ last * 90 / 100 ], us[ last * 99 / 100 ], us[ last ] );
+}
+
+
+// Moves the swarm through a pool of numThreads, returns seconds spent in the timed ticks
+static double RunPooled( SimWorld& world, Swarm& swarm, int numPlayers, int numThreads, int ticks, int& stateBytes )
+{
+	MovementPool pool;
+	pool.Init( numThreads );
+	pool.GetGroundMemory().Reserve( numPlayers );
+	pool.GetBuildProfiles().Reserve( numPlayers );
+	pool.GetHistory().Reserve( numPlayers, HISTORY_TICKS );
+	CUtlVector<SimBackend> backends;
+	backends.SetCount( pool.WorkerCount() );
+	for ( int i=0; i < pool.WorkerCount(); ++i )
+	{
+		backends[i].Setup( &world );
+		pool.Driver( i ).SetBackend( &backends[i] );
+	}
+
+	swarm.Spawn( world, numPlayers );
+	for ( int tick=0; tick < WARMUP_TICKS; ++tick )
+	{
+		swarm.Script( tick );
+		pool.Run( swarm.Jobs.Base(), numPlayers, FRAME_TIME );
+	}
+
+	double elapsed = 0.0;
+	for ( int tick=WARMUP_TICKS; tick < WARMUP_TICKS + ticks; ++tick )
+	{
+		swarm.Script( tick );
+		double t0 = Plat_FloatTime();
+		pool.Run( swarm.Jobs.Base(), numPlayers, FRAME_TIME );
+		elapsed += Plat_FloatTime() - t0;
+	}
+
+	stateBytes = pool.WorkerCount() * ( sizeof( MotionDriver ) + sizeof( SimBackend ) )
+	           + ( numPlayers + 1 ) * ( sizeof( GroundContact ) + sizeof( uint16 ) )  // ground memory + build assignments
+	           + pool.GetHistory().MemoryUsed()
+	           + swarm.MemoryUsed();
+	return elapsed;
+}
+
+
+// One driver, every player timed on its own
+static void RunSpread( SimWorld& world, Swarm& swarm, int numPlayers )
+{
+	SimBackend   backend;
+	MotionDriver driver;
+	backend.Setup( &world );
+	driver.SetBackend( &backend );
+	driver.GetGroundMemory().Reserve( numPlayers );
+
+	CUtlVector<float> all;
+	CUtlVector<float> byPattern[ SCRIPT_PATTERN_COUNT ];
+	all.EnsureCapacity( numPlayers * SAMPLE_TICKS );
+
+	swarm.Spawn( world, numPlayers );
+	for ( int tick=0; tick < WARMUP_TICKS + SAMPLE_TICKS; ++tick )
+	{
+		swarm.Script( tick );
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			CFastTimer timer;
+			timer.Start();
+			driver.MovePlayer( swarm.Jobs[i].Player, swarm.Jobs[i].MoveData, FRAME_TIME );
+			timer.End();
+			if ( tick >= WARMUP_TICKS )
+			{
+				float us = timer.GetDuration().GetMicrosecondsF();
+				all.AddToTail( us );
+				byPattern[ Swarm::Pattern( i ) ].AddToTail( us );
+			}
+		}
+	}
+
+	printf( "\n%d players, serial, us per player-tick over %d ticks:\n", numPlayers, SAMPLE_TICKS );
+	printf( "  %-10s %8s %8s %8s %8s %8s\n", "", "mean", "p50", "p90", "p99", "max" );
+	PrintSpread( "all", all );
+	for ( int p=0; p < SCRIPT_PATTERN_COUNT; ++p )
+	{
+		PrintSpread( ScriptPatternName( p ), byPattern[p] );
+	}
+}
+
+
+int main( int argc, char** argv )
+{
+	int maxPlayers = argc > 1 ? atoi( argv[1] ) : 10000;
+	int ticks      = argc > 2 ? atoi( argv[2] ) : 256;
+	int maxThreads = argc > 3 ? atoi( argv[3] ) : (int)std::thread::hardware_concurrency();
+	maxPlayers = MAX( maxPlayers, 1 );
+	ticks      = MAX( ticks, 1 );
+	maxThreads = MAX( maxThreads, 1 );
+
+	SimWorld world;
+	BuildArena( world );
+
+	CUtlVector<int> sizes;
+	for ( int n=10; n < maxPlayers; n *= 10 )
+	{
+		sizes.AddToTail( n );
+	}
+	sizes.AddToTail( maxPlayers );
+
+	CUtlVector<int> threadCounts;
+	for ( int t=1; t < maxThreads; t *= 2 )
+	{
+		threadCounts.AddToTail( t );
+	}
+	threadCounts.AddToTail( maxThreads );
+
+	printf( "ticks:          %d (+%d warmup) at %.0f tick\n", ticks, WARMUP_TICKS, 1.0f / FRAME_TIME );
+	printf( "patterns:       " );
+	for ( int p=0; p < SCRIPT_PATTERN_COUNT; ++p )
+	{
+		printf( "%s%s", ScriptPatternName( p ), p + 1 < SCRIPT_PATTERN_COUNT ? ", " : "\n\n" );
+	}
+	printf( "%8s %7s %11s %9s %12s %8s %6s %9s %9s\n",
+	        "players", "threads", "ticks/sec", "ms/tick", "us/plr-tick", "speedup", "eff", "state KB", "rss KB" );
+
+	Swarm swarm;
+	for ( int s=0; s < sizes.Count(); ++s )
+	{
+		int    numPlayers = sizes[s];
+		double serialTime = 0.0;
+		for ( int t=0; t < threadCounts.Count(); ++t )
+		{
+			int    numThreads = threadCounts[t];
+			int    stateBytes = 0;
+			double elapsed    = RunPooled( world, swarm, numPlayers, numThreads, ticks, stateBytes );
+			if ( t == 0 )
+			{
+				serialTime = elapsed;
+			}
+			double speedup = elapsed > 0.0 ? serialTime / elapsed : 0.0;
+			printf( "%8d %7d %11.1f %9.3f %12.3f %7.2fx %5.0f%% %9d %9d\n", numPlayers, numThreads,
+			        ticks / elapsed, elapsed * 1000.0 / ticks, elapsed * 1e6 / ( (double)ticks * numPlayers ),
+			        speedup, speedup * 100.0 / numThreads, stateBytes / 1024, ResidentKB() );
+		}
+	}
+
+	for ( int s=0; s < sizes.Count(); ++s )
+	{
+		RunSpread( world, swarm, sizes[s] );
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+// -------------------------------------------------------------------------------------------------
+// Headless tick benchmark. Drives MotionDriver::PlayerMove() in a tight loop against a small SimWorld
+// arena (floor, walls, a stair flight, a walkable ramp and a too-steep one) and reports ticks/sec
+// plus traces/touches per tick and the trace cache hit rate.
+//
+//   ml_tickbench [ticks] [tickrate] [trace.json]
+//
+// MOTIONLAB_PROFILE builds also print per-stage timings, and capture the tail of the run as a
+// Chrome trace if a file is given.
+//
+// Player velocity is scripted every tick (see ScriptRunInput). Everything downstream of that
+// (forces, slide, step, ground snapping) runs for real.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+
+int main( int argc, char** argv )
+{
+	int   ticks    = argc > 1 ? atoi( argv[1] ) : 1000000;
+	float tickRate = argc > 2 ? (float)atof( argv[2] ) : 128.0f;
+	float frameTime = 1.0f / tickRate;
+
+	SimWorld world;
+	BuildArena( world );
+
+	SimBackend backend;
+	backend.Setup( &world );
+
+	MotionDriver driver;
+	driver.SetBackend( &backend );
+
+	SimPlayer player;
+	CMoveData mv;
+	InitSimMoveData( mv, ArenaSpawnPoint( world, 0 ) );
+
+#ifdef MOTIONLAB_PROFILE
+	const char* tracePath = argc > 3 ? argv[3] : NULL;
+	driver.GetProfiler().SetCapture( tracePath != NULL );
+#endif
+
+	double start = Plat_FloatTime();
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		ScriptRunInput( tick, 0, mv );
+		driver.ProcessMovement( &player, &mv, frameTime );
+	}
+	double elapsed = Plat_FloatTime() - start;
+
+	printf( "brushes:        %d\n",    world.BrushCount() );
+	printf( "ticks:          %d @ %.0f Hz\n", ticks, tickRate );
+	printf( "elapsed:        %.3f s\n", elapsed );
+	printf( "ticks/sec:      %.0f\n",  ticks / elapsed );
+	printf( "ns/tick:        %.1f\n",  elapsed * 1e9 / ticks );
+	printf( "traces/tick:    %.2f\n",  (double)backend.TraceCount / ticks );
+	printf( "touches/tick:   %.2f\n",  (double)backend.TouchCount / ticks );
+	printf( "cache hits:     %.2f/tick (%lld misses)\n",
+	        (double)driver.GetTraceCache().Hits / ticks, driver.GetTraceCache().Misses );
+	printf( "ground reuse:   %lld of %lld categorizations\n",
+	        driver.GroundContactsReused(), driver.GroundContactsReused() + driver.GroundProbesRun() );
+	printf( "local traces:   %.1f%% (avg %.1f of %d brushes)\n",
+	        backend.TraceCount ? 100.0 * backend.LocalTraceCount / backend.TraceCount : 0.0,
+	        backend.SnapshotCount ? (double)backend.SnapshotBrushes / backend.SnapshotCount : 0.0, world.BrushCount() );
+	printf( "final origin:   %.3f %.3f %.3f\n", mv.GetAbsOrigin().x, mv.GetAbsOrigin().y, mv.GetAbsOrigin().z );
+
+	printf( "\n" );
+	driver.GetMoveCounters().Dump();
+
+#ifdef MOTIONLAB_PROFILE
+	printf( "\n" );
+	driver.GetProfiler().Dump( 0 );
+	if ( tracePath )
+	{
+		CUtlBuffer          buf;
+		const TickProfiler* prof = &driver.GetProfiler();
+		TickProfiler::WriteChromeTrace( buf, &prof, 1 );
+		FILE* fp = fopen( tracePath, "wb" );
+		if ( fp )
+		{
+			fwrite( buf.Base(), 1, buf.TellPut(), fp );
+			fclose( fp );
+		}
+	}
+#endif
+	return 0;
+}
@@ -0,0 +1,220 @@
+#include "cbase.h"
+#include <stdio.h>
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+#include "ml_trajectoryreader.h"
+
+using namespace motionlab;
+
+
+TrajectoryReader::TrajectoryReader()
+{
+	Base    = NULL;
+	Size    = 0;
+	Rows    = 0;
+	Indexed = false;
+}
+
+
+TrajectoryReader::~TrajectoryReader()
+{
+	Close();
+}
+
+
+bool TrajectoryReader::Open( const char* path )
+{
+	Close();
+
+#ifdef _WIN32
+	FILE* f = fopen( path, "rb" );
+	if ( !f )
+	{
+		return false;
+	}
+	fseek( f, 0, SEEK_END );
+	long length = ftell( f );
+	fseek( f, 0, SEEK_SET );
+	Contents.SetCount( MAX( length, 0L ) );
+	bool ok = length > 0 && fread( Contents.Base(), 1, length, f ) == (size_t)length;
+	fclose( f );
+	if ( !ok )
+	{
+		Contents.Purge();
+		return false;
+	}
+	Base = Contents.Base();
+	Size = length;
+#else
+	int fd = open( path, O_RDONLY );
+	if ( fd < 0 )
+	{
+		return false;
+	}
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 || st.st_size <= 0 )
+	{
+		::close( fd );
+		return false;
+	}
+	void* mapped = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close( fd );  // the mapping keeps the file alive
+	if ( mapped == MAP_FAILED )
+	{
+		return false;
+	}
+	madvise( mapped, st.st_size, MADV_SEQUENTIAL );
+	Base = (const uint8*)mapped;
+	Size = st.st_size;
+#endif
+
+	const TrajFileHeader* header = (const TrajFileHeader*)Base;
+	if ( Size < sizeof( TrajFileHeader ) || header->Magic != TRAJ_MAGIC || header->Version != TRAJ_VERSION
+	     || header->ColumnCount != TRAJ_COLUMN_COUNT || header->Align != TRAJ_ALIGN )
+	{
+		Close();
+		return false;
+	}
+
+	LoadIndex();
+	if ( !Indexed )
+	{
+		WalkChunks();
+	}
+	for ( int i=0; i < Chunks.Count(); ++i )
+	{
+		Rows += Chunks[i]->Rows;
+	}
+	return true;
+}
+
+
+void TrajectoryReader::Close()
+{
+	if ( Base )
+	{
+	#ifdef _WIN32
+		Contents.Purge();
+	#else
+		munmap( (void*)Base, Size );
+	#endif
+	}
+	Base    = NULL;
+	Size    = 0;
+	Rows    = 0;
+	Indexed = false;
+	Chunks.RemoveAll();
+}
+
+
+// Header plus every column has to fit inside the file
+bool TrajectoryReader::ChunkValid( uint64 offset ) const
+{
+	if ( offset % TRAJ_ALIGN || offset + sizeof( TrajChunkHeader ) > Size )
+	{
+		return false;
+	}
+	const TrajChunkHeader* chunk = (const TrajChunkHeader*)( Base + offset );
+	if ( chunk->Magic != TRAJ_CHUNK_MAGIC || chunk->Size < sizeof( TrajChunkHeader ) || chunk->Size > Size - offset )
+	{
+		return false;
+	}
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		if ( chunk->ColumnOffset[c] % TRAJ_ALIGN || chunk->ColumnOffset[c] + (uint64)chunk->Rows * TrajColumnSize( c ) > chunk->Size )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void TrajectoryReader::LoadIndex()
+{
+	if ( Size < sizeof( TrajFileHeader ) + sizeof( TrajFooter ) )
+	{
+		return;
+	}
+	const TrajFooter* footer = (const TrajFooter*)( Base + Size - sizeof( TrajFooter ) );
+	if ( footer->Magic != TRAJ_FOOTER_MAGIC
+	     || footer->IndexOffset + (uint64)footer->ChunkCount * sizeof( uint64 ) != Size - sizeof( TrajFooter ) )
+	{
+		return;
+	}
+
+	// The index sits wherever the last chunk ended, so it may not be 8-byte aligned - copy offsets out
+	const uint8* index = Base + footer->IndexOffset;
+	for ( uint32 i=0; i < footer->ChunkCount; ++i )
+	{
+		uint64 offset;
+		Q_memcpy( &offset, index + i * sizeof( uint64 ), sizeof( offset ) );
+		if ( !ChunkValid( offset ) )
+		{
+			Chunks.RemoveAll();
+			return;
+		}
+		Chunks.AddToTail( (const TrajChunkHeader*)( Base + offset ) );
+	}
+	Indexed = true;
+}
+
+
+void TrajectoryReader::WalkChunks()
+{
+	uint64 offset = ( sizeof( TrajFileHeader ) + TRAJ_ALIGN - 1 ) & ~(uint64)( TRAJ_ALIGN - 1 );
+	while ( ChunkValid( offset ) )
+	{
+		const TrajChunkHeader* chunk = (const TrajChunkHeader*)( Base + offset );
+		Chunks.AddToTail( chunk );
+		offset += chunk->Size;
+	}
+}
+
+
+int TrajectoryReader::ChunkCount() const
+{
+	return Chunks.Count();
+}
+
+
+int64 TrajectoryReader::RowCount() const
+{
+	return Rows;
+}
+
+
+uint64 TrajectoryReader::FileSize() const
+{
+	return Size;
+}
+
+
+bool TrajectoryReader::HadIndex() const
+{
+	return Indexed;
+}
+
+
+const TrajChunkHeader& TrajectoryReader::Chunk( int chunk ) const
+{
+	return *Chunks[ chunk ];
+}
+
+
+const void* TrajectoryReader::Column( int chunk, int column ) const
+{
+	const TrajChunkHeader* header = Chunks[ chunk ];
+	return (const uint8*)header + header->ColumnOffset[ column ];
+}
+
+
+bool TrajectoryReader::ChunkOverlaps( int chunk, int column, double lo, double hi ) const
+{
+	const TrajChunkHeader* header = Chunks[ chunk ];
+	return header->Max[ column ] >= lo && header->Min[ column ] <= hi;
+}
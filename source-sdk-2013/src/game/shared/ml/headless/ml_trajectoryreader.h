@@ -0,0 +1,52 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "ml_trajectory.h"
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Zero-copy reader for .mltj trajectory files. Maps the whole file and hands out pointers straight
+// into it - columns are aligned and already in memory order, so there's nothing to parse beyond the
+// chunk headers. Uses the index if the file has one, otherwise walks the chunks (a capture whose
+// writer never got to Close()). Anything that doesn't check out stops the walk there.
+// -------------------------------------------------------------------------------------------------
+class TrajectoryReader
+{
+	public:
+		TrajectoryReader();
+		~TrajectoryReader();
+
+		bool   Open( const char* path );
+		void   Close();
+
+		int    ChunkCount() const;
+		int64  RowCount() const;
+		uint64 FileSize() const;
+		bool   HadIndex() const;
+
+		const TrajChunkHeader& Chunk( int chunk ) const;
+		const void*            Column( int chunk, int column ) const;
+		const int32*           IntColumn( int chunk, int column ) const    { return (const int32*)Column( chunk, column ); }
+		const float*           FloatColumn( int chunk, int column ) const  { return (const float*)Column( chunk, column ); }
+		const uint8*           ByteColumn( int chunk, int column ) const   { return (const uint8*)Column( chunk, column ); }
+
+		// Could any row in this chunk have lo <= column <= hi? From the chunk stats, no data touched.
+		bool   ChunkOverlaps( int chunk, int column, double lo, double hi ) const;
+
+	private:
+		const uint8*              Base;
+		uint64                    Size;
+		CUtlVector<const TrajChunkHeader*> Chunks;
+		int64                     Rows;
+		bool                      Indexed;
+	#ifdef _WIN32
+		CUtlVector<uint8>         Contents;  // no mmap here, just read it in
+	#endif
+
+		bool   ChunkValid( uint64 offset ) const;
+		void   LoadIndex();
+		void   WalkChunks();
+};
+
+} // namespace motionlab
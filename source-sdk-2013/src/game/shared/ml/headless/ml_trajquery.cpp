@@ -0,0 +1,236 @@
+// -------------------------------------------------------------------------------------------------
+// Headless .mltj trajectory tool (ml_trajectory.h).
+//
+//   ml_trajquery synth <out.mltj> [players] [ticks]        simulate a crowd in the arena and write it
+//   ml_trajquery convert <telemetry.bin> <out.mltj>       ml_telemetry_start capture -> trajectory
+//   ml_trajquery info <file.mltj>                         chunks, rows, per-column ranges
+//   ml_trajquery speed <file.mltj> <minSpeed> <x> <y> <z> <radius>
+//                                                         count rows faster than minSpeed within
+//                                                         radius of a point
+//
+// The speed query is the pattern the format is built for: chunk stats rule out most chunks (speed
+// max below the cut, position box outside the sphere's), and what's left gets scanned a column at
+// a time straight out of the mapping.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "igamemovement.h"
+#include "ml_motiondriver.h"
+#include "ml_telemetry.h"
+#include "ml_trajectory.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+#include "ml_trajectoryreader.h"
+
+using namespace motionlab;
+
+
+static int Synth( const char* path, int numPlayers, int ticks )
+{
+	SimWorld world;
+	BuildArena( world );
+	SimBackend backend;
+	backend.Setup( &world );
+	MotionDriver driver;
+	driver.SetBackend( &backend );
+	driver.GetGroundMemory().Reserve( numPlayers );
+
+	// Publish through a ring as a server would, but drain it ourselves each tick instead of
+	// running a writer thread, so nothing gets dropped
+	TelemetryRing ring( numPlayers );
+	driver.SetTelemetry( &ring );
+
+	CUtlVector<SimPlayer> players;
+	CUtlVector<CMoveData> moves;
+	players.SetCount( numPlayers );
+	moves.SetCount( numPlayers );
+	for ( int i=0; i < numPlayers; ++i )
+	{
+		InitSimMoveData( moves[i], ArenaSpawnPoint( world, i ) );
+		players[i].EntIndex = i + 1;
+	}
+
+	TrajectoryWriter writer;
+	if ( !writer.Open( path ) )
+	{
+		printf( "couldn't open %s\n", path );
+		return 1;
+	}
+
+	CUtlVector<TelemetryRecord> recs;
+	recs.SetCount( numPlayers );
+	for ( int tick=0; tick < ticks; ++tick )
+	{
+		for ( int i=0; i < numPlayers; ++i )
+		{
+			ScriptInput( (ScriptPattern)( i % SCRIPT_PATTERN_COUNT ), tick, i, moves[i] );
+			players[i].m_nTickBase = tick;
+			driver.MovePlayer( &players[i], &moves[i], 1.0f / 128.0f );
+		}
+		int n = ring.Pop( recs.Base(), numPlayers );
+		for ( int i=0; i < n; ++i )
+		{
+			TrajectorySample sample;
+			SampleFromTelemetry( recs[i], sample );
+			writer.Append( sample );
+		}
+	}
+	writer.Close();
+	printf( "wrote %lld rows in %d chunks to %s\n", writer.RowsWritten(), writer.ChunksWritten(), path );
+	return 0;
+}
+
+
+static int Convert( const char* inPath, const char* outPath )
+{
+	FILE* in = fopen( inPath, "rb" );
+	if ( !in )
+	{
+		printf( "couldn't open %s\n", inPath );
+		return 1;
+	}
+	uint32 header[3];
+	if ( fread( header, sizeof( header ), 1, in ) != 1 || header[0] != TELEMETRY_MAGIC || header[1] != TELEMETRY_VERSION
+	     || header[2] != sizeof( TelemetryRecord ) )
+	{
+		printf( "%s isn't a telemetry capture this build can read\n", inPath );
+		fclose( in );
+		return 1;
+	}
+
+	TrajectoryWriter writer;
+	if ( !writer.Open( outPath ) )
+	{
+		printf( "couldn't open %s\n", outPath );
+		fclose( in );
+		return 1;
+	}
+
+	TelemetryRecord recs[ 1024 ];
+	size_t n;
+	while ( ( n = fread( recs, sizeof( TelemetryRecord ), ARRAYSIZE( recs ), in ) ) > 0 )
+	{
+		for ( size_t i=0; i < n; ++i )
+		{
+			TrajectorySample sample;
+			SampleFromTelemetry( recs[i], sample );
+			writer.Append( sample );
+		}
+	}
+	fclose( in );
+	writer.Close();
+	printf( "wrote %lld rows in %d chunks to %s\n", writer.RowsWritten(), writer.ChunksWritten(), outPath );
+	return 0;
+}
+
+
+static int Info( const TrajectoryReader& reader )
+{
+	printf( "size:           %.1f MB (%.1f bytes/row)\n", reader.FileSize() / ( 1024.0 * 1024.0 ),
+	        reader.RowCount() ? (double)reader.FileSize() / reader.RowCount() : 0.0 );
+	printf( "rows:           %lld\n", reader.RowCount() );
+	printf( "chunks:         %d (%s)\n", reader.ChunkCount(), reader.HadIndex() ? "indexed" : "no index, walked" );
+	printf( "\n%-10s %14s %14s\n", "column", "min", "max" );
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		double lo = 0.0, hi = 0.0;
+		for ( int i=0; i < reader.ChunkCount(); ++i )
+		{
+			lo = i ? MIN( lo, reader.Chunk( i ).Min[c] ) : reader.Chunk( i ).Min[c];
+			hi = i ? MAX( hi, reader.Chunk( i ).Max[c] ) : reader.Chunk( i ).Max[c];
+		}
+		printf( "%-10s %14.3f %14.3f\n", TrajColumnName( c ), lo, hi );
+	}
+	return 0;
+}
+
+
+static int SpeedQuery( const TrajectoryReader& reader, float minSpeed, const Vector& center, float radius )
+{
+	double t0 = Plat_FloatTime();
+
+	int   scanned   = 0;
+	int64 matches   = 0;
+	int   firstTick = -1, firstPlayer = -1;
+	float radiusSqr = radius * radius;
+	for ( int i=0; i < reader.ChunkCount(); ++i )
+	{
+		if ( !reader.ChunkOverlaps( i, TRAJ_SPEED, minSpeed, FLT_MAX )
+		     || !reader.ChunkOverlaps( i, TRAJ_POS_X, center.x - radius, center.x + radius )
+		     || !reader.ChunkOverlaps( i, TRAJ_POS_Y, center.y - radius, center.y + radius )
+		     || !reader.ChunkOverlaps( i, TRAJ_POS_Z, center.z - radius, center.z + radius ) )
+		{
+			continue;
+		}
+		++scanned;
+
+		int          rows  = reader.Chunk( i ).Rows;
+		const float* speed = reader.FloatColumn( i, TRAJ_SPEED );
+		const float* px    = reader.FloatColumn( i, TRAJ_POS_X );
+		const float* py    = reader.FloatColumn( i, TRAJ_POS_Y );
+		const float* pz    = reader.FloatColumn( i, TRAJ_POS_Z );
+		for ( int r=0; r < rows; ++r )
+		{
+			if ( speed[r] <= minSpeed )
+			{
+				continue;
+			}
+			float dx = px[r] - center.x, dy = py[r] - center.y, dz = pz[r] - center.z;
+			if ( dx * dx + dy * dy + dz * dz > radiusSqr )
+			{
+				continue;
+			}
+			if ( !matches++ )
+			{
+				firstTick   = reader.IntColumn( i, TRAJ_TICK )[r];
+				firstPlayer = reader.IntColumn( i, TRAJ_PLAYER )[r];
+			}
+		}
+	}
+
+	double elapsed = Plat_FloatTime() - t0;
+	printf( "matches:        %lld of %lld rows\n", matches, reader.RowCount() );
+	printf( "chunks scanned: %d of %d\n", scanned, reader.ChunkCount() );
+	printf( "elapsed:        %.3f ms\n", elapsed * 1000.0 );
+	if ( matches )
+	{
+		printf( "first:          tick %d, player %d\n", firstTick, firstPlayer );
+	}
+	return 0;
+}
+
+
+int main( int argc, char** argv )
+{
+	const char* cmd = argc > 1 ? argv[1] : "";
+	if ( !Q_stricmp( cmd, "synth" ) && argc > 2 )
+	{
+		return Synth( argv[2], argc > 3 ? atoi( argv[3] ) : 64, argc > 4 ? atoi( argv[4] ) : 12800 );
+	}
+	if ( !Q_stricmp( cmd, "convert" ) && argc > 3 )
+	{
+		return Convert( argv[2], argv[3] );
+	}
+	if ( ( !Q_stricmp( cmd, "info" ) && argc > 2 ) || ( !Q_stricmp( cmd, "speed" ) && argc > 7 ) )
+	{
+		TrajectoryReader reader;
+		if ( !reader.Open( argv[2] ) )
+		{
+			printf( "couldn't read %s\n", argv[2] );
+			return 1;
+		}
+		if ( !Q_stricmp( cmd, "info" ) )
+		{
+			return Info( reader );
+		}
+		Vector center( (float)atof( argv[4] ), (float)atof( argv[5] ), (float)atof( argv[6] ) );
+		return SpeedQuery( reader, (float)atof( argv[3] ), center, (float)atof( argv[7] ) );
+	}
+
+	printf( "usage: ml_trajquery synth <out.mltj> [players] [ticks]\n"
+	        "       ml_trajquery convert <telemetry.bin> <out.mltj>\n"
+	        "       ml_trajquery info <file.mltj>\n"
+	        "       ml_trajquery speed <file.mltj> <minSpeed> <x> <y> <z> <radius>\n" );
+	return 1;
+}
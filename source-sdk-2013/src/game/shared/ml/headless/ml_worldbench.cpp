@@ -0,0 +1,150 @@
+// -------------------------------------------------------------------------------------------------
+// Headless collision world benchmark. Fires the same batch of random player-hull sweeps at a
+// SimWorld through its brush tree and brute force over every brush, and reports trace throughput
+// for each plus any trace where the two disagree (there shouldn't be any - see SimWorld).
+//
+//   ml_worldbench [brushes | file.brushes] [traces]
+//
+// A number generates a town of that many blocks, ramps and pillars around the arena; anything
+// else is loaded as a brush file (see LoadBrushFile). Most sweeps are movement sized (up to 64u),
+// one in ten is long (up to 2048u), like a ground probe or a bot's line of sight.
+// -------------------------------------------------------------------------------------------------
+#include "cbase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "igamemovement.h"
+#include "ml_simworld.h"
+#include "ml_simarena.h"
+
+using namespace motionlab;
+
+static const Vector HULL_MINS( -16.0f, -16.0f,  0.0f );
+static const Vector HULL_MAXS(  16.0f,  16.0f, 72.0f );
+
+
+static float RandomRange( float lo, float hi )
+{
+	return lo + ( rand() / (float)RAND_MAX ) * ( hi - lo );
+}
+
+
+// Arena plus count brushes scattered over a square that grows with the count, so density stays
+// about the same and only the brush count changes
+static void BuildTown( SimWorld& world, int count )
+{
+	BuildArena( world );
+	int ice = world.AddSurface( 0.1f, 'I' );
+
+	float half = MAX( 1024.0f, sqrtf( (float)count ) * 160.0f );  // never smaller than the arena
+	world.AddBox( Vector( -half, -half, -128.0f ), Vector( half, half, -64.0f ) );
+	for ( int i=0; i < count; ++i )
+	{
+		float x = RandomRange( -half, half );
+		float y = RandomRange( -half, half );
+		if ( i % 8 == 0 )
+		{
+			AddRamp( world, x, RandomRange( 64.0f, 256.0f ), RandomRange( 16.0f, 192.0f ), y, y + RandomRange( 64.0f, 256.0f ), ice );
+			continue;
+		}
+		float w = i % 8 == 1 ? 32.0f : RandomRange( 32.0f, 256.0f );  // pillars or blocks
+		float d = i % 8 == 1 ? 32.0f : RandomRange( 32.0f, 256.0f );
+		world.AddBox( Vector( x, y, 0.0f ), Vector( x + w, y + d, RandomRange( 16.0f, 320.0f ) ) );
+	}
+	world.BuildTree();
+}
+
+
+static bool SameTrace( const hulltrace& a, const hulltrace& b )
+{
+	return a.fraction == b.fraction && a.endpos == b.endpos && a.plane.normal == b.plane.normal && a.plane.dist == b.plane.dist
+	       && a.startsolid == b.startsolid && a.allsolid == b.allsolid && a.surface.surfaceProps == b.surface.surfaceProps
+	       && a.contents == b.contents && a.m_pEnt == b.m_pEnt;
+}
+
+
+int main( int argc, char** argv )
+{
+	const char* source    = argc > 1 ? argv[1] : "4096";
+	int         numTraces = argc > 2 ? atoi( argv[2] ) : 250000;
+	srand( 1 );
+
+	SimWorld world;
+	double   buildStart = Plat_FloatTime();
+	if ( isdigit( (unsigned char)source[0] ) )
+	{
+		BuildTown( world, atoi( source ) );
+	}
+	else if ( !LoadBrushFile( world, source ) )
+	{
+		printf( "couldn't load %s\n", source );
+		return 1;
+	}
+	double buildTime = Plat_FloatTime() - buildStart;
+
+	Vector worldMins, worldMaxs;
+	world.GetBounds( worldMins, worldMaxs );
+
+	CUtlVector<Vector> starts, ends;
+	starts.SetCount( numTraces );
+	ends.SetCount( numTraces );
+	for ( int i=0; i < numTraces; ++i )
+	{
+		starts[i].Init( RandomRange( worldMins.x, worldMaxs.x ), RandomRange( worldMins.y, worldMaxs.y ),
+		                RandomRange( worldMins.z, MIN( worldMaxs.z, worldMins.z + 512.0f ) ) );
+		Vector dir( RandomRange( -1.0f, 1.0f ), RandomRange( -1.0f, 1.0f ), RandomRange( -0.5f, 0.5f ) );
+		VectorNormalize( dir );
+		ends[i] = starts[i] + dir * ( i % 10 ? RandomRange( 0.0f, 64.0f ) : RandomRange( 64.0f, 2048.0f ) );
+	}
+
+	// Brute force = every brush as an explicit list, which skips the tree
+	CUtlVector<int> allBrushes;
+	allBrushes.SetCount( world.BrushCount() );
+	for ( int i=0; i < allBrushes.Count(); ++i )
+	{
+		allBrushes[i] = i;
+	}
+
+	CUtlVector<hulltrace> treeResults;
+	treeResults.SetCount( numTraces );
+	double start = Plat_FloatTime();
+	for ( int i=0; i < numTraces; ++i )
+	{
+		world.TraceHull( starts[i], ends[i], HULL_MINS, HULL_MAXS, MASK_PLAYERSOLID, treeResults[i] );
+	}
+	double treeTime = Plat_FloatTime() - start;
+
+	int64 mismatches = 0, hits = 0, startSolid = 0;
+	start = Plat_FloatTime();
+	for ( int i=0; i < numTraces; ++i )
+	{
+		hulltrace tr;
+		world.TraceHullSubset( starts[i], ends[i], HULL_MINS, HULL_MAXS, MASK_PLAYERSOLID, allBrushes, tr );
+		mismatches += !SameTrace( tr, treeResults[i] );
+	}
+	double bruteTime = Plat_FloatTime() - start;
+
+	// How much the tree narrows things down: brushes overlapping each sweep's bounds
+	CUtlVector<int> gathered;
+	int64 candidates = 0;
+	for ( int i=0; i < numTraces; ++i )
+	{
+		hits       += treeResults[i].fraction < 1.0f;
+		startSolid += treeResults[i].startsolid;
+		Vector sweepMins, sweepMaxs;
+		VectorMin( starts[i], ends[i], sweepMins );
+		VectorMax( starts[i], ends[i], sweepMaxs );
+		world.GatherBrushes( sweepMins + HULL_MINS, sweepMaxs + HULL_MAXS, gathered );
+		candidates += gathered.Count();
+	}
+
+	printf( "brushes:        %d (%s, built in %.2f ms)\n", world.BrushCount(), world.HasTree() ? "tree" : "no tree", buildTime * 1000.0 );
+	printf( "traces:         %d (%.1f%% hit, %.1f%% start solid)\n", numTraces,
+	        100.0 * hits / MAX( numTraces, 1 ), 100.0 * startSolid / MAX( numTraces, 1 ) );
+	printf( "candidates:     %.2f brushes/trace\n", (double)candidates / MAX( numTraces, 1 ) );
+	printf( "tree:           %.0f traces/sec (%.1f ns/trace)\n", numTraces / treeTime, treeTime * 1e9 / MAX( numTraces, 1 ) );
+	printf( "brute force:    %.0f traces/sec (%.1f ns/trace)\n", numTraces / bruteTime, bruteTime * 1e9 / MAX( numTraces, 1 ) );
+	printf( "speedup:        %.1fx\n", bruteTime / treeTime );
+	printf( "mismatches:     %lld\n", mismatches );
+	return mismatches ? 1 : 0;
+}
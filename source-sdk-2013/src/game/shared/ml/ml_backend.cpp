@@ -0,0 +1,157 @@
+#include "cbase.h"
+#include "igamemovement.h"
+#include "physics_shared.h"  // physprops
+#include "engine/IEngineTrace.h"  // CTraceListData, enginetrace leaf/entity list traces
+#include "ml_backend.h"
+
+#include "tier0/memdbgon.h"
+
+// Headless builds bring their own backend, nothing in here exists without the engine
+#ifndef MOTIONLAB_HEADLESS
+
+using namespace motionlab;
+
+
+EngineMotionBackend::EngineMotionBackend()
+{
+	LocalActive = false;
+	LocalList   = NULL;
+	Setup( NULL );
+}
+
+
+EngineMotionBackend::~EngineMotionBackend()
+{
+	delete LocalList;
+}
+
+
+// MDriver calls this per tick per player so traces skip the player being moved
+void EngineMotionBackend::Setup( CMoveData* moveData )
+{
+	mv = moveData;
+}
+
+
+// Same as CGameMovement::TryTouchGround/TracePlayerBBox, just with the hull passed in explicitly.
+// Inside a local snapshot the filter is the same one UTIL_TraceRay builds, only the leaves and
+// entities come from the list gathered in BeginLocalQueries instead of a fresh partition walk.
+void EngineMotionBackend::TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                                     unsigned int mask, int collisionGroup, hulltrace& tr )
+{
+	Ray_t ray;
+	ray.Init( start, end, mins, maxs );
+
+	if ( LocalActive )
+	{
+		Vector sweepMins, sweepMaxs;
+		SweptHullBounds( start, end, mins, maxs, sweepMins, sweepMaxs );
+		if ( BoxContainsBox( LocalMins, LocalMaxs, sweepMins, sweepMaxs ) )
+		{
+			CTraceFilterSimple filter( mv->m_nPlayerHandle.Get(), collisionGroup );
+			enginetrace->TraceRayAgainstLeafAndEntityList( ray, *LocalList, mask, &filter, &tr );
+			return;
+		}
+	}
+
+	UTIL_TraceRay( ray, mask, mv->m_nPlayerHandle.Get(), collisionGroup, &tr );
+}
+
+
+bool EngineMotionBackend::TraceHitWorld( const hulltrace& tr ) const
+{
+	return tr.DidHitWorld();
+}
+
+
+// Straight off the physprops global (what MoveHelper()->GetSurfaceProps() returns anyway) so the
+// surface table can be built at level init, before any MoveHelper exists on the client
+surfacedata* EngineMotionBackend::SurfaceData( int surfaceProps ) const
+{
+	return physprops ? physprops->GetSurfaceData( surfaceProps ) : NULL;
+}
+
+
+int EngineMotionBackend::SurfacePropCount() const
+{
+	return physprops ? physprops->SurfacePropCount() : 0;
+}
+
+
+const SurfaceTable& EngineMotionBackend::Surfaces() const
+{
+	return g_MotionSurfaces;
+}
+
+
+Vector EngineMotionBackend::EntityVelocity( CBaseEntity* ent ) const
+{
+	return ent ? ent->GetAbsVelocity() : vec3_origin;
+}
+
+
+void EngineMotionBackend::ResetTouchList()
+{
+	MoveHelper()->ResetTouchList();
+}
+
+
+bool EngineMotionBackend::AddToTouched( const hulltrace& tr, const Vector& impactVel )
+{
+	return MoveHelper()->AddToTouched( tr, impactVel );
+}
+
+
+// Nothing but the player being moved changes during Move(), and it's filtered out of every trace
+// anyway, so the leaves and entities overlapping the box stay valid until EndLocalQueries()
+bool EngineMotionBackend::BeginLocalQueries( const Vector& mins, const Vector& maxs )
+{
+	if ( !LocalList )
+	{
+		LocalList = new CTraceListData;
+	}
+	LocalList->Reset();
+	enginetrace->SetupLeafAndEntityListBox( mins, maxs, *LocalList );
+	LocalMins   = mins;
+	LocalMaxs   = maxs;
+	LocalActive = true;
+	return true;
+}
+
+
+void EngineMotionBackend::EndLocalQueries()
+{
+	LocalActive = false;
+}
+
+
+int EngineMotionBackend::EntitiesInBox( const Vector& mins, const Vector& maxs, EntityPose* out, int maxOut ) const
+{
+	const int   MAX_LISTED = 64;
+	CBaseEntity* list[ MAX_LISTED ];
+	int         listed = UTIL_EntitiesInBox( list, MAX_LISTED, mins, maxs, 0 );
+	if ( listed >= MAX_LISTED )
+	{
+		return listed;  // might have missed some, caller will treat it as too many anyway
+	}
+
+	int count = 0;
+	for ( int i=0; i < listed; ++i )
+	{
+		CBaseEntity* ent = list[i];
+		if ( !ent->IsSolid() || ent->GetRefEHandle() == mv->m_nPlayerHandle )
+		{
+			continue;
+		}
+		if ( count < maxOut )
+		{
+			out[ count ].Ent    = ent;
+			out[ count ].Origin = ent->GetAbsOrigin();
+			out[ count ].Angles = ent->GetAbsAngles();
+		}
+		++count;
+	}
+	return count;
+}
+
+#endif // MOTIONLAB_HEADLESS
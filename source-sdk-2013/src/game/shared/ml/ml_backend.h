@@ -0,0 +1,121 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_surfacetable.h"
+
+class CBaseEntity;
+class CMoveData;
+class CTraceListData;
+
+namespace motionlab {
+
+// Where an entity was when a backend was asked about it, see MotionBackend::EntitiesInBox
+struct EntityPose
+{
+	CBaseEntity* Ent;
+	Vector       Origin;
+	QAngle       Angles;
+};
+
+
+// Swept bounds of a hull trace, padded so geometry right at the edge still gets clipped. A trace
+// can use a local snapshot only if these fit inside the snapshot box.
+inline void SweptHullBounds( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                             Vector& outMins, Vector& outMaxs )
+{
+	VectorMin( start, end, outMins );
+	VectorMax( start, end, outMaxs );
+	outMins += mins - Vector( 1.0f, 1.0f, 1.0f );
+	outMaxs += maxs + Vector( 1.0f, 1.0f, 1.0f );
+}
+
+
+inline bool BoxContainsBox( const Vector& outerMins, const Vector& outerMaxs,
+                            const Vector& innerMins, const Vector& innerMaxs )
+{
+	return innerMins.x >= outerMins.x && innerMins.y >= outerMins.y && innerMins.z >= outerMins.z &&
+	       innerMaxs.x <= outerMaxs.x && innerMaxs.y <= outerMaxs.y && innerMaxs.z <= outerMaxs.z;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// Everything MotionDriver needs from the world, behind one interface. In the game DLLs this is
+// EngineMotionBackend, which just forwards to UTIL_TraceRay and MoveHelper(). Headless builds plug
+// in an in-process collision world instead (headless/ml_simworld.h), so PlayerMove() can be run
+// in a tight loop without the engine.
+// -------------------------------------------------------------------------------------------------
+class MotionBackend
+{
+	public:
+		virtual ~MotionBackend() {}
+
+		// Collision queries
+		virtual void         TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                                unsigned int mask, int collisionGroup, hulltrace& tr ) = 0;
+		virtual bool         TraceHitWorld( const hulltrace& tr ) const = 0;
+
+		// Surface/entity properties. Per-tick lookups should go through Surfaces(), the raw
+		// SurfaceData() is for building that table.
+		virtual surfacedata* SurfaceData( int surfaceProps ) const = 0;
+		virtual int          SurfacePropCount() const = 0;
+		virtual const SurfaceTable& Surfaces() const = 0;
+		virtual Vector       EntityVelocity( CBaseEntity* ent ) const = 0;
+
+		// Move helper bookkeeping
+		virtual void         ResetTouchList() = 0;
+		virtual bool         AddToTouched( const hulltrace& tr, const Vector& impactVel ) = 0;
+
+		// Can several drivers, each with their own instance of this backend, move players at once?
+		// The engine backend funnels into MoveHelper() and entity ground lists, so it can't.
+		virtual bool         SupportsParallelMoves() const { return false; }
+
+		// Optional local snapshot. Called once per Move() with the box this tick's traces can reach.
+		// A backend that can cheaply pull the geometry overlapping it into a local set answers every
+		// TraceHull that stays inside the box from that set until EndLocalQueries(), and anything that
+		// reaches outside still goes to the full world. Returns false if it doesn't do snapshots.
+		virtual bool         BeginLocalQueries( const Vector& mins, const Vector& maxs ) { return false; }
+		virtual void         EndLocalQueries() {}
+
+		// Optional. Fills out with every solid non-world entity overlapping the box (not counting the
+		// player being moved) and returns how many there are, which can be more than maxOut. -1 if the
+		// backend can't enumerate - the prediction cache stays off then.
+		virtual int          EntitiesInBox( const Vector& mins, const Vector& maxs, EntityPose* out, int maxOut ) const { return -1; }
+};
+
+
+#ifndef MOTIONLAB_HEADLESS
+// Default backend for the game DLLs - does exactly what CGameMovement's trace wrappers do. Local
+// snapshots go through the engine's own leaf/entity list traces.
+class EngineMotionBackend : public MotionBackend
+{
+	private:
+		CMoveData*      mv;  // only needed for the pass entity handle
+
+		// Local snapshot state, see MotionBackend::BeginLocalQueries
+		bool            LocalActive;
+		Vector          LocalMins;
+		Vector          LocalMaxs;
+		CTraceListData* LocalList;  // made on first use, it's big
+
+	public:
+		EngineMotionBackend();
+		~EngineMotionBackend();
+		void Setup( CMoveData* moveData );
+
+		virtual void         TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                                unsigned int mask, int collisionGroup, hulltrace& tr ) OVERRIDE;
+		virtual bool         TraceHitWorld( const hulltrace& tr ) const OVERRIDE;
+		virtual surfacedata* SurfaceData( int surfaceProps ) const OVERRIDE;
+		virtual int          SurfacePropCount() const OVERRIDE;
+		virtual const SurfaceTable& Surfaces() const OVERRIDE;
+		virtual Vector       EntityVelocity( CBaseEntity* ent ) const OVERRIDE;
+		virtual void         ResetTouchList() OVERRIDE;
+		virtual bool         AddToTouched( const hulltrace& tr, const Vector& impactVel ) OVERRIDE;
+		virtual bool         BeginLocalQueries( const Vector& mins, const Vector& maxs ) OVERRIDE;
+		virtual void         EndLocalQueries() OVERRIDE;
+		virtual int          EntitiesInBox( const Vector& mins, const Vector& maxs, EntityPose* out, int maxOut ) const OVERRIDE;
+};
+#endif
+
+} // namespace motionlab
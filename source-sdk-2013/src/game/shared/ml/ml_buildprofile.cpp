@@ -0,0 +1,139 @@
+#include "cbase.h"
+#include "ml_buildprofile.h"
+
+using namespace motionlab;
+
+
+// Placeholder numbers, what every player used to get reset to each tick
+BuildProfile::BuildProfile()
+{
+	Mass       = 100.0f;
+	DragCoeff  = 1.0f;
+	BoostForce = 1.0f;
+	JumpForce  = 1.0f;
+	Archetype  = ARCHETYPE_STANDARD;
+	Derive();
+}
+
+
+BuildProfile::BuildProfile( float mass, float dragCoeff, float boostForce, float jumpForce,
+                            MovementArchetype archetype )
+{
+	Mass       = mass;
+	DragCoeff  = dragCoeff;
+	BoostForce = boostForce;
+	JumpForce  = jumpForce;
+	Archetype  = archetype;
+	Derive();
+}
+
+
+void BuildProfile::Derive()
+{
+	Assert( Mass > 0.0f );
+	InvMass     = 1.0f / Mass;
+	DragPerMass = DragCoeff * InvMass;
+	JumpAccel   = JumpForce * InvMass;
+}
+
+
+bool BuildProfile::SameBuild( const BuildProfile& other ) const
+{
+	return Mass       == other.Mass
+	    && DragCoeff  == other.DragCoeff
+	    && BoostForce == other.BoostForce
+	    && JumpForce  == other.JumpForce
+	    && Archetype  == other.Archetype;
+}
+
+
+BuildProfileStore::BuildProfileStore()
+{
+	Clear();
+	Reserve( ABSOLUTE_PLAYER_LIMIT );
+}
+
+
+void BuildProfileStore::Reserve( int maxPlayerIndex )
+{
+	int oldCount = PlayerProfiles.Count();
+	if ( maxPlayerIndex + 1 > oldCount )
+	{
+		PlayerProfiles.SetCount( maxPlayerIndex + 1 );
+		for ( int i=oldCount; i < PlayerProfiles.Count(); ++i )
+		{
+			PlayerProfiles[i] = 0;
+		}
+	}
+}
+
+
+void BuildProfileStore::Clear()
+{
+	Profiles.RemoveAll();
+	Profiles.AddToTail( BuildProfile() );
+	for ( int i=0; i < PlayerProfiles.Count(); ++i )
+	{
+		PlayerProfiles[i] = 0;
+	}
+}
+
+
+int BuildProfileStore::ProfileCount() const
+{
+	return Profiles.Count();
+}
+
+
+int BuildProfileStore::AddProfile( const BuildProfile& profile )
+{
+	int idx = Profiles.AddToTail( profile );
+	Profiles[ idx ].Derive();
+	return idx;
+}
+
+
+// Builds are few, a linear scan is fine
+int BuildProfileStore::FindOrAddProfile( const BuildProfile& profile )
+{
+	for ( int i=0; i < Profiles.Count(); ++i )
+	{
+		if ( Profiles[i].SameBuild( profile ) )
+		{
+			return i;
+		}
+	}
+	return AddProfile( profile );
+}
+
+
+void BuildProfileStore::SetProfile( int profileIndex, const BuildProfile& profile )
+{
+	if ( !Profiles.IsValidIndex( profileIndex ) )
+	{
+		return;
+	}
+	Profiles[ profileIndex ] = profile;
+	Profiles[ profileIndex ].Derive();
+}
+
+
+const BuildProfile& BuildProfileStore::GetProfile( int profileIndex ) const
+{
+	return Profiles.IsValidIndex( profileIndex ) ? Profiles[ profileIndex ] : Profiles[0];
+}
+
+
+void BuildProfileStore::AssignPlayer( int playerIndex, int profileIndex )
+{
+	if ( PlayerProfiles.IsValidIndex( playerIndex ) && Profiles.IsValidIndex( profileIndex ) )
+	{
+		PlayerProfiles[ playerIndex ] = (uint16)profileIndex;
+	}
+}
+
+
+const BuildProfile& BuildProfileStore::ForPlayer( int playerIndex ) const
+{
+	return Profiles[ PlayerProfiles.IsValidIndex( playerIndex ) ? PlayerProfiles[ playerIndex ] : 0 ];
+}
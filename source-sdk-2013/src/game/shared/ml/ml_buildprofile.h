@@ -0,0 +1,75 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+// Which compile-time force model a build runs, see ml_forcemodel.h
+enum MovementArchetype
+{
+	ARCHETYPE_STANDARD = 0,
+	ARCHETYPE_DRAGLESS,
+
+	ARCHETYPE_COUNT
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// A player build's movement properties plus everything the hot path derives from them. The derived
+// fields get filled in by Derive() when the profile is stored and never per tick, so the force model
+// and Accelerate read one 32-byte record instead of redoing divides.
+// -------------------------------------------------------------------------------------------------
+struct BuildProfile
+{
+	// Defined by the build
+	float             Mass;
+	float             DragCoeff;
+	float             BoostForce;
+	float             JumpForce;
+	MovementArchetype Archetype;
+
+	// Derived, see Derive()
+	float             InvMass;
+	float             DragPerMass;  // k/m, what the closed-form drag flow wants
+	float             JumpAccel;    // JumpForce/m
+
+	BuildProfile();
+	BuildProfile( float mass, float dragCoeff, float boostForce, float jumpForce,
+	              MovementArchetype archetype = ARCHETYPE_STANDARD );
+
+	void Derive();
+	bool SameBuild( const BuildProfile& other ) const;  // compares the defined fields only
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Build profiles plus which one each player (by entindex) is running. Profile 0 is the default
+// build and always exists, so every player resolves to something. Profiles only change when a build
+// does (SetProfile/AssignPlayer), never from inside PlayerMove.
+// Same sharing rules as GroundContactStore: MovementPool drivers all read one store, and nothing
+// may modify it while a Run() is in flight.
+// -------------------------------------------------------------------------------------------------
+class BuildProfileStore
+{
+	private:
+		CUtlVector<BuildProfile> Profiles;
+		CUtlVector<uint16>       PlayerProfiles;  // [entindex] -> Profiles index
+
+	public:
+		BuildProfileStore();
+
+		void                Reserve( int maxPlayerIndex );  // not thread safe, call before moving anyone
+		void                Clear();                        // back to just the default build, everyone on it
+
+		int                 ProfileCount() const;
+		int                 AddProfile( const BuildProfile& profile );
+		int                 FindOrAddProfile( const BuildProfile& profile );
+		void                SetProfile( int profileIndex, const BuildProfile& profile );  // re-derives
+		const BuildProfile& GetProfile( int profileIndex ) const;
+
+		void                AssignPlayer( int playerIndex, int profileIndex );
+		const BuildProfile& ForPlayer( int playerIndex ) const;  // default build if unassigned/out of range
+};
+
+} // namespace motionlab
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ml_defs.h"
+#include "ml_simd.h"
+
+namespace motionlab {
+
+enum ClipOutcome
+{
+	CLIP_PLANE = 0,  // slid along one plane
+	CLIP_CREASE,     // slid along the edge between two planes
+	CLIP_CORNER,     // boxed in, nothing feasible but zero
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Velocity clipping against every plane Slide has hit this segment. Up to two planes this is the
+// old deflect logic unchanged: the first single-plane deflect (in hit order, OVERCLIP included)
+// that doesn't push into any other plane, else the crease between the two.
+//
+// Three or more planes used to always zero the velocity. The allowed velocities are the cone
+// { v : v·n >= 0 for every plane }, and in 3D a crease of that cone is always the edge between two
+// of the planes - so try every pair and slide along the clear edge that keeps the most speed. Only
+// when none is clear (truly boxed in) does it come out zero. With MAX_CLIPS planes that's at most
+// 10 edges, no traces involved.
+// -------------------------------------------------------------------------------------------------
+inline ClipOutcome SolveClipVelocity( const Vec4& vel, const Vec4* planes, int numPlanes, Vec4& outVel )
+{
+	// Single planes, first one that clears the rest
+	for ( int i=0; i < numPlanes; ++i )
+	{
+		Vec4 candidate = Vec4Deflect( vel, planes[i], OVERCLIP );
+		bool clear     = true;
+		for ( int j=0; j < numPlanes && clear; ++j )
+		{
+			clear = ( j == i ) || Vec4Dot( candidate, planes[j] ) >= 0.0f;
+		}
+		if ( clear )
+		{
+			outVel = candidate;
+			return CLIP_PLANE;
+		}
+	}
+
+	// Two planes - slide along the crease between them
+	if ( numPlanes == 2 )
+	{
+		Vec4 creaseDir = Vec4Normalize( Vec4Cross( planes[0], planes[1] ) );
+		outVel = creaseDir * Vec4Dot( creaseDir, vel );
+		return CLIP_CREASE;
+	}
+
+	// Corner - keep the clear edge that preserves the most speed along it
+	float bestKeep = -1.0f;
+	for ( int i=0; i < numPlanes; ++i )
+	{
+		for ( int j=i+1; j < numPlanes; ++j )
+		{
+			Vec4 edge = Vec4Cross( planes[i], planes[j] );
+			if ( Vec4Dot( edge, edge ) < 1e-6f )
+			{
+				continue;  // (nearly) parallel planes, no edge
+			}
+			edge = Vec4Normalize( edge );
+
+			float along     = Vec4Dot( edge, vel );
+			Vec4  candidate = edge * along;
+			bool  clear     = true;
+			for ( int k=0; k < numPlanes && clear; ++k )
+			{
+				clear = ( k == i ) || ( k == j ) || Vec4Dot( candidate, planes[k] ) >= 0.0f;
+			}
+			if ( clear && along * along > bestKeep )
+			{
+				bestKeep = along * along;
+				outVel   = candidate;
+			}
+		}
+	}
+	if ( bestKeep >= 0.0f )
+	{
+		return CLIP_CREASE;
+	}
+
+	outVel = Vec4Zero();
+	return CLIP_CORNER;
+}
+
+} // namespace motionlab
@@ -6,6 +6,12 @@
 #include "coordsize.h"
 #include "vphysics_interface.h"
 
+#ifdef MOTIONLAB_HEADLESS
+	#include "headless/ml_simplayer.h"
+#else
+	class CBasePlayer;
+#endif
+
 // MotionLab namespace - provides contained set of constants and aliases for ml ops
 namespace motionlab {
 
@@ -16,6 +22,13 @@ namespace motionlab {
 	using hulltrace   = trace_t; 
 	using surfacedata = surfacedata_t;
 
+	// Whatever MLabPlayer wraps - the real CBasePlayer in the game DLLs, a plain stand-in headless
+	#ifdef MOTIONLAB_HEADLESS
+		using PlayerEntity = SimPlayer;
+	#else
+		using PlayerEntity = CBasePlayer;
+	#endif
+
 	// -----------------------------------------------------------------------------------------
 	// Numeric constants
 	// -----------------------------------------------------------------------------------------
@@ -27,6 +40,8 @@ namespace motionlab {
 	constexpr float OVERCLIP        = 1.001f;
 	constexpr float STEP_EPS        = DIST_EPSILON;
 	constexpr float MIN_VEL         = 0.1f;
+	constexpr float JUMP_TICK       = 1.0f / 128.0f;  // JumpForce is tuned as one tick of force at 128 tick
+	constexpr float STEP_PROBE_DIST = 2.0f;   // how far into a wall the raised step probe reaches
 
 	// -----------------------------------------------------------------------------------------
 	// Direction constants
@@ -0,0 +1,69 @@
+#include "cbase.h"
+#include "ml_file.h"
+
+#ifdef MOTIONLAB_HEADLESS
+	#include <stdio.h>
+#else
+	#include "filesystem.h"
+#endif
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+OutputFile::OutputFile()
+{
+	Handle = NULL;
+}
+
+
+OutputFile::~OutputFile()
+{
+	Close();
+}
+
+
+bool OutputFile::Open( const char* path )
+{
+	Close();
+
+#ifdef MOTIONLAB_HEADLESS
+	Handle = fopen( path, "wb" );
+#else
+	Handle = filesystem->Open( path, "wb", "MOD" );
+#endif
+	return Handle != NULL;
+}
+
+
+void OutputFile::Write( const void* data, int bytes )
+{
+#ifdef MOTIONLAB_HEADLESS
+	fwrite( data, 1, bytes, (FILE*)Handle );
+#else
+	filesystem->Write( data, bytes, (FileHandle_t)Handle );
+#endif
+}
+
+
+void OutputFile::Close()
+{
+	if ( !Handle )
+	{
+		return;
+	}
+
+#ifdef MOTIONLAB_HEADLESS
+	fclose( (FILE*)Handle );
+#else
+	filesystem->Close( (FileHandle_t)Handle );
+#endif
+	Handle = NULL;
+}
+
+
+bool OutputFile::IsOpen() const
+{
+	return Handle != NULL;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Write-only binary file for the stuff motionlab dumps to disk (recordings, telemetry, trajectory
+// files). Plain stdio headless, the engine filesystem under the MOD path in the game DLLs.
+// -------------------------------------------------------------------------------------------------
+class OutputFile
+{
+	private:
+		void* Handle;  // FILE* headless, FileHandle_t in the game DLLs
+
+	public:
+		OutputFile();
+		~OutputFile();
+
+		bool Open( const char* path );  // truncates whatever was there, false if it can't be opened
+		void Write( const void* data, int bytes );
+		void Close();
+		bool IsOpen() const;
+};
+
+} // namespace motionlab
@@ -0,0 +1,138 @@
+#include "cbase.h"
+#include "ml_defs.h"
+#include "ml_forcemath.h"
+#include "ml_forcemodel.h"
+#include "ml_forcebatch.h"
+
+using namespace motionlab;
+
+
+void BatchVecColumn::SetCount( int count )
+{
+	X.SetCount( count );
+	Y.SetCount( count );
+	Z.SetCount( count );
+}
+
+
+Vector BatchVecColumn::Get( int row ) const
+{
+	return Vector( X[ row ], Y[ row ], Z[ row ] );
+}
+
+
+void BatchVecColumn::Set( int row, const Vector& v )
+{
+	X[ row ] = v.x;
+	Y[ row ] = v.y;
+	Z[ row ] = v.z;
+}
+
+
+PlayerBatch::PlayerBatch()
+{
+	Begin( 0, 0.0f, 0.0f );
+}
+
+
+// Sizes every column for this tick. CUtlVector keeps its allocation, so after the first few ticks
+// at a given player count this doesn't touch the heap.
+void PlayerBatch::Begin( int count, float frameTime, float gravity )
+{
+	RowCount  = count;
+	FrameTime = frameTime;
+	Gravity   = gravity;
+
+	Active.SetCount( count );
+	Pos.SetCount( count );
+	Vel.SetCount( count );
+	GroundNormal.SetCount( count );
+	GroundFriction.SetCount( count );
+	Grounded.SetCount( count );
+	CanJump.SetCount( count );
+	ForwardVal.SetCount( count );
+	StrafeVal.SetCount( count );
+	JumpPressed.SetCount( count );
+	ForwardDir.SetCount( count );
+	StrafeDir.SetCount( count );
+	Build.SetCount( count );
+	ClosedForm.SetCount( count );
+	WASDForce.SetCount( count );
+	FrictionForce.SetCount( count );
+	NetForce.SetCount( count );
+	GravForce.SetCount( count );
+	JumpForce.SetCount( count );
+	AppliedDrag.SetCount( count );
+	FrictionDecel.SetCount( count );
+	Jumped.SetCount( count );
+
+	for ( int i=0; i < count; ++i )
+	{
+		Active[i] = 0;
+	}
+}
+
+
+int PlayerBatch::Count() const
+{
+	return RowCount;
+}
+
+
+// One pass over the whole batch. Reads are all column-contiguous, no per-player pointer chasing.
+// Each row goes through the same EvaluateForces as ForceCalculator, so results are bit-identical
+// to the serial path.
+void motionlab::RunForceBatch( PlayerBatch& batch )
+{
+	const int   count     = batch.Count();
+	const float frameTime = batch.FrameTime;
+	const float gravity   = batch.Gravity;
+
+	ForceContext ctx;
+	ForceResult  forces;
+	ctx.Gravity   = gravity;
+	ctx.FrameTime = frameTime;
+
+	for ( int i=0; i < count; ++i )
+	{
+		if ( !batch.Active[i] )
+		{
+			continue;
+		}
+
+		ctx.Vel            = batch.Vel.Get( i );
+		ctx.GroundNormal   = batch.GroundNormal.Get( i );
+		ctx.ForwardDir     = batch.ForwardDir.Get( i );
+		ctx.StrafeDir      = batch.StrafeDir.Get( i );
+		ctx.Build          = batch.Build[i];
+		ctx.GroundFriction = batch.GroundFriction[i];
+		ctx.ForwardVal     = batch.ForwardVal[i];
+		ctx.StrafeVal      = batch.StrafeVal[i];
+		ctx.Grounded       = batch.Grounded[i] != 0;
+		ctx.CanJump        = batch.CanJump[i] != 0;
+		ctx.JumpPressed    = batch.JumpPressed[i] != 0;
+
+		EvaluateForces( ctx, forces );
+
+		const float invMass = ctx.Build->InvMass;
+		if ( batch.ClosedForm[i] )
+		{
+			// Same as MotionDriver::Accelerate's first half, BatchFinish does the second
+			Vector vel = ctx.Vel + forces.Jump * ( JUMP_TICK * invMass );
+			batch.Vel.Set( i, ClosedFormStep( vel, forces.WASD + forces.Grav, invMass, forces.DragPerMass,
+			                                  forces.FrictionDecel, ctx.GroundNormal, 0.5f * frameTime ) );
+		}
+		else
+		{
+			batch.Vel.Set( i, IntegrateVelocity( ctx.Vel, forces.Net, invMass, frameTime ) );
+		}
+		batch.WASDForce.Set( i, forces.WASD );
+		batch.FrictionForce.Set( i, forces.Friction );
+		batch.NetForce.Set( i, forces.Net );
+		batch.GravForce.Set( i, forces.Grav );
+		batch.JumpForce.Set( i, forces.Jump );
+		batch.AppliedDrag[i]   = forces.DragPerMass;
+		batch.FrictionDecel[i] = forces.FrictionDecel;
+		batch.Jumped[i]        = forces.Jumped ? 1 : 0;
+	}
+}
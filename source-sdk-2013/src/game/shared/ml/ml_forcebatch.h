@@ -0,0 +1,81 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "tier1/utlvector.h"
+#include "ml_buildprofile.h"
+
+namespace motionlab {
+
+// One Vector quantity for every player in the batch, stored as three flat float arrays
+struct BatchVecColumn
+{
+	CUtlVector<float> X;
+	CUtlVector<float> Y;
+	CUtlVector<float> Z;
+
+	void   SetCount( int count );
+	Vector Get( int row ) const;
+	void   Set( int row, const Vector& v );
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Structure-of-arrays view of everyone's force inputs/outputs for one tick. MotionDriver fills a
+// row per player (BatchGather), RunForceBatch does CalcCurrentForces + Accelerate for every row
+// in one pass, then MotionDriver picks each row back up for SyncVPhys + Move (BatchFinish).
+// -------------------------------------------------------------------------------------------------
+class PlayerBatch
+{
+	public:
+		PlayerBatch();
+		void  Begin( int count, float frameTime, float gravity );  // gravity from MotionDriver::GetMovementConfig()
+		int   Count() const;
+
+		// Per-tick globals
+		float             FrameTime;
+		float             Gravity;
+
+		// Row was gathered and should be run (stuck players get skipped, same as PlayerMove)
+		CUtlVector<uint8> Active;
+
+		// Kinematic state - velocity is integrated in place, both hold end-of-tick values after finish
+		BatchVecColumn    Pos;
+		BatchVecColumn    Vel;
+
+		// Ground state
+		BatchVecColumn    GroundNormal;
+		CUtlVector<float> GroundFriction;
+		CUtlVector<uint8> Grounded;
+		CUtlVector<uint8> CanJump;
+
+		// Inputs and movement axes
+		CUtlVector<float> ForwardVal;
+		CUtlVector<float> StrafeVal;
+		CUtlVector<uint8> JumpPressed;
+		BatchVecColumn    ForwardDir;
+		BatchVecColumn    StrafeDir;
+
+		// Build constants - a handful of profiles shared by everyone, so these stay cache-hot
+		CUtlVector<const BuildProfile*> Build;
+		CUtlVector<uint8> ClosedForm;   // driver's ClosedFormIntegration - only the first half-tick runs here
+
+		// Outputs needed downstream (SyncVPhys reads WASD + friction + jumped, FinishAccelerate gravity + drag/decel,
+		// telemetry the lot)
+		BatchVecColumn    WASDForce;
+		BatchVecColumn    FrictionForce;
+		BatchVecColumn    NetForce;
+		BatchVecColumn    GravForce;
+		BatchVecColumn    JumpForce;
+		CUtlVector<float> AppliedDrag;
+		CUtlVector<float> FrictionDecel;
+		CUtlVector<uint8> Jumped;
+
+	private:
+		int               RowCount;
+};
+
+
+// Forces + Accelerate for every active row, same model evaluation as ForceCalculator/MotionDriver::Accelerate
+void RunForceBatch( PlayerBatch& batch );
+
+} // namespace motionlab
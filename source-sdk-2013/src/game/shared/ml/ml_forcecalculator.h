@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mathlib/vector.h"
+#include "ml_forcemodel.h"
 
 class CBasePlayer;
 class CMoveData;
@@ -9,44 +10,27 @@ namespace motionlab {
 
 class InputReader;
 class MLabPlayer;
-	
+struct MovementConfig;
+
+// Gathers this tick's ForceContext from the player + inputs and runs the player's archetype model
+// over it (see ml_forcemodel.h)
 class ForceCalculator 
 {
 	public:
 		ForceCalculator();
-		void  Setup( InputReader* pInput, MLabPlayer* mlPlayer, float frameTime );		
+		void  Setup( InputReader* pInput, MLabPlayer* mlPlayer, const MovementConfig* config, float frameTime );
 		float FRAMETIME;
 	
-		// Pointer to current player + inputs being processed
+		// Pointer to current player + inputs being processed, and this frame's movement config
 		InputReader* PlayerInput;
 		MLabPlayer*  MLPlayer;
+		const MovementConfig* Config;
 	
 		// Force calc results stored here for reading downstream
-		Vector       CurrentFrictionForce;
-		Vector       CurrentDragForce;
-		Vector       CurrentWASDForce;
-		Vector       CurrentGravForce;
-		Vector       CurrentJumpForce;
-		Vector       CurrentDriveForce;
-		Vector       CurrentResistForce;
-		Vector       CurrentNetForce;
-		bool         PlayerJumped;  // need to signal this for downstream bookkeeping
+		ForceResult  Forces;
 
 		// Public interface
 		void         CalcCurrentForces();
-
-	private:
-		// Vector math helpers
-		void         VectorProjectOntoPlane( Vector& v, const Vector& planeNormal ) const;
-		void         VectorRescale( Vector& v, const float targetLength ) const;
-	
-		// Force calculation methods
-		void         CalcAirDrag();
-		void         CalcFriction();
-		void         CalcResistForce();
-		void         CalcPlanarDrivers();
-		void         CalcVerticalDrivers();
-		void         CalcDriveForce();
 };
 
-} // namespace motionlab
\ No newline at end of file
+} // namespace motionlab
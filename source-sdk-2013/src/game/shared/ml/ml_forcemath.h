@@ -0,0 +1,250 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "mathlib/mathlib.h"
+#include "ml_defs.h"
+#include "ml_simd.h"
+
+// -------------------------------------------------------------------------------------------------
+// The actual force/integration formulas, as stateless inlines. ForceCalculator and the batched SoA
+// kernel (ml_forcebatch) both go through these, so the two paths can't drift apart numerically.
+//
+// SSE builds do anything with more than one vector op in Vec4 (ml_simd.h) and reuse lengths they
+// already have instead of renormalizing - same maths, different rounding (VectorNormalize's
+// FLT_EPSILON only shows below a length of about 2). MOTIONLAB_SCALAR_MATH builds keep the
+// original VectorNormalize formulas, so they reproduce pre-SIMD results exactly.
+// -------------------------------------------------------------------------------------------------
+namespace motionlab {
+
+// Project vector onto plane: v_projected = v - (v · n̂) * n̂
+inline void VectorProjectOntoPlane( Vector& v, const Vector& planeNormal )
+{
+#ifdef MOTIONLAB_SSE
+	v = Vec4Store( Vec4ProjectOntoPlane( Vec4Load( v ), Vec4Load( planeNormal ) ) );
+#else
+	float dot = DotProduct( v,planeNormal );
+	v.x -= planeNormal.x * dot;
+	v.y -= planeNormal.y * dot;
+	v.z -= planeNormal.z * dot;
+#endif
+}
+
+inline void VectorRescale( Vector& v, const float targetLength )
+{
+#ifdef MOTIONLAB_SSE
+	v = Vec4Store( Vec4Rescale( Vec4Load( v ), targetLength ) );
+#else
+	VectorNormalize( v );
+	v *= targetLength;
+#endif
+}
+
+
+// Quadratic air drag: F_drag = -k * |v|² * v̂ = -k * |v| * v
+inline Vector AirDragForce( const Vector& vel, float dragCoeff )
+{
+#ifdef MOTIONLAB_SSE
+	Vec4  v     = Vec4Load( vel );
+	float speed = Vec4Length( v );
+	return Vec4Store( v * ( -dragCoeff * speed ) );
+#else
+	Vector dragForce( 0.0f, 0.0f, 0.0f );
+	float  speed = vel.Length();
+	if ( speed > 0.0f )
+	{
+		float  dragMag = dragCoeff * ( speed * speed );
+		Vector dragDir = vel * -1.0f;
+		VectorNormalize( dragDir );
+		dragForce = dragDir * dragMag;
+	}
+	return dragForce;
+#endif
+}
+
+
+// Kinetic friction: f = μN, N = m*g*cos(θ). Caller checks grounding.
+inline Vector FrictionForce( const Vector& vel, const Vector& groundNormal, float friction, float mass,
+                             float gravity, float frameTime )
+{
+	// Project velocity onto ground plane
+#ifdef MOTIONLAB_SSE
+	Vec4  tangentV = Vec4ProjectOntoPlane( Vec4Load( vel ), Vec4Load( groundNormal ) );
+	float tanSpeed = Vec4Length( tangentV );
+#else
+	Vector tangentV = vel;
+	VectorProjectOntoPlane( tangentV, groundNormal );
+	float  tanSpeed = tangentV.Length();
+#endif
+	if ( tanSpeed <= 0.0f )
+	{
+		return Vector( 0.0f, 0.0f, 0.0f );
+	}
+
+	// Normal force: N = m*g*cos(θ), cos(θ) = n̂⋅up
+	float nDot = DotProduct( groundNormal, WORLD_UP );
+	float N    = mass * gravity * nDot;
+
+	// Friction magnitude: f = μN, but make sure we don't accidentally reverse movement dir
+	float f    = friction * N;
+	float fMax = ( tanSpeed * mass ) / frameTime; // Force that will stop the player
+	f = MIN( f,fMax );                            // Prevent friction from reversing vel
+
+	// Apply friction in opposite direction to surface velocity
+#ifdef MOTIONLAB_SSE
+	return Vec4Store( tangentV * ( -f / tanSpeed ) );  // tangentV / tanSpeed is the unit dir
+#else
+	Vector fDir = tangentV * -1.0f;
+	VectorNormalize( fDir );
+	return f * fDir;
+#endif
+}
+
+
+// Planar input force from WASD axes (each in [-1,1])
+inline Vector PlanarDriveForce( const Vector& fwdDir, const Vector& strafeDir, float fwdVal, float strafeVal,
+                                float boostForce, bool grounded, const Vector& groundNormal )
+{
+#ifdef MOTIONLAB_SSE
+	Vec4  inputDir = Vec4Load( fwdDir ) * fwdVal + Vec4Load( strafeDir ) * strafeVal;
+	float inputMag = Vec4Length( inputDir );
+	if ( inputMag <= 0.0f )
+	{
+		return Vector( 0.0f, 0.0f, 0.0f );
+	}
+
+	// Clamp diagonal input to unit length
+	Vec4 wasdForce = inputDir * ( inputMag > 1.0f ? boostForce / inputMag : boostForce );
+
+	// Project onto ground plane if grounded, otherwise keep horizontal
+	if ( grounded )
+	{
+		wasdForce = Vec4ProjectOntoPlane( wasdForce, Vec4Load( groundNormal ) );
+		wasdForce = Vec4Rescale( wasdForce, boostForce );  // prevent projection slowdown on slopes
+	}
+	return Vec4Store( wasdForce );
+#else
+	Vector wasdForce( 0.0f, 0.0f, 0.0f );
+	Vector fwdInput  = fwdDir    * fwdVal;
+	Vector sideInput = strafeDir * strafeVal;
+	Vector inputDir  = fwdInput + sideInput;
+	float  inputMag  = inputDir.Length();
+
+	if ( inputMag > 0.0f )
+	{
+		if ( inputMag > 1.0f )
+		{
+			VectorNormalize( inputDir );
+		}
+
+		wasdForce = inputDir * boostForce;
+
+		// Project onto ground plane if grounded, otherwise keep horizontal
+		if ( grounded )
+		{
+			VectorProjectOntoPlane( wasdForce, groundNormal );
+			VectorRescale( wasdForce, boostForce );  // prevent projection slowdown on slopes
+		}
+	}
+	return wasdForce;
+#endif
+}
+
+
+// Jump while grounded (if allowed), gravity while airborne. Returns true if a jump fired.
+inline bool VerticalDriveForces( bool grounded, bool canJump, bool jumpPressed, float jumpForce, float mass,
+                                 float gravity, Vector& jumpForceOut, Vector& gravForceOut )
+{
+	if ( grounded )
+	{
+		if ( canJump && jumpPressed )
+		{
+			jumpForceOut = WORLD_UP * jumpForce;
+			return true;
+		}
+	}
+	else
+	{
+		gravForceOut = WORLD_DOWN * ( gravity * mass );
+	}
+	return false;
+}
+
+
+// F = ma -> a = F/m -> dv = a*dt
+inline Vector IntegrateVelocity( const Vector& vel, const Vector& netForce, float invMass, float frameTime )
+{
+	Vector acceleration = netForce * invMass;
+	Vector deltaVel     = acceleration * frameTime;
+	Vector newVel       = vel + deltaVel;
+	if ( newVel.Length() < MIN_VEL )
+	{
+		newVel.Zero();  // do not do Zeno paradox
+	}
+	return newVel;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// Closed-form integration (MotionOptions::ClosedFormIntegration). Euler above bakes the tick length
+// into the answer: drag is evaluated at the start velocity for the whole tick, and friction needs
+// the fMax clamp to not overshoot. Taken one at a time, though, each force has an exact solution:
+//   drive/gravity   m dv/dt = F           ->  v(t) = v0 + F/m * t
+//   air drag        m dv/dt = -k|v|v      ->  v(t) = v0 / ( 1 + k|v0|t/m ), direction unchanged
+//   friction        tangential speed drops at μg·cosθ until it hits zero, and stays there
+// ClosedFormStep composes these symmetrically (Strang splitting), which is exact whenever only one
+// of them is acting and second order in t when they mix. With MotionDriver running Move between
+// the two half-ticks, a drag-free jump/fall arc comes out the same at 32, 64 or 128 tick - with
+// drag in the mix it only converges at second order.
+// -------------------------------------------------------------------------------------------------
+inline Vector DragFlow( const Vector& vel, float dragPerMass, float t )
+{
+	float speed = vel.Length();
+	if ( speed <= 0.0f || dragPerMass <= 0.0f )
+	{
+		return vel;
+	}
+	return vel * ( 1.0f / ( 1.0f + dragPerMass * speed * t ) );
+}
+
+
+inline Vector FrictionFlow( const Vector& vel, const Vector& groundNormal, float frictionDecel, float t )
+{
+	if ( frictionDecel <= 0.0f )
+	{
+		return vel;
+	}
+
+	Vec4  v        = Vec4Load( vel );
+	Vec4  tangentV = Vec4ProjectOntoPlane( v, Vec4Load( groundNormal ) );
+	float tanSpeed = Vec4Length( tangentV );
+	if ( tanSpeed <= 0.0f )
+	{
+		return vel;
+	}
+
+	float newSpeed = MAX( 0.0f, tanSpeed - frictionDecel * t );  // stops dead, never reverses
+	return Vec4Store( v - tangentV * ( 1.0f - newSpeed / tanSpeed ) );
+}
+
+
+// Kinetic friction as a deceleration: f/m = μ*g*cos(θ). Zero while airborne.
+inline float FrictionDecel( bool grounded, const Vector& groundNormal, float friction, float gravity )
+{
+	return grounded ? friction * gravity * DotProduct( groundNormal, WORLD_UP ) : 0.0f;
+}
+
+
+// Drive (everything velocity-independent: WASD + gravity) half, friction half, drag, friction half,
+// drive half. No MIN_VEL snap here - the caller does that once the whole tick is in.
+inline Vector ClosedFormStep( const Vector& vel, const Vector& driveForce, float invMass, float dragPerMass,
+                              float frictionDecel, const Vector& groundNormal, float t )
+{
+	Vector halfDrive = driveForce * ( 0.5f * t * invMass );
+	Vector newVel    = vel + halfDrive;
+	newVel = FrictionFlow( newVel, groundNormal, frictionDecel, 0.5f * t );
+	newVel = DragFlow( newVel, dragPerMass, t );
+	newVel = FrictionFlow( newVel, groundNormal, frictionDecel, 0.5f * t );
+	return newVel + halfDrive;
+}
+
+} // namespace motionlab
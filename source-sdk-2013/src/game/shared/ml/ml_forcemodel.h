@@ -0,0 +1,161 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_forcemath.h"
+#include "ml_buildprofile.h"
+
+// -------------------------------------------------------------------------------------------------
+// Compile-time force pipelines. A movement archetype is a ForceModel<...> over a list of force
+// terms - each term is a struct with a static Apply() that adds its force into the running net.
+// Everything is FORCEINLINE and resolved at compile time, so a model flattens into one straight-line
+// kernel with no virtuals and no per-term branching beyond what the formulas themselves do.
+//
+// Only the per-term results something downstream actually reads get stored in ForceResult
+// (SyncVPhys wants WASD/friction/jumped, the closed-form integrator wants WASD/gravity/jump plus
+// the drag/friction the model actually applied) - drag, drive and resist subtotals just go
+// straight into Net.
+//
+// ForceCalculator and the SoA batch kernel (ml_forcebatch) both evaluate through EvaluateForces,
+// so for a given archetype they still agree bit for bit.
+// -------------------------------------------------------------------------------------------------
+namespace motionlab {
+
+// Everything a force term is allowed to read for one player, one tick
+struct ForceContext
+{
+	Vector Vel;
+	Vector GroundNormal;
+	Vector ForwardDir;
+	Vector StrafeDir;
+	const BuildProfile* Build;
+	float  GroundFriction;
+	float  ForwardVal;
+	float  StrafeVal;
+	float  Gravity;
+	float  FrameTime;
+	bool   Grounded;
+	bool   CanJump;
+	bool   JumpPressed;
+};
+
+
+struct ForceResult
+{
+	Vector Net;
+	Vector WASD;
+	Vector Friction;
+	Vector Jump;
+	Vector Grav;
+	float  DragPerMass;    // what the closed-form integrator should use - 0 if the model has no drag
+	float  FrictionDecel;  // ditto, 0 without friction or while airborne
+	bool   Jumped;         // need to signal this for downstream bookkeeping
+
+	void Clear()
+	{
+		Net.Init();
+		WASD.Init();
+		Friction.Init();
+		Jump.Init();
+		Grav.Init();
+		DragPerMass   = 0.0f;
+		FrictionDecel = 0.0f;
+		Jumped        = false;
+	}
+};
+
+
+// ----- FORCE TERMS -------------------------------------------------------------------------------
+
+// Quadratic air drag, always applies
+struct DragTerm
+{
+	static FORCEINLINE void Apply( const ForceContext& ctx, ForceResult& out )
+	{
+		out.Net        += AirDragForce( ctx.Vel, ctx.Build->DragCoeff );
+		out.DragPerMass = ctx.Build->DragPerMass;
+	}
+};
+
+// Kinetic friction, grounded only
+struct FrictionTerm
+{
+	static FORCEINLINE void Apply( const ForceContext& ctx, ForceResult& out )
+	{
+		if ( ctx.Grounded )
+		{
+			out.Friction = FrictionForce( ctx.Vel, ctx.GroundNormal, ctx.GroundFriction, ctx.Build->Mass,
+			                              ctx.Gravity, ctx.FrameTime );
+			out.Net     += out.Friction;
+			out.FrictionDecel = FrictionDecel( true, ctx.GroundNormal, ctx.GroundFriction, ctx.Gravity );
+		}
+	}
+};
+
+// WASD input, projected onto the ground while grounded
+struct WASDTerm
+{
+	static FORCEINLINE void Apply( const ForceContext& ctx, ForceResult& out )
+	{
+		out.WASD = PlanarDriveForce( ctx.ForwardDir, ctx.StrafeDir, ctx.ForwardVal, ctx.StrafeVal,
+		                             ctx.Build->BoostForce, ctx.Grounded, ctx.GroundNormal );
+		out.Net += out.WASD;
+	}
+};
+
+// Jump while grounded, gravity while airborne - one term since it's one grounded/airborne decision
+struct VerticalTerm
+{
+	static FORCEINLINE void Apply( const ForceContext& ctx, ForceResult& out )
+	{
+		out.Jumped = VerticalDriveForces( ctx.Grounded, ctx.CanJump, ctx.JumpPressed, ctx.Build->JumpForce,
+		                                  ctx.Build->Mass, ctx.Gravity, out.Jump, out.Grav );
+		out.Net   += out.Jump + out.Grav;
+	}
+};
+
+
+// ----- MODELS ------------------------------------------------------------------------------------
+
+template< typename... Terms >
+struct ForceModel;
+
+template<>
+struct ForceModel<>
+{
+	static FORCEINLINE void Accumulate( const ForceContext& ctx, ForceResult& out ) {}
+};
+
+template< typename Term, typename... Rest >
+struct ForceModel< Term, Rest... >
+{
+	static FORCEINLINE void Accumulate( const ForceContext& ctx, ForceResult& out )
+	{
+		Term::Apply( ctx, out );
+		ForceModel< Rest... >::Accumulate( ctx, out );
+	}
+
+	static FORCEINLINE void Evaluate( const ForceContext& ctx, ForceResult& out )
+	{
+		out.Clear();
+		Accumulate( ctx, out );
+	}
+};
+
+
+// Player archetypes. Add a model here + a MovementArchetype (ml_buildprofile.h) + a case below.
+using StandardForces = ForceModel< DragTerm, FrictionTerm, WASDTerm, VerticalTerm >;
+using DraglessForces = ForceModel< FrictionTerm, WASDTerm, VerticalTerm >;  // no air drag - keeps air speed
+
+
+// The one runtime branch: which model this player's build runs. Each case inlines its whole model.
+inline void EvaluateForces( const ForceContext& ctx, ForceResult& out )
+{
+	switch ( ctx.Build->Archetype )
+	{
+		case ARCHETYPE_DRAGLESS: DraglessForces::Evaluate( ctx, out ); break;
+		default:                 StandardForces::Evaluate( ctx, out ); break;
+	}
+}
+
+} // namespace motionlab
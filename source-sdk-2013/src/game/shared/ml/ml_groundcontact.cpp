@@ -0,0 +1,42 @@
+#include "cbase.h"
+#include "ml_groundcontact.h"
+
+using namespace motionlab;
+
+
+GroundContactStore::GroundContactStore()
+{
+	Reserve( ABSOLUTE_PLAYER_LIMIT );  // from const.h, enough for any engine game
+}
+
+
+void GroundContactStore::Reserve( int maxPlayerIndex )
+{
+	int oldCount = Contacts.Count();
+	if ( maxPlayerIndex + 1 > oldCount )
+	{
+		Contacts.SetCount( maxPlayerIndex + 1 );
+		for ( int i=oldCount; i < Contacts.Count(); ++i )
+		{
+			Contacts[i].Valid     = false;
+			Contacts[i].WallValid = false;
+		}
+	}
+}
+
+
+// Forget everyone, e.g. on level change
+void GroundContactStore::Clear()
+{
+	for ( int i=0; i < Contacts.Count(); ++i )
+	{
+		Contacts[i].Valid     = false;
+		Contacts[i].WallValid = false;
+	}
+}
+
+
+GroundContact* GroundContactStore::ForPlayer( int playerIndex )
+{
+	return Contacts.IsValidIndex( playerIndex ) ? &Contacts[ playerIndex ] : NULL;
+}
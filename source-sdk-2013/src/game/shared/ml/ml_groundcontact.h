@@ -0,0 +1,50 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+// What StayOnGround found under a player at the end of their last move
+struct GroundContact
+{
+	bool      Valid;
+	Vector    Position;  // player origin after the move
+	Vector    HullMins;
+	Vector    HullMaxs;
+	hulltrace Trace;     // the standable world hit
+
+	// Last wall Step was skipped for - a world plane that's still there one step up (WallTooTallToStep)
+	bool      WallValid;
+	Vector    WallPos;    // player origin at the contact it was probed from
+	float     WallStep;   // step height and hull it was probed with
+	Vector    WallMins;
+	Vector    WallMaxs;
+	hulltrace WallTrace;  // the raised probe's hit
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Per-player ground contact memory, indexed by player entindex. Lets CategorizePosition skip its
+// ground probe when the player is still exactly where last tick's StayOnGround left them, standing
+// on the world. Only world contacts get remembered - the world never moves, and entity pointers
+// can go stale between ticks. The same goes for the tall wall Step last decided not to bother
+// with, which lets a player pushing into a wall skip the step probe tick after tick.
+// Slots are fixed once sized, so drivers on different threads can share one store as long as no
+// two of them move the same player at once (which MovementPool guarantees).
+// -------------------------------------------------------------------------------------------------
+class GroundContactStore
+{
+	private:
+		CUtlVector<GroundContact> Contacts;
+
+	public:
+		GroundContactStore();
+
+		void           Reserve( int maxPlayerIndex );  // not thread safe, call before moving anyone
+		void           Clear();
+		GroundContact* ForPlayer( int playerIndex );   // NULL if the index is out of range
+};
+
+} // namespace motionlab
@@ -0,0 +1,177 @@
+#include "cbase.h"
+#include "ml_history.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+static const int   POS_BITS = 21;
+static const int   POS_BIAS = 1 << ( POS_BITS - 1 );
+static const int64 POS_MASK = ( 1LL << POS_BITS ) - 1;
+
+static const uint8 HISTFLAG_GROUNDED = 1;
+static const uint8 HISTFLAG_JUMPED   = 2;
+
+
+// ----- Quantization ------------------------------------------------------------------------------
+
+static int QuantizeClamped( float value, float step, int limit )
+{
+	int q = (int)floorf( value / step + 0.5f );
+	return clamp( q, -limit, limit );
+}
+
+static uint64 PackPosition( const Vector& pos )
+{
+	uint64 packed = 0;
+	for ( int i=0; i < 3; ++i )
+	{
+		int q   = QuantizeClamped( pos[i], HISTORY_POS_STEP, POS_BIAS - 1 ) + POS_BIAS;
+		packed |= (uint64)q << ( i * POS_BITS );
+	}
+	return packed;
+}
+
+static Vector UnpackPosition( uint64 packed )
+{
+	Vector pos;
+	for ( int i=0; i < 3; ++i )
+	{
+		int q  = (int)( ( packed >> ( i * POS_BITS ) ) & POS_MASK ) - POS_BIAS;
+		pos[i] = q * HISTORY_POS_STEP;
+	}
+	return pos;
+}
+
+static float SignNonZero( float f )
+{
+	return f < 0.0f ? -1.0f : 1.0f;
+}
+
+// Octahedral: project onto the |x|+|y|+|z| = 1 diamond, fold the lower half over the upper
+static void PackNormal( const Vector& n, int16* out )
+{
+	float l1 = fabsf( n.x ) + fabsf( n.y ) + fabsf( n.z );
+	float u  = l1 > 0.0f ? n.x / l1 : 0.0f;
+	float v  = l1 > 0.0f ? n.y / l1 : 0.0f;
+	if ( n.z < 0.0f )
+	{
+		float fu = ( 1.0f - fabsf( v ) ) * SignNonZero( u );
+		float fv = ( 1.0f - fabsf( u ) ) * SignNonZero( v );
+		u = fu;
+		v = fv;
+	}
+	out[0] = (int16)QuantizeClamped( u, 1.0f / 32767.0f, 32767 );
+	out[1] = (int16)QuantizeClamped( v, 1.0f / 32767.0f, 32767 );
+}
+
+static Vector UnpackNormal( const int16* in )
+{
+	float u = in[0] / 32767.0f;
+	float v = in[1] / 32767.0f;
+	Vector n( u, v, 1.0f - fabsf( u ) - fabsf( v ) );
+	if ( n.z < 0.0f )
+	{
+		n.x = ( 1.0f - fabsf( v ) ) * SignNonZero( u );
+		n.y = ( 1.0f - fabsf( u ) ) * SignNonZero( v );
+	}
+	VectorNormalize( n );
+	return n;
+}
+
+
+// ----- Store -------------------------------------------------------------------------------------
+
+MoveHistoryStore::MoveHistoryStore()
+{
+	Players   = 0;
+	TickCount = 0;
+}
+
+
+void MoveHistoryStore::Reserve( int maxPlayerIndex, int ticks )
+{
+	int rounded = ticks > 0 ? SmallestPowerOfTwoGreaterOrEqual( ticks ) : 0;
+	int players = rounded ? maxPlayerIndex + 1 : 0;
+	if ( players == Players && rounded == TickCount )
+	{
+		return;
+	}
+
+	Players   = players;
+	TickCount = rounded;
+	Frames.Purge();
+	Frames.SetCount( Players * TickCount );
+	Clear();
+}
+
+
+void MoveHistoryStore::Clear()
+{
+	for ( int i=0; i < Frames.Count(); ++i )
+	{
+		Frames[i].Tick = -1;
+	}
+}
+
+
+int MoveHistoryStore::Ticks() const
+{
+	return TickCount;
+}
+
+
+int MoveHistoryStore::MemoryUsed() const
+{
+	return Frames.Count() * sizeof( Frame );
+}
+
+
+void MoveHistoryStore::Record( int playerIndex, const MoveSnapshot& snap )
+{
+	if ( playerIndex < 0 || playerIndex >= Players )
+	{
+		return;
+	}
+
+	Frame& f = Frames[ playerIndex * TickCount + ( snap.Tick & ( TickCount - 1 ) ) ];
+	f.Pos  = PackPosition( snap.Position );
+	f.Tick = snap.Tick;
+	for ( int i=0; i < 3; ++i )
+	{
+		f.Vel[i] = (int16)QuantizeClamped( snap.Velocity[i], HISTORY_VEL_STEP, 32767 );
+		f.Force[i].SetFloat( clamp( snap.NetForce[i] * HISTORY_FORCE_SCALE, -65504.0f, 65504.0f ) );
+	}
+	PackNormal( snap.GroundNormal, f.Normal );
+	f.GroundEnt = (int16)snap.GroundEnt;
+	f.Flags     = ( snap.Grounded ? HISTFLAG_GROUNDED : 0 ) | ( snap.Jumped ? HISTFLAG_JUMPED : 0 );
+	f.Pad       = 0;
+}
+
+
+bool MoveHistoryStore::Get( int playerIndex, int tick, MoveSnapshot& out ) const
+{
+	if ( playerIndex < 0 || playerIndex >= Players || tick < 0 )
+	{
+		return false;
+	}
+
+	const Frame& f = Frames[ playerIndex * TickCount + ( tick & ( TickCount - 1 ) ) ];
+	if ( f.Tick != tick )
+	{
+		return false;  // never recorded, or overwritten by a newer tick since
+	}
+
+	out.Tick     = f.Tick;
+	out.Position = UnpackPosition( f.Pos );
+	for ( int i=0; i < 3; ++i )
+	{
+		out.Velocity[i] = f.Vel[i] * HISTORY_VEL_STEP;
+		out.NetForce[i] = f.Force[i].GetFloat() * ( 1.0f / HISTORY_FORCE_SCALE );
+	}
+	out.GroundNormal = UnpackNormal( f.Normal );
+	out.GroundEnt    = f.GroundEnt;
+	out.Grounded     = ( f.Flags & HISTFLAG_GROUNDED ) != 0;
+	out.Jumped       = ( f.Flags & HISTFLAG_JUMPED ) != 0;
+	return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "mathlib/vector.h"
+#include "mathlib/compressed_vector.h"  // float16
+#include "ml_defs.h"
+
+namespace motionlab {
+
+// Quantization steps - anything reading history back should treat values as +-half a step
+constexpr float HISTORY_POS_STEP = 1.0f / 32.0f;  // 21 bits per axis, covers +-32768 units
+constexpr float HISTORY_VEL_STEP = 1.0f / 8.0f;   // int16 per axis, covers +-4096 u/s
+constexpr float HISTORY_FORCE_SCALE = 1.0f / 64.0f;  // float16 tops out at 65504, forces don't
+                                                     // (airborne gravity alone is 80000) - scaled
+                                                     // it covers +-4M with the same ~3 digits
+// Ground normal is octahedral int16 pairs (~1e-4)
+
+
+// One player, one tick, unpacked
+struct MoveSnapshot
+{
+	int    Tick;
+	Vector Position;
+	Vector Velocity;
+	Vector NetForce;
+	Vector GroundNormal;  // WORLD_UP while airborne
+	int    GroundEnt;     // entindex, -1 = none
+	bool   Grounded;
+	bool   Jumped;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Per-player ring of the last N ticks of movement state, 32 bytes a tick. Everything is allocated
+// up front by Reserve() - e.g. 128 players x 256 ticks (2s at 128 tick) is 1MB - and Record/Get
+// are O(1): a tick's slot is just tick & ( ticks - 1 ), with the tick stored alongside to catch
+// stale or skipped slots.
+// Same sharing rules as GroundContactStore: one slot range per player, so drivers on different
+// threads can share a store as long as no two of them move the same player at once.
+// -------------------------------------------------------------------------------------------------
+class MoveHistoryStore
+{
+	private:
+		struct Frame
+		{
+			uint64  Pos;          // 3 x 21-bit biased fixed point
+			int32   Tick;         // -1 = empty
+			int16   Vel[3];
+			float16 Force[3];     // x HISTORY_FORCE_SCALE
+			int16   Normal[2];    // octahedral
+			int16   GroundEnt;
+			uint8   Flags;
+			uint8   Pad;
+		};
+
+		CUtlVector<Frame> Frames;  // [ player * TickCount + slot ]
+		int               Players;
+		int               TickCount;  // power of 2
+
+	public:
+		MoveHistoryStore();
+
+		// Not thread safe, call before moving anyone. Rounds ticks up to a power of 2, clears
+		// everything if the size actually changes. 0 ticks turns recording off.
+		void  Reserve( int maxPlayerIndex, int ticks );
+		void  Clear();
+		int   Ticks() const;
+		int   MemoryUsed() const;
+
+		void  Record( int playerIndex, const MoveSnapshot& snap );
+		bool  Get( int playerIndex, int tick, MoveSnapshot& out ) const;  // false if not (or no longer) held
+};
+
+} // namespace motionlab
@@ -1,6 +1,6 @@
 #include "cbase.h"
-#include "movevars_shared.h"
 #include "in_buttons.h"
+#include "ml_moveconfig.h"
 #include "ml_inputreader.h"
 
 using namespace motionlab;
@@ -8,13 +8,14 @@ using namespace motionlab;
 
 InputReader::InputReader()
 {
-	Setup( NULL );
+	Setup( NULL, NULL );
 }
 
 
-void InputReader::Setup( CMoveData* moveData )
+void InputReader::Setup( CMoveData* moveData, const MovementConfig* config )
 {
-	mv = moveData;
+	mv     = moveData;
+	Config = config;
 }
 
 
@@ -22,11 +23,9 @@ float InputReader::ForwardVal() const
 {
 	const float fwdMove   = mv->m_flForwardMove;
 	const bool  isForward = (fwdMove >= 0.0f);
-	const float denom     = isForward ? cl_forwardspeed.GetFloat() : cl_backspeed.GetFloat();
-	if ( denom <= 0.0f )
-		return 0.0f;
+	const float invSpeed  = isForward ? Config->InvForwardSpeed : Config->InvBackSpeed;  // 0 if speed <= 0
 
-	float axis = fwdMove / denom;
+	float axis = fwdMove * invSpeed;
 	return clamp( axis, -1.0f, 1.0f );
 }
 
@@ -34,11 +33,8 @@ float InputReader::ForwardVal() const
 float InputReader::StrafeVal() const
 {
 	const float sideMove = mv->m_flSideMove;
-	const float denom    = cl_sidespeed.GetFloat();
-	if ( denom <= 0.0f )
-		return 0.0f;
 
-	float axis = sideMove / denom;
+	float axis = sideMove * Config->InvSideSpeed;
 	return clamp( axis, -1.0f, 1.0f );
 }
 
@@ -4,14 +4,17 @@ class CMoveData;
 
 namespace motionlab {
 
+struct MovementConfig;
+
 class InputReader
 {
 	private:
-		CMoveData* mv;
+		CMoveData*            mv;
+		const MovementConfig* Config;
 
 	public:
 		InputReader();
-		void  Setup( CMoveData* moveData );
+		void  Setup( CMoveData* moveData, const MovementConfig* config );
 		
 		float ForwardVal() const;
 		float StrafeVal() const;
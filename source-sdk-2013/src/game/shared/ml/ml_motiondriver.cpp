@@ -1,27 +1,214 @@
 #include "cbase.h"
-#include "movevars_shared.h" // GetCurrentGravity
 #include "coordsize.h"       // COORD_RESOLUTION, DIST_EPSILON
 #include "mathlib/mathlib.h"
 #include "ml_motiondriver.h"
+#include "ml_forcemath.h"
+#include "ml_clipsolver.h"
 
 #include "tier0/memdbgon.h"
 
-#ifndef CLIENT_DLL
+#if !defined( CLIENT_DLL ) && !defined( MOTIONLAB_HEADLESS )
 	#include "env_player_surface_trigger.h"
+	#include "filesystem.h"  // ml_prof_trace
 #endif
 
 using namespace motionlab;
 
 
-MotionDriver::MotionDriver()  = default;
+MotionDriver::MotionDriver()
+{
+	SetBackend( NULL );
+	SetGroundMemory( NULL );
+	SetHistory( NULL );
+	SetBuildProfiles( NULL );
+	Surfaces     = NULL;
+	GroundReuses = 0;
+	GroundProbes = 0;
+	NumSlideContacts = 0;
+	SlideStuck       = false;
+	Telemetry        = NULL;
+	MoveBumps        = 0;
+	MoveStepPath     = TELEM_STEP_NONE;
+	MoveEndGrounded  = false;
+	MoveEndGroundNormal   = WORLD_UP;
+	MoveEndGroundFriction = 1.0f;
+	#ifdef CLIENT_DLL
+		PredCapture        = NULL;
+		PredCaptureTouches = false;
+	#endif
+}
+
 MotionDriver::~MotionDriver() = default;
 
 
+void MotionDriver::SetBackend( MotionBackend* backend )
+{
+#ifndef MOTIONLAB_HEADLESS
+	backend = backend ? backend : &EngineBackend;
+#endif  // headless has nothing to fall back on, harness must provide one
+
+	if ( Recorder.IsRecording() )
+	{
+		Recorder.SetInner( backend );  // keep recording, just from the new backend
+	}
+	else
+	{
+		Backend = backend;
+	}
+}
+
+
+MotionBackend* MotionDriver::GetBackend() const
+{
+	return Backend;
+}
+
+
+void MotionDriver::SetOptions( const MotionOptions& options )
+{
+	Options = options;
+}
+
+
+const MotionOptions& MotionDriver::GetOptions() const
+{
+	return Options;
+}
+
+
+const TraceCache& MotionDriver::GetTraceCache() const
+{
+	return Traces;
+}
+
+
+const MovementConfig& MotionDriver::GetMovementConfig() const
+{
+	return MoveConfig.Get();
+}
+
+
+void MotionDriver::SetGroundMemory( GroundContactStore* store )
+{
+	GroundMemory = store ? store : &OwnGroundMemory;
+}
+
+
+GroundContactStore& MotionDriver::GetGroundMemory()
+{
+	return *GroundMemory;
+}
+
+
+void MotionDriver::SetHistory( MoveHistoryStore* store )
+{
+	History = store ? store : &OwnHistory;
+}
+
+
+MoveHistoryStore& MotionDriver::GetHistory()
+{
+	return *History;
+}
+
+
+void MotionDriver::SetBuildProfiles( BuildProfileStore* store )
+{
+	BuildProfiles = store ? store : &OwnBuildProfiles;
+}
+
+
+BuildProfileStore& MotionDriver::GetBuildProfiles()
+{
+	return *BuildProfiles;
+}
+
+
+int64 MotionDriver::GroundContactsReused() const
+{
+	return GroundReuses;
+}
+
+
+int64 MotionDriver::GroundProbesRun() const
+{
+	return GroundProbes;
+}
+
+
+bool MotionDriver::StartRecording( const char* path )
+{
+	StopRecording();
+	if ( !Recorder.Start( path, Backend ) )
+	{
+		return false;
+	}
+	Backend = &Recorder;
+
+	// Replay starts with no remembered contacts, so the recording has to as well - otherwise the
+	// first recorded tick reuses one, skips its trace, and replay desyncs right there
+	GroundMemory->Clear();
+	return true;
+}
+
+
+void MotionDriver::StopRecording()
+{
+	if ( Recorder.IsRecording() )
+	{
+		Backend = Recorder.GetInner();
+		Recorder.Stop();
+	}
+}
+
+
+const MoveRecorder& MotionDriver::GetRecorder() const
+{
+	return Recorder;
+}
+
+
+void MotionDriver::SetTelemetry( TelemetryRing* ring )
+{
+	Telemetry = ring;
+}
+
+
+void MotionDriver::GetPlayerNetState( PlayerNetState& out ) const
+{
+	CapturePlayerState( MLPlayer, out );
+}
+
+
+MoveCounters& MotionDriver::GetMoveCounters()
+{
+	return Counters;
+}
+
+
+#ifdef CLIENT_DLL
+PredictionCache& MotionDriver::GetPredictionCache()
+{
+	return PredCache;
+}
+#endif
+
+
+#ifdef MOTIONLAB_PROFILE
+TickProfiler& MotionDriver::GetProfiler()
+{
+	return Profiler;
+}
+#endif
+
+
 // ------------------------------------------------------------------------------------------------
 // NECESSARY ANCILLARY SOURCE OVERRIDES
 // ------------------------------------------------------------------------------------------------
 // This stuff is just necessary engine housekeeping which needed to be tweaked to avoid interfering
 // with our authority over movement. Should NOT be considered a part of our custom movement logic.
+// None of it exists in headless builds.
+#ifndef MOTIONLAB_HEADLESS
 
 
 // Identical to Source's CheckParameters except with movement clamping removed.
@@ -78,6 +265,7 @@ void MotionDriver::CheckParameters( void )
 	}
 }
 
+#endif // MOTIONLAB_HEADLESS
 
 // ------------------------------------------------------------------------------------------------
 // END ANCILLARY SOURCE OVERRIDES
@@ -87,10 +275,25 @@ void MotionDriver::CheckParameters( void )
 // Tick entry stuff
 void MotionDriver::TickSetup()
 {
-	FRAMETIME = gpGlobals->frametime;
-	PlayerInputs.Setup( mv );
+	#ifdef MOTIONLAB_HEADLESS
+		FRAMETIME = SimFrameTime;
+		MoveConfig.Refresh( -1 );  // no frame counter headless, the compare is cheap anyway
+	#else
+		FRAMETIME = gpGlobals->frametime;
+		MoveConfig.Refresh( gpGlobals->tickcount );
+		EngineBackend.Setup( mv );
+		Options = MoveConfig.Get().Options;
+		if ( History == &OwnHistory )
+		{
+			OwnHistory.Reserve( gpGlobals->maxClients, MoveConfig.Get().HistoryTicks );  // no-op unless it changed
+		}
+	#endif
+	Traces.Reset();
+	Surfaces = &Backend->Surfaces();
+	PlayerInputs.Setup( mv, &MoveConfig.Get() );
 	MLPlayer.Setup( mv,player );
-	FCalc.Setup( &PlayerInputs, &MLPlayer, FRAMETIME );
+	MLPlayer.Build = &BuildProfiles->ForPlayer( MLPlayer.Index() );
+	FCalc.Setup( &PlayerInputs, &MLPlayer, &MoveConfig.Get(), FRAMETIME );
 }
 
 
@@ -105,10 +308,14 @@ void MotionDriver::ResetPhysAccumulators()
 // Engine housekeeping. Not really part of our movement logic
 void MotionDriver::SpaghettiContainment()
 {
-	CheckParameters();
+	#ifndef MOTIONLAB_HEADLESS
+		CheckParameters();
+	#endif
 	ResetPhysAccumulators();
-	MoveHelper()->ResetTouchList();
-	ReduceTimers();
+	Backend->ResetTouchList();
+	#ifndef MOTIONLAB_HEADLESS
+		ReduceTimers();
+	#endif
 }
 
 
@@ -123,15 +330,18 @@ void MotionDriver::UpdateMovementAxes()
 
 
 // Wrapper for internal Source logic to determine if the player is able to move
+// (CheckStuck is engine-side unsticking - headless worlds are expected to spawn players clear)
 bool MotionDriver::PlayerIsStuck()
 {
-	if ( !player->pl.deadflag )
-	{
-		if ( CheckInterval( STUCK ) )
+	#ifndef MOTIONLAB_HEADLESS
+		if ( !player->pl.deadflag )
 		{
-			return CheckStuck(); // TODO: Does this interfere with movement authority?
+			if ( CheckInterval( STUCK ) )
+			{
+				return CheckStuck(); // TODO: Does this interfere with movement authority?
+			}
 		}
-	}
+	#endif
 	return false;
 }
 
@@ -143,24 +353,19 @@ bool MotionDriver::TraceHitEntity( const hulltrace& tr ) const
 
 
 // Useful when we need to pull phys properties from a trace's contact surface
-surfacedata* MotionDriver::GetTraceSurfaceData( const hulltrace& tr ) const
+const SurfaceEntry* MotionDriver::GetTraceSurface( const hulltrace& tr ) const
 {
-	IPhysicsSurfaceProps *physprops = MoveHelper()->GetSurfaceProps();
-	if ( physprops )
-	{
-		return physprops->GetSurfaceData( tr.surface.surfaceProps );
-	}
-	return NULL;
+	return Surfaces->Get( tr.surface.surfaceProps );
 }
 
 
 // On serverside, ff player standing surface material has changed, update it for any listening srf triggers
-#ifndef CLIENT_DLL
+#if !defined( CLIENT_DLL ) && !defined( MOTIONLAB_HEADLESS )
 void MotionDriver::UpdatePlayerGameMaterial( const hulltrace& groundTr )
 {
-	surfacedata *currentSrfData = GetTraceSurfaceData( groundTr );
-	char         currentGameMat = currentSrfData ? currentSrfData->game.material : 0;
-	char         prevGameMat    = MLPlayer.PreviousTextureType();
+	const SurfaceEntry* currentSrf     = GetTraceSurface( groundTr );
+	char                currentGameMat = currentSrf ? currentSrf->GameMaterial : 0;
+	char                prevGameMat    = MLPlayer.PreviousTextureType();
 
 	if ( MLPlayer.CurrentGroundEntity() == NULL )
 	{
@@ -199,14 +404,16 @@ void MotionDriver::HandleGroundTransitionVel( CBaseEntity* oldGround, CBaseEntit
 	if ( !oldGround && newGround )
 	{
 		// Subtract ground velocity at instant we hit ground
-		newBaseVel  -= newGround->GetAbsVelocity();
-		newBaseVel.z = newGround->GetAbsVelocity().z;
+		Vector groundVel = Backend->EntityVelocity( newGround );
+		newBaseVel  -= groundVel;
+		newBaseVel.z = groundVel.z;
 	}
 	else if ( oldGround && !newGround )
 	{
 		// Add in ground velocity at instant we started jumping
-		newBaseVel  += oldGround->GetAbsVelocity();
-		newBaseVel.z = oldGround->GetAbsVelocity().z;
+		Vector groundVel = Backend->EntityVelocity( oldGround );
+		newBaseVel  += groundVel;
+		newBaseVel.z = groundVel.z;
 	}
 
 	MLPlayer.UpdateBaseVelocity( newBaseVel );
@@ -218,8 +425,8 @@ float MotionDriver::GetTraceFriction( const hulltrace* tr ) const
     if ( !tr )
         return 1.0f;  // default friction
     
-    surfacedata* surfData = GetTraceSurfaceData( *tr );
-    return surfData ? surfData->physics.friction : 1.0f;
+    const SurfaceEntry* srf = GetTraceSurface( *tr );
+    return srf ? srf->Friction : 1.0f;
 }
 
 
@@ -247,7 +454,22 @@ void MotionDriver::UpdateGrounding( const hulltrace* groundTr )
 
 bool MotionDriver::RegisterTouch( const hulltrace& tr, const Vector& collisionVel )
 {
-	return MoveHelper()->AddToTouched( tr, collisionVel );
+	#ifdef CLIENT_DLL
+		if ( PredCapture && PredCaptureTouches )
+		{
+			if ( PredCapture->NumTouches < PREDCACHE_MAX_TOUCHES )
+			{
+				PredictedMove::Touch& touch = PredCapture->Touches[ PredCapture->NumTouches++ ];
+				touch.Trace = tr;
+				touch.Vel   = collisionVel;
+			}
+			else
+			{
+				PredCapture->Command = 0;  // can't replay this one faithfully, don't keep it
+			}
+		}
+	#endif
+	return Backend->AddToTouched( tr, collisionVel );
 }
 
 
@@ -263,14 +485,28 @@ void MotionDriver::SetGroundEntity( const hulltrace *groundTr )
 	HandleGroundTransitionVel( oldGround, newGround );
 	MLPlayer.UpdateGroundEntity( newGround );
 
+	#ifdef CLIENT_DLL
+		if ( PredCapture )
+		{
+			PredCapture->Categorized = true;
+			PredCapture->HasGround   = groundTr != NULL;
+			if ( groundTr )
+			{
+				PredCapture->GroundTr = *groundTr;
+			}
+		}
+	#endif
+
 	// If we are on something, categorize surface and record touch
 	if ( newGround && groundTr )
 	{
-		CategorizeGroundSurface( *groundTr );
-		player->m_flWaterJumpTime = 0;
+		#ifndef MOTIONLAB_HEADLESS
+			CategorizeGroundSurface( *groundTr );
+			player->m_flWaterJumpTime = 0;
+		#endif
 
 		// Signal that we touched an object if we're standing on a non-world entity
-		if ( !groundTr->DidHitWorld() ) 
+		if ( !Backend->TraceHitWorld( *groundTr ) ) 
 		{
 				RegisterTouch( *groundTr, MLPlayer.CurrentVelocity() );
 		}
@@ -280,32 +516,66 @@ void MotionDriver::SetGroundEntity( const hulltrace *groundTr )
 }
 
 
-// Does downward hull tracing to look for a standable entity under the player, updates related properties
-void MotionDriver::CategorizePosition( void )
+// Last tick's StayOnGround left us resting on standable world at exactly this spot, so a fresh
+// ground probe from here would just find the same plane again. One-shot - a contact only ever
+// gets used on the tick right after it was recorded.
+bool MotionDriver::RecallGroundContact( const Vector& pos, hulltrace& groundTr )
 {
+	GroundContact* contact = GroundMemory->ForPlayer( MLPlayer.Index() );
+	if ( !contact || !contact->Valid )
+	{
+		return false;
+	}
+	contact->Valid = false;
 
-	// Reset friction to default every time we recategorize (prevents bogus friction in certain edge cases)
-	MLPlayer.ResetFriction();
+	if ( contact->Position != pos || contact->HullMins != GetPlayerMins() || contact->HullMaxs != GetPlayerMaxs() )
+	{
+		return false;  // moved (teleport, duck, ...) since the contact was recorded
+	}
+	if ( !Backend->TraceHitWorld( contact->Trace ) )
+	{
+		return false;  // world got swapped out from under us (level change)
+	}
 
-	// observers don't have a ground entity
-	if ( MLPlayer.IsObserver() )
+	groundTr = contact->Trace;
+	++GroundReuses;
+	return true;
+}
+
+
+// Called by StayOnGround once it's settled the player on standable ground
+void MotionDriver::RememberGroundContact( const hulltrace& groundTr )
+{
+	GroundContact* contact = GroundMemory->ForPlayer( MLPlayer.Index() );
+	if ( !contact )
 	{
 		return;
 	}
 
-	// Initial simple short downward trace
-	Vector    currentPos = MLPlayer.CurrentPosition();
-	Vector 	  endPoint   = Vector( currentPos.x, currentPos.y, currentPos.z - VERT_PROBE_DIST );
-	hulltrace groundTr;
-	TryTouchGround( currentPos, endPoint, GetPlayerMins(), GetPlayerMaxs(), 
-					MASK_PLAYERSOLID, COLLISION_GROUP_PLAYER_MOVEMENT, groundTr );
+	contact->Valid = Options.GroundMemory && Backend->TraceHitWorld( groundTr );
+	if ( contact->Valid )
+	{
+		contact->Position = MLPlayer.CurrentPosition();
+		contact->HullMins = GetPlayerMins();
+		contact->HullMaxs = GetPlayerMaxs();
+		contact->Trace    = groundTr;
+	}
+}
+
+
+// Full ground probe - short hull trace down, quadrant fallback if that finds nothing standable
+void MotionDriver::ProbeGround( const Vector& pos, hulltrace& groundTr )
+{
+	++GroundProbes;
+
+	Vector endPoint = Vector( pos.x, pos.y, pos.z - VERT_PROBE_DIST );
+	TraceHull( pos, endPoint, GetPlayerMins(), GetPlayerMaxs(), TRACE_CATEGORIZE, groundTr );
 
 	// If ground trace fails to find something standable, retry with a quadrant trace fallback
 	if ( !TraceHitEntity( groundTr ) || !PlaneIsStandable( groundTr.plane ) )
 	{
 		// Test four sub-boxes, to see if any of them would have found shallower slope we could actually stand on
-		TryTouchGroundInQuadrants( currentPos, endPoint, 
-								   MASK_PLAYERSOLID, COLLISION_GROUP_PLAYER_MOVEMENT, groundTr );
+		TouchGroundInQuadrants( pos, endPoint, groundTr );
 
 		// Fallback still finds nothing standable, defintely not on ground
 		if ( !TraceHitEntity( groundTr ) || !PlaneIsStandable( groundTr.plane ) )
@@ -321,9 +591,36 @@ void MotionDriver::CategorizePosition( void )
 	{
 		SetGroundEntity( &groundTr );
 	}
+}
+
+
+// Does downward hull tracing to look for a standable entity under the player, updates related properties
+void MotionDriver::CategorizePosition( void )
+{
+
+	// Reset friction to default every time we recategorize (prevents bogus friction in certain edge cases)
+	MLPlayer.ResetFriction();
+
+	// observers don't have a ground entity
+	if ( MLPlayer.IsObserver() )
+	{
+		return;
+	}
+
+	// Still standing where last tick's move left us? Then we already know what's underfoot.
+	Vector    currentPos = MLPlayer.CurrentPosition();
+	hulltrace groundTr;
+	if ( Options.GroundMemory && RecallGroundContact( currentPos, groundTr ) )
+	{
+		SetGroundEntity( &groundTr );
+	}
+	else
+	{
+		ProbeGround( currentPos, groundTr );
+	}
 
 	// On server side, need to update player's surface material for phys listeners if changed
-	#ifndef CLIENT_DLL
+	#if !defined( CLIENT_DLL ) && !defined( MOTIONLAB_HEADLESS )
 		UpdatePlayerGameMaterial( groundTr );
 	#endif
 }
@@ -333,7 +630,9 @@ void MotionDriver::CategorizePosition( void )
 void MotionDriver::MoreSpaghettiContainment()
 {
 	MLPlayer.RecordFallVelocity();
-	m_nOnLadder = 0;
+	#ifndef MOTIONLAB_HEADLESS
+		m_nOnLadder = 0;
+	#endif
 	MLPlayer.UpdateStepSound();
 }
 
@@ -341,13 +640,13 @@ void MotionDriver::MoreSpaghettiContainment()
 // Record keeping to sync serverside physics shadow with player once we've done movement calcs
 void MotionDriver::SyncVPhys()
 {
-	if ( FCalc.PlayerJumped )
+	if ( FCalc.Forces.Jumped )
 	{
-		mv->m_outJumpVel.z  += MLPlayer.JumpImpulseVel( FRAMETIME );
+		mv->m_outJumpVel.z  += MLPlayer.JumpImpulseVel( Options.ClosedFormIntegration ? JUMP_TICK : FRAMETIME );
 		mv->m_outStepHeight += 0.15f;
 	}
-	Vector wishForce   = FCalc.CurrentWASDForce + FCalc.CurrentFrictionForce; wishForce.z = 0.0f;
-	Vector wishAccel   = wishForce / MLPlayer.Mass;
+	Vector wishForce   = FCalc.Forces.WASD + FCalc.Forces.Friction; wishForce.z = 0.0f;
+	Vector wishAccel   = wishForce * MLPlayer.Build->InvMass;
 	Vector wishDelta   = wishAccel * FRAMETIME;
 	mv->m_outWishVel  += wishDelta;
 	mv->m_outWishVel.z = 0.0f;
@@ -355,71 +654,158 @@ void MotionDriver::SyncVPhys()
 
 
 // F = ma -> a = F/m -> dv = a*dt
+// In closed-form mode this only does the first half of the tick, and FinishAccelerate does the rest
+// once Move has run - so Move slides on the mid-tick velocity (leapfrog, same idea as Source's
+// StartGravity/FinishGravity) and positions stop depending on tick rate along with velocities.
 void MotionDriver::Accelerate()
 {
-	Vector acceleration = FCalc.CurrentNetForce / MLPlayer.Mass;
-	Vector deltaVel     = acceleration * FRAMETIME;
-	Vector newVel       = MLPlayer.CurrentVelocity() + deltaVel;
-	if ( newVel.Length() < MIN_VEL )
+	if ( Options.ClosedFormIntegration )
 	{
-		newVel.Zero();  // do not do Zeno paradox
+		// Jump is a fixed impulse here rather than a force held for however long this tick is
+		Vector vel = MLPlayer.CurrentVelocity() + FCalc.Forces.Jump * ( JUMP_TICK * MLPlayer.Build->InvMass );
+		MLPlayer.UpdateVelocity( ClosedFormHalfTick( vel, FCalc.Forces.FrictionDecel, MLPlayer.CurrentGroundNormal ) );
+		return;
 	}
-	MLPlayer.UpdateVelocity( newVel );	
+	MLPlayer.UpdateVelocity( IntegrateVelocity( MLPlayer.CurrentVelocity(), FCalc.Forces.Net, MLPlayer.Build->InvMass, FRAMETIME ) );
 }
 
 
-// For movement ops, trace solidmask & collisiongroup args are always the same - less boilerplate = more good
-void MotionDriver::TracePlayerMovementBBox( const Vector& startPos, const Vector& targetPos, hulltrace& outTr ) const
+// Second half reuses this tick's drive forces and drag, but friction comes from wherever Move left
+// the ground - none if it walked us off a ledge, the new slope if it put us on one. (Only where
+// this tick's model applied friction in the first place.)
+void MotionDriver::FinishAccelerate()
+{
+	if ( !Options.ClosedFormIntegration )
+	{
+		return;
+	}
+	float decel = 0.0f;
+	if ( MoveEndGrounded && FCalc.Forces.FrictionDecel > 0.0f )
+	{
+		decel = FrictionDecel( true, MoveEndGroundNormal, MoveEndGroundFriction, MoveConfig.Get().Gravity );
+	}
+	Vector vel = ClosedFormHalfTick( MLPlayer.CurrentVelocity(), decel, MoveEndGroundNormal );
+	if ( vel.Length() < MIN_VEL )
+	{
+		vel.Zero();
+	}
+	MLPlayer.UpdateVelocity( vel );
+}
+
+
+// Drive and drag as the player's force model applied them this tick, friction as given
+Vector MotionDriver::ClosedFormHalfTick( const Vector& vel, float frictionDecel, const Vector& groundNormal ) const
 {
-	TracePlayerBBox( startPos, targetPos, PlayerSolidMask(), COLLISION_GROUP_PLAYER_MOVEMENT, outTr );
+	return ClosedFormStep( vel, FCalc.Forces.WASD + FCalc.Forces.Grav, MLPlayer.Build->InvMass, FCalc.Forces.DragPerMass,
+	                       frictionDecel, groundNormal, 0.5f * FRAMETIME );
 }
 
 
-// Handles a known float precision bug where a trace can 'successfully' complete but still be stuck in terrain
-bool MotionDriver::CheckTraceStuck( const hulltrace& tr ) const
+// Every hull trace in the pipeline funnels through here. Repeats of a query within the same tick
+// (e.g. Step re-probing spots Slide already traced) come straight out of the trace cache.
+void MotionDriver::CachedTrace( const Vector& startPos, const Vector& targetPos, const Vector& mins, const Vector& maxs,
+                                unsigned int mask, TraceCaller caller, hulltrace& outTr ) const
 {
-	hulltrace struckTr;
-	TracePlayerMovementBBox( tr.endpos, tr.endpos, struckTr );
-	return ( struckTr.startsolid || struckTr.fraction != 1.0f );
+	++Counters.TracesRequested[ caller ];
+	if ( Options.TraceCache && Traces.Lookup( startPos, targetPos, mins, maxs, mask, outTr ) )
+	{
+		return;
+	}
+
+	++Counters.TracesIssued[ caller ];
+	Backend->TraceHull( startPos, targetPos, mins, maxs, mask, COLLISION_GROUP_PLAYER_MOVEMENT, outTr );
+
+	if ( Options.TraceCache )
+	{
+		Traces.Store( startPos, targetPos, mins, maxs, mask, outTr );
+	}
 }
 
 
-// Just some gating checks for common things that make a slide trace unusable
-bool MotionDriver::CheckSlideTraceInvalid( const hulltrace& slideTr ) const
+// Ground probes always use MASK_PLAYERSOLID, like Source's TryTouchGround
+void MotionDriver::TraceHull( const Vector& startPos, const Vector& targetPos, const Vector& mins, const Vector& maxs,
+                              TraceCaller caller, hulltrace& outTr ) const
 {
-	return ( slideTr.allsolid || ( slideTr.fraction == 1.0f && CheckTraceStuck( slideTr ) ) );
+	CachedTrace( startPos, targetPos, mins, maxs, MASK_PLAYERSOLID, caller, outTr );
 }
 
 
-// Deflect velocity along plane indicated by normal
-Vector MotionDriver::DeflectVelocity( const Vector& currentVel, const Vector& normal, float overbounce ) const
+// For movement ops, trace solidmask & collisiongroup args are always the same - less boilerplate = more good
+void MotionDriver::TracePlayerMovementBBox( const Vector& startPos, const Vector& targetPos, TraceCaller caller,
+                                            hulltrace& outTr ) const
 {
-	// Determine how far along plane to deflect based on incoming direction
-	float  intoSurface = DotProduct( currentVel, normal );
-	float  backoff     = intoSurface * overbounce;
-	Vector deflectedV  = currentVel - ( normal * backoff );
+	CachedTrace( startPos, targetPos, GetPlayerMins(), GetPlayerMaxs(), PlayerSolidMask(), caller, outTr );
+}
+
 
-	// Guard against float noise causing residual velocity into plane
-	float adjust = DotProduct( deflectedV, normal );
-	if ( adjust < 0.0f )
+// Same as Source's TryTouchGroundInQuadrants, but routed through our backend. Retraces with each
+// quarter of the hull and keeps the first standable hit. Fraction/endpos stay those of the
+// original full-hull trace, as in Source.
+void MotionDriver::TouchGroundInQuadrants( const Vector& startPos, const Vector& targetPos, hulltrace& groundTr ) const
+{
+	const Vector& minsSrc  = GetPlayerMins();
+	const Vector& maxsSrc  = GetPlayerMaxs();
+	float         fraction = groundTr.fraction;
+	Vector        endPos   = groundTr.endpos;
+
+	Vector quadMins[ 4 ] = {
+		minsSrc,                                                             // -x -y
+		Vector( MAX( 0.0f, minsSrc.x ), MAX( 0.0f, minsSrc.y ), minsSrc.z ),  // +x +y
+		Vector( minsSrc.x, MAX( 0.0f, minsSrc.y ), minsSrc.z ),              // -x +y
+		Vector( MAX( 0.0f, minsSrc.x ), minsSrc.y, minsSrc.z )               // +x -y
+	};
+	Vector quadMaxs[ 4 ] = {
+		Vector( MIN( 0.0f, maxsSrc.x ), MIN( 0.0f, maxsSrc.y ), maxsSrc.z ),
+		maxsSrc,
+		Vector( MIN( 0.0f, maxsSrc.x ), maxsSrc.y, maxsSrc.z ),
+		Vector( maxsSrc.x, MIN( 0.0f, maxsSrc.y ), maxsSrc.z )
+	};
+
+	for ( int i=0; i < 4; ++i )
 	{
-		deflectedV -= ( normal * adjust );
+		TraceHull( startPos, targetPos, quadMins[i], quadMaxs[i], TRACE_QUADRANT, groundTr );
+		if ( TraceHitEntity( groundTr ) && PlaneIsStandable( groundTr.plane ) )
+		{
+			break;
+		}
 	}
 
-	return deflectedV;
+	groundTr.fraction = fraction;
+	groundTr.endpos   = endPos;
+}
+
+
+// Handles a known float precision bug where a trace can 'successfully' complete but still be stuck in terrain
+bool MotionDriver::CheckTraceStuck( const hulltrace& tr ) const
+{
+	hulltrace struckTr;
+	TracePlayerMovementBBox( tr.endpos, tr.endpos, TRACE_STUCKCHECK, struckTr );
+	return ( struckTr.startsolid || struckTr.fraction != 1.0f );
+}
+
+
+// Just some gating checks for common things that make a slide trace unusable
+bool MotionDriver::CheckSlideTraceInvalid( const hulltrace& slideTr ) const
+{
+	return ( slideTr.allsolid || ( slideTr.fraction == 1.0f && CheckTraceStuck( slideTr ) ) );
 }
 
 
 // Simple p₀+vt slide, returns true if slide completes cleanly (no collisions), else false
 bool MotionDriver::Slide()
 {
-	// Accumulate collision plane normals to constrain velocity redirections
-	CUtlVectorFixed<Vector, MAX_CLIPS> planeNormals;
+	// Accumulate collision plane normals to constrain velocity redirections (ml_clipsolver.h). Vec4
+	// throughout - plain stack array since CUtlVectorFixed won't keep them aligned.
+	Vec4   planeNormals[ MAX_CLIPS ];
+	int    numPlanes        = 0;
 	float  totalFraction    = 0.0f;
 	float  timeLeft         = FRAMETIME;
 	bool   cleanSlide       = true;
-	Vector originalStartVel = MLPlayer.CurrentVelocity();
-	Vector segmentStartVel  = MLPlayer.CurrentVelocity();
+	Vec4   originalStartVel = Vec4Load( MLPlayer.CurrentVelocity() );
+	Vec4   segmentStartVel  = originalStartVel;
+	int    bumpsUsed        = 0;
+	NumSlideContacts        = 0;
+	SlideStuck              = false;
 	
 	for ( int bumpCount=0; bumpCount < MAX_BUMPS; bumpCount++ )
 	{
@@ -431,14 +817,16 @@ bool MotionDriver::Slide()
 		hulltrace slideTr;
 		Vector    endPos; 
 		VectorMA( MLPlayer.CurrentPosition(), timeLeft, MLPlayer.CurrentVelocity(), endPos );
-		TracePlayerMovementBBox( MLPlayer.CurrentPosition(), endPos, slideTr );
+		TracePlayerMovementBBox( MLPlayer.CurrentPosition(), endPos, TRACE_SLIDE, slideTr );
 		totalFraction += slideTr.fraction;
+		++bumpsUsed;
 
 		// First make sure we can actually use this trace for a slide
 		if ( CheckSlideTraceInvalid( slideTr ) )
 		{
 			MLPlayer.ZeroVelocity();  // :(
 			cleanSlide = false;
+			SlideStuck = true;
 			break;
 		}
 		
@@ -451,8 +839,8 @@ bool MotionDriver::Slide()
 				break;
 			}
 			// Only made it part way, get ready to handle collisions
-			planeNormals.RemoveAll();
-			segmentStartVel = MLPlayer.CurrentVelocity();
+			numPlanes       = 0;
+			segmentStartVel = Vec4Load( MLPlayer.CurrentVelocity() );
 		}
 		
 		// Didn't break above, must have bumped into something - record touch and handle collision
@@ -460,68 +848,45 @@ bool MotionDriver::Slide()
 		float timeTravelled = timeLeft * slideTr.fraction;  // Amount of timestep consumed before collision
 		timeLeft           -= timeTravelled;
 		cleanSlide          = false;
-		Vector bumpNormal   = slideTr.plane.normal;
+		Vec4  bumpNormal    = Vec4Load( slideTr.plane.normal );
+
+		SlideContact& contact = SlideContacts[ NumSlideContacts++ ];  // one per bump, can't overflow
+		contact.Normal = slideTr.plane.normal;
+		contact.Dist   = slideTr.plane.dist;
+		contact.Pos    = MLPlayer.CurrentPosition();
 
 		// Hit too many planes - we're stuck, zero vel & return false - this shouldn't really happen but whatev
-		if ( planeNormals.Count() >= MAX_CLIPS )
+		if ( numPlanes >= MAX_CLIPS )
 		{
 			MLPlayer.ZeroVelocity();
+			SlideStuck = true;
 			break;
 		}
 
 		// Add plane to contact list, look for unobstructed deflection path off current planes
-		planeNormals.AddToTail( bumpNormal );
-		Vector newVel    = Vector( 0.0f, 0.0f, 0.0f );
-		bool   pathFound = false;
-		for ( int i=0; i < planeNormals.Count(); ++i )
+		planeNormals[ numPlanes++ ] = bumpNormal;
+		Vec4        newVel;
+		ClipOutcome outcome;
+		ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE_CLIPVELOCITY, outcome = SolveClipVelocity( segmentStartVel, planeNormals, numPlanes, newVel ) );
+		if ( outcome == CLIP_CREASE )
 		{
-			Vector candidateVel = DeflectVelocity( segmentStartVel, planeNormals[i], OVERCLIP );
-			bool   clearDeflect = true;
-			
-			for ( int j=0; j < planeNormals.Count(); ++j )
-			{
-				if ( j==i )
-				{
-					continue;
-				}
-				if ( DotProduct( candidateVel, planeNormals[j] ) < 0.0f )  // Got deflected into secondary plane
-				{
-					clearDeflect = false;
-					break;
-				}
-			}
-
-			if ( clearDeflect )  // No secondary plane encountered, this deflection works
-			{
-				newVel    = candidateVel;
-				pathFound = true;
-				break;
-			}
+			++Counters.Creases;
 		}
-
-		if ( !pathFound )  // We got deflected into something
+		else if ( outcome == CLIP_CORNER )  // Boxed in by 3+ planes with no clear edge, zero vel and be sad
 		{
-			if ( planeNormals.Count() == 2 )  // "Something" = "crease between two planes"
-			{
-				Vector creaseDir = CrossProduct( planeNormals[0], planeNormals[1] );
-				VectorNormalize( creaseDir );
-				newVel = creaseDir * DotProduct( creaseDir, segmentStartVel );  // Deflect vel along crease 
-			}
-			else  // We're hitting > 2 planes, prob stuck in a corner, zero vel and be sad
-			{
-				MLPlayer.ZeroVelocity();
-				break;
-			}
+			++Counters.Corners;
+			MLPlayer.ZeroVelocity();
+			break;
 		}
 		
 		// Guard against velocity reversal from deflections to prevent oscillations in corners
-		if ( DotProduct( newVel, originalStartVel ) <= 0.0f )
+		if ( Vec4Dot( newVel, originalStartVel ) <= 0.0f )
 		{
 			MLPlayer.ZeroVelocity();
 			break;
 		}
 		
-		MLPlayer.UpdateVelocity( newVel );  // Apply deflected velocity and continue
+		MLPlayer.UpdateVelocity( Vec4Store( newVel ) );  // Apply deflected velocity and continue
 	}
 
 	// No progress across all bumps => no movement => sad
@@ -530,15 +895,18 @@ bool MotionDriver::Slide()
 		MLPlayer.ZeroVelocity();
 	}
 
+	++Counters.SlideBumps[ bumpsUsed ];
+	MoveBumps += bumpsUsed;
+
 	return cleanSlide;
 }
 
 
 // For straight up/down traces frequently needed for stepping/probing ops
-void MotionDriver::TraceStep( const Vector& start, float signedDist, hulltrace& tr )
+void MotionDriver::TraceStep( const Vector& start, float signedDist, TraceCaller caller, hulltrace& tr )
 {
 	Vector end = Vector( start.x, start.y, start.z + signedDist );
-	TracePlayerMovementBBox( start, end, tr );
+	TracePlayerMovementBBox( start, end, caller, tr );
 }
 
 
@@ -548,12 +916,12 @@ void MotionDriver::StayOnGround( void )
 	// Trace up to find safe starting position (mitigates ground clipping and float noise)
 	Vector    currentPos = MLPlayer.CurrentPosition();
 	hulltrace upTr;
-	TraceStep( currentPos, VERT_PROBE_DIST, upTr );
+	TraceStep( currentPos, VERT_PROBE_DIST, TRACE_STAYONGROUND, upTr );
 	Vector    safeStart  = upTr.endpos;
 	
 	// Trace down one step to find ground
 	hulltrace dnTr;
-	TraceStep( safeStart, -MLPlayer.StepHeight(), dnTr );
+	TraceStep( safeStart, -MLPlayer.StepHeight(), TRACE_STAYONGROUND, dnTr );
 	
 	// If downward trace found a standable surface, snap to it
 	if ( 0.0f < dnTr.fraction && dnTr.fraction < 1.0f && !dnTr.startsolid && PlaneIsStandable( dnTr.plane ) )
@@ -561,7 +929,13 @@ void MotionDriver::StayOnGround( void )
 		if ( fabs( currentPos.z - dnTr.endpos.z ) > 0.5f * COORD_RESOLUTION )
 		{
 			MLPlayer.UpdatePosition( dnTr.endpos );
+			++Counters.GroundSnaps;
 		}
+		RememberGroundContact( dnTr );  // next tick's CategorizePosition can skip its probe
+
+		MoveEndGrounded       = true;
+		MoveEndGroundNormal   = dnTr.plane.normal;
+		MoveEndGroundFriction = GetTraceFriction( &dnTr );
 	}
 }
 
@@ -587,7 +961,7 @@ void MotionDriver::Step( const Vector& preSlidePos, const Vector& preSlideVel )
 	// Now try stepping up to get around whatever the unstepped slide bumped into
 	hulltrace stepUpTr;
 	float     stepSize = MLPlayer.StepHeight() + STEP_EPS;
-	TraceStep( preSlidePos, stepSize, stepUpTr );
+	TraceStep( preSlidePos, stepSize, TRACE_STEP, stepUpTr );
 
 	// If step-up succeeded, move to stepped position
 	if ( !stepUpTr.startsolid && !stepUpTr.allsolid )
@@ -596,16 +970,18 @@ void MotionDriver::Step( const Vector& preSlidePos, const Vector& preSlideVel )
 	}
 
 	// Slide over obstacle from current position
-	Slide();
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE_SLIDE, Slide() );
 	
 	// Trace downward to return to ground level
 	hulltrace stepDownTr;
-	TraceStep( MLPlayer.CurrentPosition(), -stepSize, stepDownTr );
+	TraceStep( MLPlayer.CurrentPosition(), -stepSize, TRACE_STEP, stepDownTr );
 	
 	// Check if step-down landed on non-standable ground
 	if ( stepDownTr.fraction < 1.0f && !PlaneIsStandable( stepDownTr.plane ) )
 	{
 		// Landed on steep surface - reject stepped path, use straight slide
+		++Counters.StepsSteep;
+		MoveStepPath = TELEM_STEP_STEEP;
 		MLPlayer.UpdatePosition( straightSlideEndPos );
 		MLPlayer.UpdateVelocity( straightSlideEndVel );
 		
@@ -630,11 +1006,15 @@ void MotionDriver::Step( const Vector& preSlidePos, const Vector& preSlideVel )
 	
 	if ( straightSlideDist > steppedSlideDist )  // original unstepped slide got us further
 	{
+		++Counters.StepsStraight;
+		MoveStepPath = TELEM_STEP_STRAIGHT;
 		MLPlayer.UpdatePosition( straightSlideEndPos );
 		MLPlayer.UpdateVelocity( straightSlideEndVel );
 	}
 	else  // stepped slide got further 
 	{
+		++Counters.StepsTaken;
+		MoveStepPath = TELEM_STEP_TAKEN;
 		Vector finalVel = steppedSlideEndVel;
 		finalVel.z = straightSlideEndVel.z;  // guard against stepping causing phantom z vel
 		MLPlayer.UpdateVelocity( finalVel );
@@ -649,52 +1029,684 @@ void MotionDriver::Step( const Vector& preSlidePos, const Vector& preSlideVel )
 }
 
 
+// Is this steep contact still there one step up? Re-trace the hull from the contact raised by a step
+// and push it a little further into the plane - if it hits that same plane again, stepping up
+// can't get over it. Last verdict is only taken on trust from exactly the same spot against the
+// same plane - anywhere else along the wall could have a gap or a ledge the old probe never saw.
+// Anything we can't read cleanly (blocked overhead, some other plane up there) says no, so Step
+// gets its usual go.
+bool MotionDriver::WallTooTallToStep( const SlideContact& contact )
+{
+	GroundContact* memory   = GroundMemory->ForPlayer( MLPlayer.Index() );
+	float          stepSize = MLPlayer.StepHeight() + STEP_EPS;
+	if ( memory && memory->WallValid
+	     && memory->WallPos == contact.Pos
+	     && memory->WallStep == stepSize
+	     && memory->WallMins == GetPlayerMins() && memory->WallMaxs == GetPlayerMaxs()
+	     && memory->WallTrace.plane.normal == contact.Normal && memory->WallTrace.plane.dist == contact.Dist
+	     && Backend->TraceHitWorld( memory->WallTrace ) )
+	{
+		++Counters.WallReuses;
+		return true;
+	}
+
+	Vector into( -contact.Normal.x, -contact.Normal.y, 0.0f );
+	float  horiz = VectorNormalize( into );
+	if ( horiz <= 0.0f )
+	{
+		return false;
+	}
+
+	// Raising the hull backs it off a plane that leans away, so reach that much further in
+	float     probeDist = STEP_PROBE_DIST + stepSize * MAX( contact.Normal.z, 0.0f ) / horiz;
+	Vector    start     = contact.Pos + Vector( 0.0f, 0.0f, stepSize );
+	hulltrace probeTr;
+	TracePlayerMovementBBox( start, start + into * probeDist, TRACE_STEPPROBE, probeTr );
+
+	if ( probeTr.startsolid || probeTr.fraction == 1.0f )
+	{
+		return false;  // boxed in up there, or the top is within a step
+	}
+	if ( DotProduct( probeTr.plane.normal, contact.Normal ) <= 0.999f || fabs( probeTr.plane.dist - contact.Dist ) >= DIST_EPSILON )
+	{
+		return false;  // hit something else, not sure what we're looking at
+	}
+
+	if ( memory )
+	{
+		memory->WallValid = Backend->TraceHitWorld( probeTr );
+		memory->WallPos   = contact.Pos;
+		memory->WallStep  = stepSize;
+		memory->WallMins  = GetPlayerMins();
+		memory->WallMaxs  = GetPlayerMaxs();
+		memory->WallTrace = probeTr;
+	}
+	return true;
+}
+
+
+// Classify what the last Slide() ran into. Standable planes were already slid up and ceilings
+// only get closer one step up, so the one thing a step can get us over is a steep plane whose top
+// is within StepHeight of our feet. Returns true unless every contact rules that out.
+bool MotionDriver::StepCouldHelp()
+{
+	if ( SlideStuck )
+	{
+		return true;
+	}
+	for ( int i=0; i < NumSlideContacts; ++i )
+	{
+		const SlideContact& contact = SlideContacts[i];
+		if ( contact.Normal.z >= GROUND_MIN_DOT || contact.Normal.z < 0.0f )
+		{
+			continue;
+		}
+		if ( !WallTooTallToStep( contact ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// The box every trace in Move() can reach. Clipping only ever takes speed off, so the slides stay
+// within speed*dt of the start. Step adds a step up and down on top, its wall probe a step up and
+// a step-ish in, StayOnGround a probe up and a step down.
+// Move() hands it to the backend so it can pull the geometry in there into a local set once instead
+// of walking the whole world per trace. Traces that still poke out fall back to the full world.
+void MotionDriver::MoveBounds( Vector& mins, Vector& maxs ) const
+{
+	Vector pos   = MLPlayer.CurrentPosition();
+	float  reach = MLPlayer.CurrentVelocity().Length() * FRAMETIME
+	             + 2.0f * ( MLPlayer.StepHeight() + STEP_EPS ) + VERT_PROBE_DIST;
+	Vector pad( reach, reach, reach );
+
+	mins = pos + GetPlayerMins() - pad;
+	maxs = pos + GetPlayerMaxs() + pad;
+}
+
+
 void MotionDriver::Move()
 {
 	Vector startPos = MLPlayer.CurrentPosition();
 	Vector startVel = MLPlayer.CurrentVelocity();
+	Vector boundsMins, boundsMaxs;
+	MoveBounds( boundsMins, boundsMaxs );
+	bool   local    = Options.LocalSnapshot && Backend->BeginLocalQueries( boundsMins, boundsMaxs );
+	MoveBumps           = 0;
+	MoveStepPath        = TELEM_STEP_NONE;
+	MoveEndGrounded     = false;
+	MoveEndGroundNormal = WORLD_UP;
+
+	#ifdef CLIENT_DLL
+		if ( PredCapture )
+		{
+			PredCapture->BoxMins = boundsMins;  // also covers CategorizePosition's probe from the same spot
+			PredCapture->BoxMaxs = boundsMaxs;
+		}
+	#endif
 
-	if ( Slide() )
+	bool clean;
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE_SLIDE, clean = Slide() );
+	if ( !clean )
 	{
-		if ( MLPlayer.IsGrounded )
+		if ( !Options.PredictiveStep || StepCouldHelp() )
 		{
-			StayOnGround();
+			ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE_STEP, Step( startPos, startVel ) );
+		}
+		else
+		{
+			++Counters.StepsSkipped;
+			MoveStepPath = TELEM_STEP_SKIPPED;
+			float slideZ = MLPlayer.CurrentPosition().z - startPos.z;
+			if ( slideZ > 0.0f )
+			{
+				VPhysStep( slideZ );  // same as Step's straight-slide outcome
+			}
 		}
-		return;
 	}
-
-	Step( startPos, startVel );
 	if ( MLPlayer.IsGrounded )
 	{
-		StayOnGround();
+		ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE_STAYONGROUND, StayOnGround() );
+	}
+
+	if ( local )
+	{
+		Backend->EndLocalQueries();
 	}
 }
 
 
 // Per-tick entry point Source override. This is where we divert from Source's pipeline into ours.
+// (Stage timers are only there in MOTIONLAB_PROFILE builds, see ml_profiler.h)
 void MotionDriver::PlayerMove()
 {
+	ML_PROFILE_PLAYER( Profiler, player->entindex() );
+	ML_PROFILE_SCOPE( Profiler, MLSTAGE_TICK );
+	++Counters.Ticks;
+
 	// Initial tick housekeeping
-	TickSetup();                 // Initialize interfaces and reset force calculator state
-	SpaghettiContainment();      // Engine stuff, not our business
-	UpdateMovementAxes();        // Set force application axes from player view dir
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_TICKSETUP,     TickSetup() );                 // Initialize interfaces and reset force calculator state
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_SPAGHETTI,     SpaghettiContainment() );      // Engine stuff, not our business
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVEMENTAXES,  UpdateMovementAxes() );        // Set force application axes from player view dir
 	if ( PlayerIsStuck() )
 	{
 		return;
 	}
-	CategorizePosition();        // Update grounding status, friction/material values etc
-	MoreSpaghettiContainment();  // More engine housekeeping, nothing to do with us
+	if ( Recorder.IsRecording() )  // start state is whatever the stuck check left us with
+	{
+		Recorder.BeginTick( player, mv, FRAMETIME, Options, *MLPlayer.Build, MoveConfig.Get(), GetPlayerMins(), GetPlayerMaxs() );
+	}
+	#ifdef CLIENT_DLL
+		// Prediction replaying a command we've already run from this exact state? (never while recording,
+		// the recording wants every trace)
+		if ( MoveConfig.Get().PredictionCache && !Recorder.IsRecording() && player->IsLocalPlayer() )
+		{
+			PredictionKey predKey;
+			MakePredictionKey( predKey );
+			if ( ReplayPredictedMove( player->CurrentCommandNumber(), predKey ) )
+			{
+				RecordHistory();
+				PublishTelemetry();
+				return;
+			}
+			BeginPredictedMove( player->CurrentCommandNumber(), predKey );
+		}
+	#endif
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_CATEGORIZE,    CategorizePosition() );        // Update grounding status, friction/material values etc
+	#ifdef CLIENT_DLL
+		PredCaptureTouches = true;
+	#endif
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_MORESPAGHETTI, MoreSpaghettiContainment() );  // More engine housekeeping, nothing to do with us
 	
 	// Actual movement stuff
-	FCalc.CalcCurrentForces();   // Calculate & store all force vectors acting on the player
-	SyncVPhys();                 // Yet more housekeeping for downstream engine ops
-	Accelerate();                // Modify player velocity according to current forces
-	Move();                      // Modify player position according to current velocity
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_FORCES,        FCalc.CalcCurrentForces() );   // Calculate & store all force vectors acting on the player
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_SYNCVPHYS,     SyncVPhys() );                 // Yet more housekeeping for downstream engine ops
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_ACCELERATE,    Accelerate() );                // Modify player velocity according to current forces
+	ML_PROFILE_STAGE( Profiler, MLSTAGE_MOVE,          Move() );                      // Modify player position according to current velocity
+	FinishAccelerate();                                                               // Second half of a closed-form tick, no-op otherwise
+
+	RecordHistory();
+	PublishTelemetry();
+
+	if ( Recorder.IsRecording() )
+	{
+		Recorder.EndTick( player, mv );
+	}
+	#ifdef CLIENT_DLL
+		FinishPredictedMove();
+	#endif
+}
+
+
+// Where this tick left the player, keyed by the command's tick (tickbase gets bumped after the move)
+void MotionDriver::RecordHistory()
+{
+	if ( History->Ticks() == 0 )
+	{
+		return;
+	}
+
+	CBaseEntity* ground = MLPlayer.CurrentGroundEntity();
+	MoveSnapshot snap;
+	snap.Tick         = player->m_nTickBase;
+	snap.Position     = MLPlayer.CurrentPosition();
+	snap.Velocity     = MLPlayer.CurrentVelocity();
+	snap.NetForce     = FCalc.Forces.Net;
+	snap.GroundNormal = MLPlayer.CurrentGroundNormal;
+	snap.Grounded     = MLPlayer.IsGrounded;
+	snap.Jumped       = FCalc.Forces.Jumped;
+	#ifdef MOTIONLAB_HEADLESS
+		snap.GroundEnt = ground ? 0 : -1;  // headless worlds are one static entity
+	#else
+		snap.GroundEnt = ground ? ground->entindex() : -1;
+	#endif
+	History->Record( MLPlayer.Index(), snap );
+}
+
+
+// Same point in the tick as RecordHistory, but the full-precision picture, handed off to a writer thread
+void MotionDriver::PublishTelemetry()
+{
+	if ( !Telemetry )
+	{
+		return;
+	}
+
+	const ForceResult& forces = FCalc.Forces;
+	TelemetryRecord rec;
+	Q_memset( &rec, 0, sizeof( rec ) );  // deterministic padding on disk
+	rec.Tick           = player->m_nTickBase;
+	rec.Player         = (int16)MLPlayer.Index();
+	rec.Flags          = ( MLPlayer.IsGrounded ? TELEMFLAG_GROUNDED : 0 ) | ( forces.Jumped ? TELEMFLAG_JUMPED : 0 )
+	                   | ( MLPlayer.CanJump ? TELEMFLAG_CANJUMP : 0 );
+	rec.StepPath       = (uint8)MoveStepPath;
+	rec.BumpsUsed      = (uint8)MoveBumps;
+	rec.Position       = MLPlayer.CurrentPosition();
+	rec.Velocity       = MLPlayer.CurrentVelocity();
+	rec.GroundNormal   = MLPlayer.CurrentGroundNormal;
+	rec.GroundFriction = MLPlayer.CurrentGroundFriction;
+	rec.NetForce       = forces.Net;
+	rec.WASDForce      = forces.WASD;
+	rec.FrictionForce  = forces.Friction;
+	rec.JumpForce      = forces.Jump;
+	rec.GravForce      = forces.Grav;
+	Telemetry->Push( rec );  // dropped (and counted) if the writer is behind
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// CLIENT PREDICTION CACHE (see ml_predictioncache.h)
+// ------------------------------------------------------------------------------------------------
+#ifdef CLIENT_DLL
+
+// Taken after the engine housekeeping, which always runs for real
+void MotionDriver::MakePredictionKey( PredictionKey& key ) const
+{
+	key.Clear();
+	key.Origin        = MLPlayer.CurrentPosition();
+	key.Velocity      = MLPlayer.CurrentVelocity();
+	key.BaseVelocity  = MLPlayer.CurrentBaseVelocity();
+	key.ViewAngles    = mv->m_vecViewAngles;
+	key.ForwardMove   = mv->m_flForwardMove;
+	key.SideMove      = mv->m_flSideMove;
+	key.UpMove        = mv->m_flUpMove;
+	key.Buttons       = mv->m_nButtons;
+	key.OldButtons    = mv->m_nOldButtons;
+	key.Flags         = player->GetFlags();
+	key.Ground        = MLPlayer.CurrentGroundEntity();
+	key.HullMins      = GetPlayerMins();
+	key.HullMaxs      = GetPlayerMaxs();
+	key.StepSize      = MLPlayer.StepHeight();
+	key.FrameTime     = FRAMETIME;
+	key.ConfigVersion = MoveConfig.Get().Version;
+	key.Options       = PackOptions( Options );
+	key.Build         = *MLPlayer.Build;
+}
+
+
+// Cache hit - do what CategorizePosition and Move did last time, without their traces
+bool MotionDriver::ReplayPredictedMove( int command, const PredictionKey& key )
+{
+	const PredictedMove* move = PredCache.Lookup( command, key );
+	if ( !move || !PredCache.CheckWorld( *move, *Backend ) )
+	{
+		++PredCache.Misses;
+		return false;
+	}
+	++PredCache.Hits;
+	PredCache.TracesSaved += move->Traces;
+
+	MLPlayer.ResetFriction();
+	if ( move->Categorized )
+	{
+		SetGroundEntity( move->HasGround ? &move->GroundTr : NULL );  // grounding, base vel, surface, ground touch
+	}
+	MoreSpaghettiContainment();
+
+	for ( int i=0; i < move->NumTouches; ++i )
+	{
+		RegisterTouch( move->Touches[i].Trace, move->Touches[i].Vel );
+	}
+	MLPlayer.UpdatePosition( move->EndPos );
+	MLPlayer.UpdateVelocity( move->EndVel );
+	mv->m_outWishVel     = move->WishVel;
+	mv->m_outJumpVel     = move->JumpVel;
+	mv->m_outStepHeight += move->StepHeight;
+
+	// Leave everything the rest of PlayerMove reads as the real move did
+	FCalc.Forces = move->Forces;
+	MoveBumps    = move->Bumps;
+	MoveStepPath = move->StepPath;
+	GroundContact* contact = GroundMemory->ForPlayer( MLPlayer.Index() );
+	if ( contact && move->HasContact )
+	{
+		*contact = move->Contact;
+	}
+	return true;
+}
+
+
+// Cache miss - run the move for real and record it. StepHeight/Traces hold their start values until
+// FinishPredictedMove turns them into deltas.
+void MotionDriver::BeginPredictedMove( int command, const PredictionKey& key )
+{
+	PredCapture             = &PredCache.Begin( command, key );
+	PredCapture->StepHeight = mv->m_outStepHeight;
+	PredCapture->Traces     = (int)Counters.TotalTracesIssued();
+	PredCaptureTouches      = false;
+}
+
+
+void MotionDriver::FinishPredictedMove()
+{
+	if ( !PredCapture )
+	{
+		return;
+	}
+	PredCapture->EndPos     = MLPlayer.CurrentPosition();
+	PredCapture->EndVel     = MLPlayer.CurrentVelocity();
+	PredCapture->WishVel    = mv->m_outWishVel;
+	PredCapture->JumpVel    = mv->m_outJumpVel;
+	PredCapture->StepHeight = mv->m_outStepHeight - PredCapture->StepHeight;
+	PredCapture->Traces     = (int)Counters.TotalTracesIssued() - PredCapture->Traces;
+	PredCapture->Forces     = FCalc.Forces;
+	PredCapture->Bumps      = MoveBumps;
+	PredCapture->StepPath   = MoveStepPath;
+
+	const GroundContact* contact = GroundMemory->ForPlayer( MLPlayer.Index() );
+	PredCapture->HasContact = contact != NULL;
+	if ( contact )
+	{
+		PredCapture->Contact = *contact;
+	}
+	PredCache.Finish( *PredCapture, *Backend );
+
+	PredCapture        = NULL;
+	PredCaptureTouches = false;
+}
+
+#endif // CLIENT_DLL
+
+
+void MotionDriver::MovePlayer( PlayerEntity* pPlayer, CMoveData* pMove, float frameTime )
+{
+	BindPlayer( pPlayer, pMove, frameTime );
+	PlayerMove();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// BATCHED TICK
+// ------------------------------------------------------------------------------------------------
+// Same pipeline as PlayerMove, cut in two around the force/accel stage. Gather runs everything up
+// to and including categorization and dumps what the force model needs into a PlayerBatch row,
+// RunForceBatch does forces + Accelerate for all rows at once, then Finish re-points the driver at
+// each player and runs SyncVPhys + Move (+ the second half of a closed-form tick) off its row.
+// SyncVPhys doesn't read velocity, so running it after Accelerate here instead of before changes
+// nothing.
+// NOTE: This bypasses ProcessMovement, so it's meant for headless runs and engine-side callers
+// that already did the usual ProcessMovement setup. batch.FrameTime must match gpGlobals.
+
+
+void MotionDriver::BindPlayer( PlayerEntity* pPlayer, CMoveData* pMove, float frameTime )
+{
+	player = pPlayer;
+	mv     = pMove;
+	#ifdef MOTIONLAB_HEADLESS
+		SimFrameTime = frameTime;
+	#else
+		NOTE_UNUSED( frameTime );  // engine side reads gpGlobals in TickSetup
+	#endif
+}
+
+
+void MotionDriver::WriteBatchRow( PlayerBatch& batch, int row )
+{
+	batch.Active[ row ]         = 1;
+	batch.Pos.Set( row, MLPlayer.CurrentPosition() );
+	batch.Vel.Set( row, MLPlayer.CurrentVelocity() );
+	batch.GroundNormal.Set( row, MLPlayer.CurrentGroundNormal );
+	batch.GroundFriction[ row ] = MLPlayer.CurrentGroundFriction;
+	batch.Grounded[ row ]       = MLPlayer.IsGrounded ? 1 : 0;
+	batch.CanJump[ row ]        = MLPlayer.CanJump ? 1 : 0;
+	batch.ForwardVal[ row ]     = PlayerInputs.ForwardVal();
+	batch.StrafeVal[ row ]      = PlayerInputs.StrafeVal();
+	batch.JumpPressed[ row ]    = PlayerInputs.JumpIsPressed() ? 1 : 0;
+	batch.ForwardDir.Set( row, MLPlayer.ForwardDir );
+	batch.StrafeDir.Set( row, MLPlayer.StrafeDir );
+	batch.Build[ row ]          = MLPlayer.Build;
+	batch.ClosedForm[ row ]     = Options.ClosedFormIntegration ? 1 : 0;
+}
+
+
+// Restore what Move/SyncVPhys need after TickSetup wiped MLPlayer/FCalc
+void MotionDriver::ReadBatchRow( const PlayerBatch& batch, int row )
+{
+	MLPlayer.CurrentGroundNormal   = batch.GroundNormal.Get( row );
+	MLPlayer.CurrentGroundFriction = batch.GroundFriction[ row ];
+	MLPlayer.IsGrounded            = batch.Grounded[ row ] != 0;
+	MLPlayer.CanJump               = batch.CanJump[ row ] != 0;
+	MLPlayer.UpdateVelocity( batch.Vel.Get( row ) );
+
+	FCalc.Forces.WASD          = batch.WASDForce.Get( row );
+	FCalc.Forces.Friction      = batch.FrictionForce.Get( row );
+	FCalc.Forces.Net           = batch.NetForce.Get( row );
+	FCalc.Forces.Grav          = batch.GravForce.Get( row );
+	FCalc.Forces.Jump          = batch.JumpForce.Get( row );
+	FCalc.Forces.DragPerMass   = batch.AppliedDrag[ row ];
+	FCalc.Forces.FrictionDecel = batch.FrictionDecel[ row ];
+	FCalc.Forces.Jumped        = batch.Jumped[ row ] != 0;
+}
+
+
+bool MotionDriver::BatchGather( PlayerEntity* pPlayer, CMoveData* pMove, PlayerBatch& batch, int row )
+{
+	BindPlayer( pPlayer, pMove, batch.FrameTime );
+	++Counters.Ticks;
+	TickSetup();
+	SpaghettiContainment();
+	UpdateMovementAxes();
+	if ( PlayerIsStuck() )
+	{
+		batch.Active[ row ] = 0;
+		return false;
+	}
+	CategorizePosition();
+	MoreSpaghettiContainment();
+	WriteBatchRow( batch, row );
+	return true;
+}
+
+
+void MotionDriver::BatchFinish( PlayerEntity* pPlayer, CMoveData* pMove, PlayerBatch& batch, int row )
+{
+	if ( !batch.Active[ row ] )
+	{
+		return;
+	}
+
+	BindPlayer( pPlayer, pMove, batch.FrameTime );
+	TickSetup();                 // just re-points interfaces, no traces
+	ReadBatchRow( batch, row );
+	SyncVPhys();
+	Move();
+	FinishAccelerate();
+	RecordHistory();
+	PublishTelemetry();
+
+	batch.Pos.Set( row, MLPlayer.CurrentPosition() );
+	batch.Vel.Set( row, MLPlayer.CurrentVelocity() );
 }
 
 
 // Expose MotionDriver as the IGameMovement provider (mirrors Valve pattern)
+#ifndef MOTIONLAB_HEADLESS
 static motionlab::MotionDriver g_GameMovement;
 IGameMovement *g_pGameMovement = ( IGameMovement * )&g_GameMovement;
 EXPOSE_SINGLE_INTERFACE_GLOBALVAR( CGameMovement, IGameMovement, INTERFACENAME_GAMEMOVEMENT, g_GameMovement );
+#endif
+
+
+// Server-side perf stats for the global driver
+#if !defined( CLIENT_DLL ) && !defined( MOTIONLAB_HEADLESS )
+CON_COMMAND( ml_tracecache_stats, "Print motionlab per-tick trace cache hit/miss counts" )
+{
+	const TraceCache& cache = g_GameMovement.GetTraceCache();
+	int64 total = cache.Hits + cache.Misses;
+	Msg( "ml trace cache: %lld hits, %lld misses (%.1f%% hit rate)\n",
+	     cache.Hits, cache.Misses, total ? 100.0 * cache.Hits / total : 0.0 );
+}
+
+CON_COMMAND( ml_record, "Record every player's movement inputs and trace results for offline replay. Usage: ml_record <file>" )
+{
+	if ( args.ArgC() < 2 )
+	{
+		Msg( "Usage: ml_record <file>\n" );
+		return;
+	}
+	if ( !g_GameMovement.StartRecording( args[1] ) )
+	{
+		Warning( "ml_record: couldn't open %s\n", args[1] );
+		return;
+	}
+	Msg( "ml_record: recording to %s\n", args[1] );
+}
+
+CON_COMMAND( ml_record_stop, "Stop an ml_record recording" )
+{
+	int64 ticks = g_GameMovement.GetRecorder().TickCount();
+	g_GameMovement.StopRecording();
+	Msg( "ml_record: stopped, %lld player ticks\n", ticks );
+}
+
+CON_COMMAND( ml_movecounters, "Print motionlab collision work counters (traces by caller, slide bumps, step outcomes)" )
+{
+	g_GameMovement.GetMoveCounters().Dump();
+}
+
+CON_COMMAND( ml_history, "Print a player's recent movement history. Usage: ml_history <entindex> [ticks]" )
+{
+	if ( args.ArgC() < 2 )
+	{
+		Msg( "Usage: ml_history <entindex> [ticks]\n" );
+		return;
+	}
+	int          index = atoi( args[1] );
+	int          count = args.ArgC() > 2 ? atoi( args[2] ) : 16;
+	CBasePlayer* pl    = UTIL_PlayerByIndex( index );
+	if ( !pl )
+	{
+		Warning( "ml_history: no player %d\n", index );
+		return;
+	}
+
+	const MoveHistoryStore& history = g_GameMovement.GetHistory();
+	Msg( "%d ticks kept, %d KB\n", history.Ticks(), history.MemoryUsed() / 1024 );
+	for ( int tick = pl->m_nTickBase - 1; tick >= 0 && count > 0; --tick, --count )
+	{
+		MoveSnapshot s;
+		if ( !history.Get( index, tick, s ) )
+		{
+			break;
+		}
+		Msg( "%8d  pos %9.2f %9.2f %9.2f  vel %8.2f %8.2f %8.2f  force %9.1f %9.1f %9.1f  %s%s ground %d\n",
+		     s.Tick, s.Position.x, s.Position.y, s.Position.z, s.Velocity.x, s.Velocity.y, s.Velocity.z,
+		     s.NetForce.x, s.NetForce.y, s.NetForce.z, s.Grounded ? "G" : "-", s.Jumped ? "J" : "-", s.GroundEnt );
+	}
+}
+
+CON_COMMAND( ml_movecounters_reset, "Zero motionlab collision work counters" )
+{
+	g_GameMovement.GetMoveCounters().Reset();
+}
+
+static TelemetryStream g_Telemetry;
+
+CON_COMMAND( ml_telemetry_start, "Stream every PlayerMove's forces and contact state to a file. Usage: ml_telemetry_start <file> [ring size]" )
+{
+	if ( args.ArgC() < 2 )
+	{
+		Msg( "Usage: ml_telemetry_start <file> [ring size]\n" );
+		return;
+	}
+	int ringSize = args.ArgC() > 2 ? atoi( args[2] ) : 8192;
+
+	g_GameMovement.SetTelemetry( NULL );
+	if ( !g_Telemetry.Start( args[1], ringSize ) )
+	{
+		Warning( "ml_telemetry_start: couldn't open %s\n", args[1] );
+		return;
+	}
+	g_GameMovement.SetTelemetry( g_Telemetry.AddProducer() );
+	Msg( "ml_telemetry: streaming to %s\n", args[1] );
+}
+
+CON_COMMAND( ml_telemetry_stats, "Print motionlab telemetry records published, dropped and written" )
+{
+	if ( !g_Telemetry.IsRunning() )
+	{
+		Msg( "ml_telemetry: not running\n" );
+		return;
+	}
+	Msg( "ml_telemetry: %llu published, %llu dropped, %llu written\n",
+	     g_Telemetry.Published(), g_Telemetry.Dropped(), g_Telemetry.Written() );
+}
+
+CON_COMMAND( ml_telemetry_stop, "Stop an ml_telemetry_start stream" )
+{
+	if ( !g_Telemetry.IsRunning() )
+	{
+		return;
+	}
+	g_GameMovement.SetTelemetry( NULL );  // same thread as PlayerMove, so nothing's mid-push
+	uint64 dropped = g_Telemetry.Dropped();
+	g_Telemetry.Stop();
+	Msg( "ml_telemetry: stopped, %llu records written, %llu dropped\n", g_Telemetry.Written(), dropped );
+}
 
+#ifdef MOTIONLAB_PROFILE
+static void MLProfCaptureChanged( IConVar* var, const char* oldValue, float oldFloat )
+{
+	g_GameMovement.GetProfiler().SetCapture( ConVarRef( var ).GetBool() );
+}
+static ConVar ml_prof_capture( "ml_prof_capture", "0", 0, "Record individual PlayerMove stage events for ml_prof_trace", MLProfCaptureChanged );
+
+CON_COMMAND( ml_prof_dump, "Print PlayerMove per-stage timing histograms. Usage: ml_prof_dump [slowest players to list]" )
+{
+	g_GameMovement.GetProfiler().Dump( args.ArgC() > 1 ? atoi( args[1] ) : 5 );
+}
+
+CON_COMMAND( ml_prof_reset, "Clear PlayerMove stage timings and captured events" )
+{
+	g_GameMovement.GetProfiler().Reset();
+}
+
+CON_COMMAND( ml_prof_trace, "Write captured PlayerMove stage events as Chrome trace JSON. Usage: ml_prof_trace <file>" )
+{
+	if ( args.ArgC() < 2 )
+	{
+		Msg( "Usage: ml_prof_trace <file>\n" );
+		return;
+	}
+
+	CUtlBuffer            buf;
+	const TickProfiler*   prof = &g_GameMovement.GetProfiler();
+	TickProfiler::WriteChromeTrace( buf, &prof, 1 );
+	if ( !filesystem->WriteFile( args[1], "MOD", buf ) )
+	{
+		Warning( "ml_prof_trace: couldn't write %s\n", args[1] );
+		return;
+	}
+	Msg( "ml_prof_trace: wrote %s\n", args[1] );
+}
+#endif // MOTIONLAB_PROFILE
+#endif
+
+
+
+// Client-side prediction cache upkeep for the global driver
+#ifdef CLIENT_DLL
+// Entity pointers and command numbers mean nothing across a level change
+class CMotionPredictionCacheSystem : public CAutoGameSystem
+{
+	public:
+		CMotionPredictionCacheSystem() : CAutoGameSystem( "CMotionPredictionCacheSystem" ) {}
+
+		virtual void LevelShutdownPostEntity() OVERRIDE
+		{
+			g_GameMovement.GetPredictionCache().Clear();
+		}
+};
+
+static CMotionPredictionCacheSystem g_MotionPredictionCacheSystem;
+
+CON_COMMAND( ml_predcache_stats, "Print motionlab client prediction cache hits/misses and traces saved" )
+{
+	const PredictionCache& cache = g_GameMovement.GetPredictionCache();
+	int64 total = cache.Hits + cache.Misses;
+	Msg( "ml prediction cache: %lld hits, %lld misses (%.1f%% hit rate), %lld traces saved\n",
+	     cache.Hits, cache.Misses, total ? 100.0 * cache.Hits / total : 0.0, cache.TracesSaved );
+}
+#endif // CLIENT_DLL
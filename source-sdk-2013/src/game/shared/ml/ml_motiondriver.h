@@ -7,19 +7,101 @@
 #include "ml_inputreader.h"
 #include "ml_player.h"
 #include "ml_forcecalculator.h"
+#include "ml_backend.h"
+#include "ml_forcebatch.h"
+#include "ml_options.h"
+#include "ml_tracecache.h"
+#include "ml_groundcontact.h"
+#include "ml_history.h"
+#include "ml_buildprofile.h"
+#include "ml_moveconfig.h"
+#include "ml_profiler.h"
+#include "ml_movecounters.h"
+#include "ml_recording.h"
+#include "ml_predictioncache.h"
+#include "ml_statecodec.h"
+#include "ml_telemetry.h"
+
+#ifdef MOTIONLAB_HEADLESS
+	#include "headless/ml_simmovement.h"
+#endif
 
 class CBaseEntity;
 
 namespace motionlab {
 
+#ifdef MOTIONLAB_HEADLESS
+	using MovementBase = SimGameMovement;
+#else
+	using MovementBase = CGameMovement;
+#endif
+
 // We subclass CGameMovement so we can override PlayerMove as our per-tick entry point
-class MotionDriver : public CGameMovement
+// (headless builds subclass SimGameMovement instead, which mimics just enough of it)
+class MotionDriver : public MovementBase
 {
 private:
 	float           FRAMETIME;
 	InputReader     PlayerInputs;
 	MLabPlayer      MLPlayer;     
 	ForceCalculator FCalc;
+	MotionBackend*  Backend;      // all world queries go through here
+	MotionOptions   Options;
+	MovementConfigCache MoveConfig;  // ConVar snapshot, refreshed once per frame in TickSetup
+	const SurfaceTable* Surfaces; // Backend's, re-fetched every tick
+	mutable TraceCache Traces;    // per-tick, reset in TickSetup
+
+	// Last tick's end-of-move ground contacts. Points at OwnGroundMemory unless shared (MovementPool).
+	GroundContactStore  OwnGroundMemory;
+	GroundContactStore* GroundMemory;
+	int64               GroundReuses;
+	int64               GroundProbes;
+
+	// Last N ticks of every player's movement. Points at OwnHistory unless shared (MovementPool).
+	MoveHistoryStore    OwnHistory;
+	MoveHistoryStore*   History;
+
+	// Player builds. Points at OwnBuildProfiles unless shared (MovementPool).
+	BuildProfileStore   OwnBuildProfiles;
+	BuildProfileStore*  BuildProfiles;
+
+	mutable MoveCounters Counters;  // collision work, always on
+
+	// What the last Slide() ran into, so Move() can tell whether Step() is worth trying
+	struct SlideContact
+	{
+		Vector Normal;
+		float  Dist;
+		Vector Pos;   // player origin at the hit
+	};
+	SlideContact  SlideContacts[ MAX_BUMPS ];
+	int           NumSlideContacts;
+	bool          SlideStuck;     // unusable trace or out of clip planes - no telling what's there
+
+	MoveRecorder    Recorder;     // wraps Backend while recording
+
+	TelemetryRing*  Telemetry;    // NULL unless publishing (ml_telemetry.h)
+	int             MoveBumps;    // this Move()'s slide bumps, for telemetry
+	int             MoveStepPath; // TelemetryStepPath
+
+	// Where this Move() left the ground - StayOnGround's contact, airborne if it found none (or never
+	// ran). The second closed-form half-tick takes its friction from here.
+	bool            MoveEndGrounded;
+	Vector          MoveEndGroundNormal;
+	float           MoveEndGroundFriction;
+
+#ifdef CLIENT_DLL
+	PredictionCache PredCache;    // per-command results of prediction replays
+	PredictedMove*  PredCapture;  // where this command's move is being recorded, NULL if it isn't
+	bool            PredCaptureTouches;  // only Move's touches, CategorizePosition's get replayed with it
+#endif
+
+#ifndef MOTIONLAB_HEADLESS
+	EngineMotionBackend EngineBackend;
+#endif
+#ifdef MOTIONLAB_PROFILE
+	TickProfiler    Profiler;
+#endif
 
 
 	// ----- ANCILLARY SOURCE OVERRIDES -----------------------------------------------------------	
@@ -33,7 +115,7 @@ private:
 	void          UpdateMovementAxes();
 	bool          PlayerIsStuck();
 	bool          TraceHitEntity( const hulltrace& tr ) const;
-	surfacedata*  GetTraceSurfaceData( const hulltrace& tr ) const;
+	const SurfaceEntry* GetTraceSurface( const hulltrace& tr ) const;
 	void          UpdatePlayerGameMaterial( const hulltrace& groundTr );
 	bool          PlaneIsStandable( const plane& pl ) const;
 	CBaseEntity*  GetTraceCollisionEntity( const hulltrace* tr ) const;
@@ -42,20 +124,46 @@ private:
 	void          UpdateGrounding( const hulltrace* groundTr );
 	bool          RegisterTouch( const hulltrace& tr, const Vector& collisionVel );
 	void          SetGroundEntity( const hulltrace *groundTr );
+	bool          RecallGroundContact( const Vector& pos, hulltrace& groundTr );
+	void          RememberGroundContact( const hulltrace& groundTr );
+	void          ProbeGround( const Vector& pos, hulltrace& groundTr );
     void          CategorizePosition();
 	void          MoreSpaghettiContainment();
 	void          SyncVPhys();
 	void          Accelerate();
-	void          TracePlayerMovementBBox( const Vector& startPos, const Vector& targetPos, hulltrace& outTr ) const;
+	void          FinishAccelerate();
+	Vector        ClosedFormHalfTick( const Vector& vel, float frictionDecel, const Vector& groundNormal ) const;
+	void          CachedTrace( const Vector& startPos, const Vector& targetPos, const Vector& mins, const Vector& maxs,
+	                           unsigned int mask, TraceCaller caller, hulltrace& outTr ) const;
+	void          TraceHull( const Vector& startPos, const Vector& targetPos, const Vector& mins, const Vector& maxs,
+	                         TraceCaller caller, hulltrace& outTr ) const;
+	void          TracePlayerMovementBBox( const Vector& startPos, const Vector& targetPos, TraceCaller caller,
+	                                       hulltrace& outTr ) const;
+	void          TouchGroundInQuadrants( const Vector& startPos, const Vector& targetPos, hulltrace& groundTr ) const;
 	bool          CheckTraceStuck( const hulltrace& tr ) const;
 	bool          CheckSlideTraceInvalid( const hulltrace& tr ) const;
-	Vector        DeflectVelocity( const Vector& currentVel, const Vector& normal, float overbounce ) const;
 	bool          Slide();
-	void          TraceStep( const Vector& start, float signedDist, hulltrace& tr );
+	void          TraceStep( const Vector& start, float signedDist, TraceCaller caller, hulltrace& tr );
 	void          StayOnGround( void );
 	void          VPhysStep( float stepHeight );
 	void          Step( const Vector& preSlidePos, const Vector& preSlideVel );
+	bool          WallTooTallToStep( const SlideContact& contact );
+	bool          StepCouldHelp();
+	void          MoveBounds( Vector& mins, Vector& maxs ) const;
 	void          Move();
+	void          RecordHistory();
+	void          PublishTelemetry();
+
+	void          BindPlayer( PlayerEntity* pPlayer, CMoveData* pMove, float frameTime );
+	void          WriteBatchRow( PlayerBatch& batch, int row );
+	void          ReadBatchRow( const PlayerBatch& batch, int row );
+
+#ifdef CLIENT_DLL
+	void          MakePredictionKey( PredictionKey& key ) const;
+	bool          ReplayPredictedMove( int command, const PredictionKey& key );
+	void          BeginPredictedMove( int command, const PredictionKey& key );
+	void          FinishPredictedMove();
+#endif
 
 public:
 
@@ -63,6 +171,62 @@ public:
 	virtual ~MotionDriver();
 
 	virtual void PlayerMove() OVERRIDE; // Core override - this is our entry point
+
+	// Runs PlayerMove for an arbitrary player without going through ProcessMovement. Same caveat
+	// as the batch entry points below - the caller owns any ProcessMovement-side setup.
+	void         MovePlayer( PlayerEntity* pPlayer, CMoveData* pMove, float frameTime );
+
+	// Batched tick - PlayerMove split around forces/Accelerate so those can run SoA for everyone.
+	// Gather every player, RunForceBatch() once, then Finish every player.
+	bool         BatchGather( PlayerEntity* pPlayer, CMoveData* pMove, PlayerBatch& batch, int row );
+	void         BatchFinish( PlayerEntity* pPlayer, CMoveData* pMove, PlayerBatch& batch, int row );
+
+	// Swap where traces/touches go, e.g. a headless collision world. NULL restores the engine default.
+	void           SetBackend( MotionBackend* backend );
+	MotionBackend* GetBackend() const;
+
+	// Feature switches (game DLLs overwrite these from ConVars every tick) and their stats
+	void                 SetOptions( const MotionOptions& options );
+	const MotionOptions& GetOptions() const;
+	const TraceCache&    GetTraceCache() const;
+	const MovementConfig& GetMovementConfig() const;
+
+	// Ground contact memory. NULL goes back to this driver's own store.
+	void                 SetGroundMemory( GroundContactStore* store );
+	GroundContactStore&  GetGroundMemory();
+	int64                GroundContactsReused() const;
+	int64                GroundProbesRun() const;
+
+	// Movement history (ml_history.h). NULL goes back to this driver's own store, which the game
+	// DLLs size from ml_history_ticks - headless harnesses Reserve() it themselves.
+	void                 SetHistory( MoveHistoryStore* store );
+	MoveHistoryStore&    GetHistory();
+
+	// Which build each player moves with. NULL goes back to this driver's own store.
+	void                 SetBuildProfiles( BuildProfileStore* store );
+	BuildProfileStore&   GetBuildProfiles();
+
+	// Record every PlayerMove's inputs and backend answers for offline replay (headless/ml_replay)
+	bool                 StartRecording( const char* path );
+	void                 StopRecording();
+	const MoveRecorder&  GetRecorder() const;
+
+	// Publish a record per PlayerMove into this ring (TelemetryStream::AddProducer). NULL stops.
+	void                 SetTelemetry( TelemetryRing* ring );
+
+	// Sendable state (ml_statecodec.h) of whoever PlayerMove last ran for
+	void                 GetPlayerNetState( PlayerNetState& out ) const;
+
+	// Collision work counters, see ml_movecounters.h
+	MoveCounters&        GetMoveCounters();
+
+#ifdef CLIENT_DLL
+	PredictionCache&     GetPredictionCache();
+#endif
+
+#ifdef MOTIONLAB_PROFILE
+	TickProfiler&        GetProfiler();
+#endif
 };
 
 } // namespace motionlab
\ No newline at end of file
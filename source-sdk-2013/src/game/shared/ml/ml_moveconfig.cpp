@@ -0,0 +1,98 @@
+#include "cbase.h"
+#include "movevars_shared.h"  // cl_*speed ConVars, GetCurrentGravity
+#include "ml_moveconfig.h"
+
+using namespace motionlab;
+
+
+#ifndef MOTIONLAB_HEADLESS
+static ConVar ml_tracecache( "ml_tracecache", "1", FCVAR_REPLICATED, "Memoize identical hull traces within a single PlayerMove" );
+static ConVar ml_groundmemory( "ml_groundmemory", "1", FCVAR_REPLICATED, "Reuse last tick's end-of-move ground contact instead of re-probing when the player hasn't moved" );
+static ConVar ml_localsnapshot( "ml_localsnapshot", "1", FCVAR_REPLICATED, "Resolve slide/step/snap traces against a per-tick local brush set (backend permitting)" );
+static ConVar ml_closedform( "ml_closedform", "0", FCVAR_REPLICATED, "Integrate velocity in closed form (half before Move, half after) so movement barely depends on tick rate" );
+static ConVar ml_history_ticks( "ml_history_ticks", "256", 0, "Ticks of per-player movement history to keep (rounded up to a power of 2, 0 = off)" );
+static ConVar ml_predictstep( "ml_predictstep", "1", FCVAR_REPLICATED, "Skip the step-up attempt when everything the slide hit is a slope, a ceiling or a wall taller than a step" );
+#endif
+#ifdef CLIENT_DLL
+static ConVar ml_predcache( "ml_predcache", "1", 0, "Reuse a predicted command's result when prediction replays it from the same start state" );
+#endif
+
+
+MovementConfig::MovementConfig()
+{
+	Version         = 0;
+	Gravity         = 0.0f;
+	ForwardSpeed    = 0.0f;
+	BackSpeed       = 0.0f;
+	SideSpeed       = 0.0f;
+	InvForwardSpeed = 0.0f;
+	InvBackSpeed    = 0.0f;
+	InvSideSpeed    = 0.0f;
+	HistoryTicks    = 0;
+	PredictionCache = false;
+}
+
+
+static float SafeReciprocal( float x )
+{
+	return x > 0.0f ? 1.0f / x : 0.0f;
+}
+
+
+MovementConfigCache::MovementConfigCache()
+{
+	LastFrame = -1;
+}
+
+
+void MovementConfigCache::Derive()
+{
+	Config.InvForwardSpeed = SafeReciprocal( Config.ForwardSpeed );
+	Config.InvBackSpeed    = SafeReciprocal( Config.BackSpeed );
+	Config.InvSideSpeed    = SafeReciprocal( Config.SideSpeed );
+	++Config.Version;
+}
+
+
+void MovementConfigCache::Refresh( int frame )
+{
+	if ( frame >= 0 && frame == LastFrame )
+	{
+		return;
+	}
+	LastFrame = frame;
+
+	#ifndef MOTIONLAB_HEADLESS
+		Config.Options.TraceCache            = ml_tracecache.GetBool();
+		Config.Options.LocalSnapshot         = ml_localsnapshot.GetBool();
+		Config.Options.GroundMemory          = ml_groundmemory.GetBool();
+		Config.Options.ClosedFormIntegration = ml_closedform.GetBool();
+		Config.Options.PredictiveStep        = ml_predictstep.GetBool();
+		Config.HistoryTicks                  = ml_history_ticks.GetInt();
+	#endif
+	#ifdef CLIENT_DLL
+		Config.PredictionCache = ml_predcache.GetBool();
+	#endif
+
+	float gravity = GetCurrentGravity();
+	float fwd     = cl_forwardspeed.GetFloat();
+	float back    = cl_backspeed.GetFloat();
+	float side    = cl_sidespeed.GetFloat();
+	if ( Config.Version && gravity == Config.Gravity && fwd == Config.ForwardSpeed
+	     && back == Config.BackSpeed && side == Config.SideSpeed )
+	{
+		return;
+	}
+
+	Config.Gravity      = gravity;
+	Config.ForwardSpeed = fwd;
+	Config.BackSpeed    = back;
+	Config.SideSpeed    = side;
+	Derive();
+}
+
+
+const MovementConfig& MovementConfigCache::Get() const
+{
+	return Config;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ml_defs.h"
+#include "ml_options.h"
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// The movement ConVars motionlab reads, snapshotted once per frame along with whatever gets derived
+// from them. Everything in the pipeline reads this instead of the ConVars (or GetCurrentGravity's
+// gamerules call) directly. Version bumps only when one of the movement values actually changes,
+// so anything that caches off the config can just compare versions. The ml_* switches don't count
+// towards it - the prediction cache keys on those separately.
+// -------------------------------------------------------------------------------------------------
+struct MovementConfig
+{
+	uint32 Version;
+
+	float  Gravity;          // GetCurrentGravity(), gamerules scaling included
+	float  ForwardSpeed;     // cl_forwardspeed/cl_backspeed/cl_sidespeed - full-deflection input values
+	float  BackSpeed;
+	float  SideSpeed;
+
+	// Derived
+	float  InvForwardSpeed;  // 0 when the speed is <= 0, so that axis just reads as no input
+	float  InvBackSpeed;
+	float  InvSideSpeed;
+
+	// ml_* ConVars, game DLLs only. Headless drivers get their options from SetOptions and keep
+	// these at the defaults.
+	MotionOptions Options;
+	int    HistoryTicks;     // ml_history_ticks
+	bool   PredictionCache;  // ml_predcache, client only
+
+	MovementConfig();
+};
+
+
+// Owns a MovementConfig and keeps it current. One per driver, so pool workers never share a
+// snapshot being refreshed.
+class MovementConfigCache
+{
+	private:
+		MovementConfig Config;
+		int            LastFrame;
+
+		void           Derive();
+
+	public:
+		MovementConfigCache();
+
+		// Re-reads the ConVars if frame differs from the last call (-1 = always). Cheap when nothing
+		// changed - just the reads and compares.
+		void                  Refresh( int frame );
+		const MovementConfig& Get() const;
+};
+
+} // namespace motionlab
@@ -0,0 +1,109 @@
+#include "cbase.h"
+#include "ml_movecounters.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+static const char* s_TraceCallerNames[ TRACE_CALLER_COUNT ] =
+{
+	"Slide",
+	"CheckTraceStuck",
+	"Step",
+	"StayOnGround",
+	"CategorizePosition",
+	"Quadrants",
+	"StepProbe",
+};
+
+
+const char* motionlab::TraceCallerName( int caller )
+{
+	return ( caller >= 0 && caller < TRACE_CALLER_COUNT ) ? s_TraceCallerNames[ caller ] : "?";
+}
+
+
+MoveCounters::MoveCounters()
+{
+	Reset();
+}
+
+
+void MoveCounters::Reset()
+{
+	Q_memset( this, 0, sizeof( *this ) );
+}
+
+
+void MoveCounters::Merge( const MoveCounters& other )
+{
+	Ticks += other.Ticks;
+	for ( int i=0; i < TRACE_CALLER_COUNT; ++i )
+	{
+		TracesRequested[i] += other.TracesRequested[i];
+		TracesIssued[i]    += other.TracesIssued[i];
+	}
+	for ( int i=0; i <= MAX_BUMPS; ++i )
+	{
+		SlideBumps[i] += other.SlideBumps[i];
+	}
+	Creases       += other.Creases;
+	Corners       += other.Corners;
+	StepsTaken    += other.StepsTaken;
+	StepsStraight += other.StepsStraight;
+	StepsSteep    += other.StepsSteep;
+	StepsSkipped  += other.StepsSkipped;
+	WallReuses    += other.WallReuses;
+	GroundSnaps   += other.GroundSnaps;
+}
+
+
+int64 MoveCounters::TotalTracesIssued() const
+{
+	int64 total = 0;
+	for ( int i=0; i < TRACE_CALLER_COUNT; ++i )
+	{
+		total += TracesIssued[i];
+	}
+	return total;
+}
+
+
+void MoveCounters::Dump() const
+{
+	double perTick = Ticks ? 1.0 / Ticks : 0.0;
+
+	Msg( "%lld ticks\n", Ticks );
+	Msg( "%-20s %12s %12s %10s\n", "traces", "requested", "issued", "issued/tick" );
+	int64 totalReq = 0;
+	int64 totalIss = 0;
+	for ( int i=0; i < TRACE_CALLER_COUNT; ++i )
+	{
+		Msg( "  %-18s %12lld %12lld %10.3f\n", TraceCallerName( i ), TracesRequested[i], TracesIssued[i], TracesIssued[i] * perTick );
+		totalReq += TracesRequested[i];
+		totalIss += TracesIssued[i];
+	}
+	Msg( "  %-18s %12lld %12lld %10.3f\n", "total", totalReq, totalIss, totalIss * perTick );
+
+	Msg( "slide bumps:" );
+	for ( int i=0; i <= MAX_BUMPS; ++i )
+	{
+		Msg( "  %d: %lld", i, SlideBumps[i] );
+	}
+	Msg( "\n" );
+
+	// Anything past one bump hit something - this is the number clip solver changes should move
+	int64 colliding     = 0;
+	int64 collidingBump = 0;
+	for ( int i=2; i <= MAX_BUMPS; ++i )
+	{
+		colliding     += SlideBumps[i];
+		collidingBump += SlideBumps[i] * i;
+	}
+	Msg( "slide traces per colliding slide: %.3f (%lld slides)\n", colliding ? (double)collidingBump / colliding : 0.0, colliding );
+	Msg( "creases: %lld, corners (zeroed): %lld\n", Creases, Corners );
+	Msg( "steps: %lld stepped, %lld straight, %lld steep rejects\n", StepsTaken, StepsStraight, StepsSteep );
+	Msg( "steps skipped: %lld (%lld off wall memory)\n", StepsSkipped, WallReuses );
+	Msg( "ground snaps: %lld (%.3f/tick)\n", GroundSnaps, GroundSnaps * perTick );
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ml_defs.h"
+
+namespace motionlab {
+
+// Who asked for a hull trace
+enum TraceCaller
+{
+	TRACE_SLIDE = 0,
+	TRACE_STUCKCHECK,    // CheckTraceStuck's zero-length trace
+	TRACE_STEP,          // Step's up/down traces
+	TRACE_STAYONGROUND,
+	TRACE_CATEGORIZE,    // CategorizePosition's ground probe
+	TRACE_QUADRANT,      // ...and its quadrant fallback
+	TRACE_STEPPROBE,     // WallTooTallToStep's raised probe
+
+	TRACE_CALLER_COUNT
+};
+
+const char* TraceCallerName( int caller );
+
+
+// -------------------------------------------------------------------------------------------------
+// Collision work counters. Always on - plain increments on the driver's own copy, so no atomics
+// and nothing shared between pool workers. Merge() them for a combined view.
+// -------------------------------------------------------------------------------------------------
+struct MoveCounters
+{
+	int64 Ticks;
+
+	// Hull traces asked for, and how many of those actually reached the backend (cache misses)
+	int64 TracesRequested[ TRACE_CALLER_COUNT ];
+	int64 TracesIssued[ TRACE_CALLER_COUNT ];
+
+	// Slide() calls by number of bump traces they used
+	int64 SlideBumps[ MAX_BUMPS + 1 ];
+
+	// Slide branches
+	int64 Creases;       // no single plane worked, slid along the edge between two
+	int64 Corners;       // boxed in by 3+ planes, zeroed velocity
+
+	// Step() outcomes
+	int64 StepsTaken;    // stepped path got further
+	int64 StepsStraight; // straight slide got further
+	int64 StepsSteep;    // step-down landed on unstandable ground, fell back to straight
+	int64 StepsSkipped;  // slide was blocked but nothing it hit could be stepped over
+	int64 WallReuses;    // ...of which decided off a remembered tall wall, no probe
+
+	// StayOnGround
+	int64 GroundSnaps;   // actually moved the player down
+
+	MoveCounters();
+	void  Reset();
+	void  Merge( const MoveCounters& other );
+	void  Dump() const;
+	int64 TotalTracesIssued() const;
+};
+
+} // namespace motionlab
@@ -0,0 +1,288 @@
+#include "cbase.h"
+#include "tier0/threadtools.h"
+#include "ml_motiondriver.h"
+#include "ml_movepool.h"
+
+using namespace motionlab;
+
+
+static inline uint64 PackRange( uint32 next, uint32 end )
+{
+	return ( (uint64)end << 32 ) | next;
+}
+
+static inline uint32 RangeNext( uint64 range )
+{
+	return (uint32)( range & 0xFFFFFFFF );
+}
+
+static inline uint32 RangeEnd( uint64 range )
+{
+	return (uint32)( range >> 32 );
+}
+
+
+MovementPool::MovementPool()
+{
+	Jobs        = NULL;
+	FrameTime   = 0.0f;
+	Generation  = 0;
+	Quit        = false;
+	BusyWorkers = 0;
+}
+
+
+MovementPool::~MovementPool()
+{
+	Shutdown();
+}
+
+
+void MovementPool::Init( int numWorkers )
+{
+	Shutdown();
+
+	// New workers start out having seen generation 0, so it has to be 0 again here or they'd wake
+	// straight away on a stale one and drop BusyWorkers under a later Run()
+	numWorkers = MAX( 1, numWorkers );
+	Quit       = false;
+	Generation = 0;
+	for ( int i=0; i < numWorkers; ++i )
+	{
+		Worker* worker     = new Worker;
+		worker->Driver     = new MotionDriver;
+		worker->Driver->SetGroundMemory( &SharedGroundMemory );
+		worker->Driver->SetBuildProfiles( &SharedBuildProfiles );
+		worker->Driver->SetHistory( &SharedHistory );
+		worker->Range      = PackRange( 0, 0 );
+		worker->JobsRun    = 0;
+		worker->JobsStolen = 0;
+		Workers.AddToTail( worker );
+	}
+
+	// Worker 0 is whoever calls Run(), the rest get threads
+	for ( int i=1; i < numWorkers; ++i )
+	{
+		Workers[i]->Thread = std::thread( &MovementPool::WorkerMain, this, i );
+	}
+}
+
+
+void MovementPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock( WakeMutex );
+		Quit = true;
+	}
+	WakeCond.notify_all();
+
+	for ( int i=0; i < Workers.Count(); ++i )
+	{
+		if ( Workers[i]->Thread.joinable() )
+		{
+			Workers[i]->Thread.join();
+		}
+		delete Workers[i]->Driver;
+		delete Workers[i];
+	}
+	Workers.RemoveAll();
+}
+
+
+int MovementPool::WorkerCount() const
+{
+	return Workers.Count();
+}
+
+
+MotionDriver& MovementPool::Driver( int worker )
+{
+	return *Workers[ worker ]->Driver;
+}
+
+
+GroundContactStore& MovementPool::GetGroundMemory()
+{
+	return SharedGroundMemory;
+}
+
+
+BuildProfileStore& MovementPool::GetBuildProfiles()
+{
+	return SharedBuildProfiles;
+}
+
+
+MoveHistoryStore& MovementPool::GetHistory()
+{
+	return SharedHistory;
+}
+
+
+int MovementPool::JobsRun( int worker ) const
+{
+	return Workers[ worker ]->JobsRun;
+}
+
+
+int MovementPool::JobsStolen( int worker ) const
+{
+	return Workers[ worker ]->JobsStolen;
+}
+
+
+bool MovementPool::CanRunParallel() const
+{
+	if ( Workers.Count() < 2 )
+	{
+		return false;
+	}
+
+	for ( int i=0; i < Workers.Count(); ++i )
+	{
+		MotionBackend* backend = Workers[i]->Driver->GetBackend();
+		if ( !backend || !backend->SupportsParallelMoves() )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+// Owner side - take the next job off the front of our own range
+bool MovementPool::PopFront( Worker& worker, int& job )
+{
+	uint64 range = worker.Range.load( std::memory_order_relaxed );
+	while ( RangeNext( range ) < RangeEnd( range ) )
+	{
+		uint64 claimed = PackRange( RangeNext( range ) + 1, RangeEnd( range ) );
+		if ( worker.Range.compare_exchange_weak( range, claimed, std::memory_order_acq_rel ) )
+		{
+			job = (int)RangeNext( range );
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// Thief side - take the last job off the back of someone else's range
+bool MovementPool::PopBack( Worker& victim, int& job )
+{
+	uint64 range = victim.Range.load( std::memory_order_relaxed );
+	while ( RangeNext( range ) < RangeEnd( range ) )
+	{
+		uint64 claimed = PackRange( RangeNext( range ), RangeEnd( range ) - 1 );
+		if ( victim.Range.compare_exchange_weak( range, claimed, std::memory_order_acq_rel ) )
+		{
+			job = (int)RangeEnd( range ) - 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void MovementPool::WorkUntilDry( int self )
+{
+	Worker&       me     = *Workers[ self ];
+	MotionDriver& driver = *me.Driver;
+	const int     count  = Workers.Count();
+	int           job;
+
+	for ( ;; )
+	{
+		if ( PopFront( me, job ) )
+		{
+			driver.MovePlayer( Jobs[ job ].Player, Jobs[ job ].MoveData, FrameTime );
+			++me.JobsRun;
+			continue;
+		}
+
+		// Own range is dry, go rob the neighbours
+		bool stole = false;
+		for ( int i=1; i < count && !stole; ++i )
+		{
+			stole = PopBack( *Workers[ ( self + i ) % count ], job );
+		}
+		if ( !stole )
+		{
+			return;  // everyone's dry
+		}
+
+		driver.MovePlayer( Jobs[ job ].Player, Jobs[ job ].MoveData, FrameTime );
+		++me.JobsRun;
+		++me.JobsStolen;
+	}
+}
+
+
+void MovementPool::WorkerMain( int self )
+{
+	uint32 seenGeneration = 0;
+	for ( ;; )
+	{
+		{
+			std::unique_lock<std::mutex> lock( WakeMutex );
+			WakeCond.wait( lock, [&]{ return Quit || Generation != seenGeneration; } );
+			if ( Quit )
+			{
+				return;
+			}
+			seenGeneration = Generation;
+		}
+
+		WorkUntilDry( self );
+		BusyWorkers.fetch_sub( 1, std::memory_order_release );
+	}
+}
+
+
+void MovementPool::Run( const MoveJob* jobs, int count, float frameTime )
+{
+	if ( Workers.Count() == 0 )
+	{
+		Init( 1 );
+	}
+
+	Jobs      = jobs;
+	FrameTime = frameTime;
+	for ( int i=0; i < Workers.Count(); ++i )
+	{
+		Workers[i]->JobsRun    = 0;
+		Workers[i]->JobsStolen = 0;
+	}
+
+	if ( !CanRunParallel() )
+	{
+		Workers[0]->Range = PackRange( 0, count );
+		WorkUntilDry( 0 );
+		return;
+	}
+
+	// Deal out contiguous ranges, remainder spread over the first few workers
+	const int numWorkers = Workers.Count();
+	int       begin      = 0;
+	for ( int i=0; i < numWorkers; ++i )
+	{
+		int size = count / numWorkers + ( i < count % numWorkers ? 1 : 0 );
+		Workers[i]->Range.store( PackRange( begin, begin + size ), std::memory_order_relaxed );
+		begin += size;
+	}
+
+	BusyWorkers.store( numWorkers - 1, std::memory_order_relaxed );
+	{
+		std::lock_guard<std::mutex> lock( WakeMutex );
+		++Generation;
+	}
+	WakeCond.notify_all();
+
+	WorkUntilDry( 0 );
+
+	// Wait for stragglers - they're at most one player behind once we've run dry
+	while ( BusyWorkers.load( std::memory_order_acquire ) > 0 )
+	{
+		ThreadPause();
+	}
+}
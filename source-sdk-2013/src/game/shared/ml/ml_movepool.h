@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "tier1/utlvector.h"
+#include "ml_defs.h"
+#include "ml_groundcontact.h"
+#include "ml_buildprofile.h"
+
+class CMoveData;
+
+namespace motionlab {
+
+class MotionDriver;
+
+// One player's worth of movement for this tick
+struct MoveJob
+{
+	PlayerEntity* Player;
+	CMoveData*    MoveData;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Runs PlayerMove for a whole set of players across a pool of worker threads. Every worker owns
+// its own MotionDriver (and the caller gives each its own backend), so no driver state is shared.
+// Players get dealt out as contiguous ranges, one per worker. A worker pops jobs off the front of
+// its own range and, once that's empty, steals off the back of someone else's - per-player cost
+// is all over the place (a player grinding a corner vs one standing still), so static splits
+// alone leave threads idle.
+//
+// Each player is moved exactly once by exactly one driver, and drivers carry nothing from one
+// player to the next, so results are identical to moving them serially in any order. The one bit
+// of per-player state that does outlive a tick (ground contact memory) lives in a store shared by
+// all the pool's drivers, so it doesn't matter which worker picks a player up next tick. Same goes
+// for player builds and movement history.
+//
+// Falls back to running everything on the calling thread if any worker's backend can't run in
+// parallel (see MotionBackend::SupportsParallelMoves) - i.e. always, with the engine backend.
+// -------------------------------------------------------------------------------------------------
+class MovementPool
+{
+	public:
+		MovementPool();
+		~MovementPool();
+
+		// numWorkers includes the calling thread, so 1 = serial
+		void          Init( int numWorkers );
+		void          Shutdown();
+		int           WorkerCount() const;
+		MotionDriver& Driver( int worker );  // set a backend on each of these before Run()
+		GroundContactStore& GetGroundMemory();  // Reserve() this for the highest player index you'll use
+		BuildProfileStore&  GetBuildProfiles(); // ditto
+		MoveHistoryStore&   GetHistory();       // ditto, with however many ticks you want kept
+
+		// Moves every job once, blocks until all are done
+		void          Run( const MoveJob* jobs, int count, float frameTime );
+
+		// Per-worker counters for the last Run()
+		int           JobsRun( int worker ) const;
+		int           JobsStolen( int worker ) const;
+
+	private:
+		struct Worker
+		{
+			MotionDriver*         Driver;
+			std::atomic<uint64>   Range;       // ( end << 32 ) | next - both ends move, so one CAS word
+			std::thread           Thread;
+			int                   JobsRun;
+			int                   JobsStolen;
+		};
+
+		CUtlVector<Worker*>       Workers;
+		GroundContactStore        SharedGroundMemory;
+		BuildProfileStore         SharedBuildProfiles;
+		MoveHistoryStore          SharedHistory;
+		const MoveJob*            Jobs;
+		float                     FrameTime;
+
+		// Wakeup/completion for the background workers
+		std::mutex                WakeMutex;
+		std::condition_variable   WakeCond;
+		uint32                    Generation;
+		bool                      Quit;
+		std::atomic<int>          BusyWorkers;
+
+		bool          CanRunParallel() const;
+		bool          PopFront( Worker& worker, int& job );
+		bool          PopBack( Worker& victim, int& job );
+		void          WorkUntilDry( int self );
+		void          WorkerMain( int self );
+};
+
+} // namespace motionlab
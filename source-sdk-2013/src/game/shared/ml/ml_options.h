@@ -0,0 +1,28 @@
+#pragma once
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Per-driver feature switches. The game DLLs copy these out of the per-frame MovementConfig
+// snapshot of the ml_* ConVars on tick entry, headless harnesses just set them with
+// MotionDriver::SetOptions.
+// -------------------------------------------------------------------------------------------------
+struct MotionOptions
+{
+	bool TraceCache;     // memoize identical hull traces within a tick
+	bool LocalSnapshot;  // resolve Move()'s traces against a per-tick local brush set, if the backend can
+	bool GroundMemory;   // reuse last tick's end-of-move ground contact in CategorizePosition
+	bool ClosedFormIntegration;  // velocity integration that barely depends on tick rate, see ClosedFormStep
+	bool PredictiveStep; // only try Step when the first slide hit something it could get over
+
+	MotionOptions()
+	{
+		TraceCache    = true;
+		LocalSnapshot = true;
+		GroundMemory  = true;
+		ClosedFormIntegration = false;
+		PredictiveStep = true;
+	}
+};
+
+} // namespace motionlab
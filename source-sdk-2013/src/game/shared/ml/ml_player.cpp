@@ -11,7 +11,7 @@ MLabPlayer::MLabPlayer()
 
 
 // Called per tick, per player by MotionDriver to clean initialize player interface fields
-void MLabPlayer::Setup( CMoveData* moveData, CBasePlayer* basePlayer )
+void MLabPlayer::Setup( CMoveData* moveData, PlayerEntity* basePlayer )
 {
 	// Source entities which this class exists to interface with
 	mv         = moveData;
@@ -25,12 +25,9 @@ void MLabPlayer::Setup( CMoveData* moveData, CBasePlayer* basePlayer )
 	ForwardDir.Init();
 	StrafeDir.Init();
 	UpDir.Init();
-	
-	// Placeholder properties - eventually will be determined by player's build
-	Mass       = 100.0f;
-	DragCoeff  = 1.0f;
-	BoostForce = 1.0f;
-	JumpForce  = 1.0f;
+
+	Build    = NULL;  // MotionDriver points this at the player's profile
+	StepSize = basePlayer ? basePlayer->GetStepHeight() : 0.0f;
 }
 
 
@@ -140,12 +137,19 @@ void MLabPlayer::UpdateStepSound()
 
 float MLabPlayer::StepHeight() const
 {
-	return baseplayer->GetStepHeight();
+	return StepSize;
 }
 
 
 // Amount of upward velocity we get by applying one tick of jump force
 float MLabPlayer::JumpImpulseVel( float frameTime ) const
 {
-	return ( JumpForce / Mass ) * frameTime;
-}
\ No newline at end of file
+	return Build->JumpAccel * frameTime;
+}
+
+
+// Player entindex, for per-player storage that lives outside the entity
+int MLabPlayer::Index() const
+{
+	return baseplayer->entindex();
+}
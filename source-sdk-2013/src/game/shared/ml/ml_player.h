@@ -1,8 +1,9 @@
 #pragma once
 
 #include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_buildprofile.h"
 
-class CBasePlayer;
 class CMoveData;
 class CBaseEntity;
 
@@ -16,18 +17,16 @@ namespace motionlab {
 class MLabPlayer
 {
 	private:
-		CMoveData*   mv;
-		CBasePlayer* baseplayer;
+		CMoveData*    mv;
+		PlayerEntity* baseplayer;
 
 	public:
 		MLabPlayer();
-		void Setup( CMoveData* moveData, CBasePlayer* basePlayer );
+		void Setup( CMoveData* moveData, PlayerEntity* basePlayer );
 
-		// placeholder player properties - eventually these will be properties of the player's build
-		float         Mass;
-		float         DragCoeff;
-		float         BoostForce;
-		float         JumpForce;
+		// this player's build, out of MotionDriver's BuildProfileStore
+		const BuildProfile* Build;
+		float         StepSize;  // base player's step height, read once in Setup
 
 		// derived state (computed once per tick by MotionDriver)
 		bool          IsGrounded;
@@ -61,6 +60,7 @@ class MLabPlayer
 		// misc housekeeping/accessors
 		void          RecordFallVelocity();
 		bool          IsObserver() const;
+		int           Index() const;
 };
 
 } // namespace motionlab
\ No newline at end of file
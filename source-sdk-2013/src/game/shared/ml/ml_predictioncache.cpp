@@ -0,0 +1,112 @@
+#include "cbase.h"
+#include "ml_predictioncache.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+void PredictionKey::Clear()
+{
+	Q_memset( this, 0, sizeof( *this ) );
+}
+
+
+bool PredictionKey::operator==( const PredictionKey& other ) const
+{
+	return Q_memcmp( this, &other, sizeof( *this ) ) == 0;
+}
+
+
+PredictionCache::PredictionCache()
+{
+	Hits        = 0;
+	Misses      = 0;
+	TracesSaved = 0;
+	Clear();
+}
+
+
+// Forget every command, e.g. on level change
+void PredictionCache::Clear()
+{
+	for ( int i=0; i < PREDCACHE_SIZE; ++i )
+	{
+		Moves[i].Command = 0;
+	}
+}
+
+
+const PredictedMove* PredictionCache::Lookup( int command, const PredictionKey& start ) const
+{
+	const PredictedMove& move = Moves[ command & ( PREDCACHE_SIZE - 1 ) ];
+	if ( command == 0 || move.Command != command || !( move.Start == start ) )
+	{
+		return NULL;
+	}
+	return &move;
+}
+
+
+// Same solid entities around, none of them moved or turned
+bool PredictionCache::CheckWorld( const PredictedMove& move, const MotionBackend& backend ) const
+{
+	EntityPose nearby[ PREDCACHE_MAX_NEARBY ];
+	int        count = backend.EntitiesInBox( move.BoxMins, move.BoxMaxs, nearby, PREDCACHE_MAX_NEARBY );
+	if ( count != move.NumNearby )
+	{
+		return false;
+	}
+
+	// Enumeration order isn't guaranteed to stay the same, so look each one up
+	for ( int i=0; i < count; ++i )
+	{
+		bool found = false;
+		for ( int j=0; j < move.NumNearby && !found; ++j )
+		{
+			const EntityPose& was = move.Nearby[j];
+			found = was.Ent == nearby[i].Ent && was.Origin == nearby[i].Origin && was.Angles == nearby[i].Angles;
+		}
+		if ( !found )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+PredictedMove& PredictionCache::Begin( int command, const PredictionKey& start )
+{
+	PredictedMove& move = Moves[ command & ( PREDCACHE_SIZE - 1 ) ];
+	move.Command     = command;
+	move.Start       = start;
+	move.NumNearby   = 0;
+	move.Categorized = false;
+	move.HasGround   = false;
+	move.NumTouches  = 0;
+	move.StepHeight  = 0.0f;
+	move.Traces      = 0;
+	move.HasContact  = false;
+	return move;
+}
+
+
+// Snapshot who's in the move's box. Throws the move away if the backend can't say, or there are
+// too many to keep track of.
+bool PredictionCache::Finish( PredictedMove& move, const MotionBackend& backend )
+{
+	if ( move.Command == 0 )
+	{
+		return false;
+	}
+
+	int count = backend.EntitiesInBox( move.BoxMins, move.BoxMaxs, move.Nearby, PREDCACHE_MAX_NEARBY );
+	if ( count < 0 || count > PREDCACHE_MAX_NEARBY )
+	{
+		move.Command = 0;
+		return false;
+	}
+	move.NumNearby = count;
+	return true;
+}
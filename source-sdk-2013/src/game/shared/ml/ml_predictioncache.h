@@ -0,0 +1,129 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_backend.h"
+#include "ml_buildprofile.h"
+#include "ml_forcemodel.h"
+#include "ml_groundcontact.h"
+
+class CBaseEntity;
+
+namespace motionlab {
+
+constexpr int PREDCACHE_SIZE        = 128;            // power of 2, covers MULTIPLAYER_BACKUP (90) commands
+constexpr int PREDCACHE_MAX_NEARBY  = 8;              // entities near the move it'll track, more = don't cache
+constexpr int PREDCACHE_MAX_TOUCHES = 2 * MAX_BUMPS;  // straight slide + stepped slide
+
+
+// Everything PlayerMove's result depends on, other than the world. Compared with memcmp, so fill it
+// through PredictionKey::Clear() first to keep the padding zeroed.
+struct PredictionKey
+{
+	Vector       Origin;
+	Vector       Velocity;
+	Vector       BaseVelocity;
+	QAngle       ViewAngles;
+	float        ForwardMove;
+	float        SideMove;
+	float        UpMove;
+	int          Buttons;
+	int          OldButtons;
+	int          Flags;
+	CBaseEntity* Ground;
+	Vector       HullMins;
+	Vector       HullMaxs;
+	float        StepSize;
+	float        FrameTime;
+	int          ConfigVersion;  // MovementConfigCache::Get().Version
+	uint32       Options;        // PackOptions
+	BuildProfile Build;
+
+	void Clear();
+	bool operator==( const PredictionKey& other ) const;
+};
+
+
+// One predicted command's worth of PlayerMove output, enough to put the player where it went
+// without running the move again
+struct PredictedMove
+{
+	int           Command;        // command_number, 0 = empty
+	PredictionKey Start;
+
+	// The world as the move saw it - the box every trace could reach, and who was standing in it
+	Vector        BoxMins;
+	Vector        BoxMaxs;
+	EntityPose    Nearby[ PREDCACHE_MAX_NEARBY ];
+	int           NumNearby;
+
+	// CategorizePosition's answer, replayed through SetGroundEntity for its side effects
+	bool          Categorized;    // false for observers, who skip it
+	bool          HasGround;
+	hulltrace     GroundTr;
+
+	// Move's touches, replayed into the backend's touch list
+	struct Touch
+	{
+		hulltrace Trace;
+		Vector    Vel;
+	};
+	Touch         Touches[ PREDCACHE_MAX_TOUCHES ];
+	int           NumTouches;
+
+	Vector        EndPos;
+	Vector        EndVel;
+	Vector        WishVel;        // mv->m_outWishVel/m_outJumpVel, PlayerMove zeroes both on entry
+	Vector        JumpVel;
+	float         StepHeight;     // what the move added to mv->m_outStepHeight
+	int           Traces;         // backend traces it took, i.e. what a hit saves
+
+	// What the tail of PlayerMove reads, so a hit still feeds history, telemetry and ground memory
+	ForceResult   Forces;
+	int           Bumps;
+	int           StepPath;
+	bool          HasContact;     // player has a ground memory slot
+	GroundContact Contact;        // that slot as the move left it
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Client prediction replays every unacknowledged command each frame, from wherever the last server
+// update put the player. Most of those replays start from exactly the state they started from last
+// frame, so they'd end up exactly where they ended up last frame. This remembers each command's
+// start state and result, so the replay only has to actually simulate from the first command whose
+// start state differs (a correction, a changed ConVar, ...) - and everything after it then misses
+// on its own, since its start state moved too.
+//
+// The world check: a hit also needs every solid entity in the move's reach to be the same ones, in
+// the same place, as when the command was cached. The static world can't change under us without
+// a level change, which Clear()s this.
+//
+// Client only (see MotionDriver::PlayerMove) - the server runs each command once.
+// -------------------------------------------------------------------------------------------------
+class PredictionCache
+{
+	private:
+		PredictedMove Moves[ PREDCACHE_SIZE ];
+
+	public:
+		PredictionCache();
+		void           Clear();
+
+		// The cached move for this command if it started from the same state, NULL otherwise.
+		// Still needs CheckWorld() before it can be used.
+		const PredictedMove* Lookup( int command, const PredictionKey& start ) const;
+		bool           CheckWorld( const PredictedMove& move, const MotionBackend& backend ) const;
+
+		// Slot to fill for this command, emptied. Finish() it once the move is done, or leave Command
+		// at 0 to throw it away.
+		PredictedMove& Begin( int command, const PredictionKey& start );
+		bool           Finish( PredictedMove& move, const MotionBackend& backend );
+
+		// Lifetime counters, never reset by Clear()
+		int64 Hits;
+		int64 Misses;
+		int64 TracesSaved;
+};
+
+} // namespace motionlab
@@ -0,0 +1,322 @@
+#include "cbase.h"
+#include "ml_profiler.h"
+
+#ifdef MOTIONLAB_PROFILE
+
+#include <math.h>
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+static const char* s_StageNames[ MLSTAGE_COUNT ] =
+{
+	"TickSetup",
+	"SpaghettiContainment",
+	"UpdateMovementAxes",
+	"CategorizePosition",
+	"MoreSpaghettiContainment",
+	"CalcCurrentForces",
+	"SyncVPhys",
+	"Accelerate",
+	"Move",
+	"  Slide",
+	"  SolveClipVelocity",
+	"  Step",
+	"  StayOnGround",
+	"PlayerMove",
+};
+
+
+const char* motionlab::StageName( int stage )
+{
+	return ( stage >= 0 && stage < MLSTAGE_COUNT ) ? s_StageNames[ stage ] : "?";
+}
+
+
+static inline double CyclesToUs( uint64 cycles )
+{
+	return CCycleCount( cycles ).GetMicrosecondsF();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// StageHistogram
+// ------------------------------------------------------------------------------------------------
+
+StageHistogram::StageHistogram()
+{
+	Clear();
+}
+
+
+void StageHistogram::Clear()
+{
+	Q_memset( Buckets, 0, sizeof( Buckets ) );
+	Count = 0;
+	Total = 0.0;
+	Max   = 0.0f;
+}
+
+
+void StageHistogram::Add( float ns )
+{
+	int bucket = ns > 1.0f ? (int)( log2f( ns ) * PROF_BUCKETS_PER_OCTAVE ) : 0;
+	++Buckets[ clamp( bucket, 0, PROF_NUM_BUCKETS - 1 ) ];
+	++Count;
+	Total += ns;
+	Max    = MAX( Max, ns );
+}
+
+
+void StageHistogram::Merge( const StageHistogram& other )
+{
+	for ( int i=0; i < PROF_NUM_BUCKETS; ++i )
+	{
+		Buckets[i] += other.Buckets[i];
+	}
+	Count += other.Count;
+	Total += other.Total;
+	Max    = MAX( Max, other.Max );
+}
+
+
+float StageHistogram::Percentile( float fraction ) const
+{
+	if ( !Count )
+	{
+		return 0.0f;
+	}
+
+	uint64 target = (uint64)ceil( fraction * Count );
+	uint64 seen   = 0;
+	for ( int i=0; i < PROF_NUM_BUCKETS; ++i )
+	{
+		seen += Buckets[i];
+		if ( seen >= MAX( target, (uint64)1 ) )
+		{
+			return MIN( powf( 2.0f, (float)( i + 1 ) / PROF_BUCKETS_PER_OCTAVE ), Max );
+		}
+	}
+	return Max;
+}
+
+
+float StageHistogram::Mean() const
+{
+	return Count ? (float)( Total / Count ) : 0.0f;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TickProfiler
+// ------------------------------------------------------------------------------------------------
+
+TickProfiler::TickProfiler()
+{
+	NextEvent     = 0;
+	Capturing     = false;
+	CurrentPlayer = 0;
+}
+
+
+TickProfiler::~TickProfiler()
+{
+	for ( int i=0; i < PerPlayer.Count(); ++i )
+	{
+		delete[] PerPlayer[i];
+	}
+}
+
+
+void TickProfiler::Reset()
+{
+	for ( int s=0; s < MLSTAGE_COUNT; ++s )
+	{
+		Aggregate[s].Clear();
+	}
+	for ( int i=0; i < PerPlayer.Count(); ++i )
+	{
+		delete[] PerPlayer[i];
+	}
+	PerPlayer.RemoveAll();
+	Events.RemoveAll();
+	NextEvent = 0;
+}
+
+
+void TickProfiler::SetCapture( bool capture )
+{
+	Capturing = capture;
+}
+
+
+void TickProfiler::BeginPlayer( int playerIndex )
+{
+	CurrentPlayer = playerIndex;
+}
+
+
+StageHistogram* TickProfiler::PlayerStages( int playerIndex )
+{
+	if ( playerIndex < 0 )
+	{
+		return NULL;
+	}
+	while ( PerPlayer.Count() <= playerIndex )
+	{
+		PerPlayer.AddToTail( NULL );
+	}
+	if ( !PerPlayer[ playerIndex ] )
+	{
+		PerPlayer[ playerIndex ] = new StageHistogram[ MLSTAGE_COUNT ];
+	}
+	return PerPlayer[ playerIndex ];
+}
+
+
+void TickProfiler::Record( int stage, const CCycleCount& start, const CCycleCount& end )
+{
+	uint64 cycles = end.GetLongCycles() - start.GetLongCycles();
+	float  ns     = (float)( CyclesToUs( cycles ) * 1000.0 );
+
+	Aggregate[ stage ].Add( ns );
+	StageHistogram* player = PlayerStages( CurrentPlayer );
+	if ( player )
+	{
+		player[ stage ].Add( ns );
+	}
+
+	if ( Capturing )
+	{
+		if ( Events.Count() < PROF_MAX_EVENTS )
+		{
+			Events.AddToTail();
+		}
+		StageEvent& ev = Events[ NextEvent ];
+		ev.Start  = start.GetLongCycles();
+		ev.Cycles = cycles;
+		ev.Player = CurrentPlayer;
+		ev.Stage  = stage;
+		NextEvent = ( NextEvent + 1 ) % PROF_MAX_EVENTS;
+	}
+}
+
+
+void TickProfiler::Merge( const TickProfiler& other )
+{
+	for ( int s=0; s < MLSTAGE_COUNT; ++s )
+	{
+		Aggregate[s].Merge( other.Aggregate[s] );
+	}
+	for ( int i=0; i < other.PerPlayer.Count(); ++i )
+	{
+		if ( !other.PerPlayer[i] )
+		{
+			continue;
+		}
+		StageHistogram* mine = PlayerStages( i );
+		for ( int s=0; s < MLSTAGE_COUNT; ++s )
+		{
+			mine[s].Merge( other.PerPlayer[i][s] );
+		}
+	}
+}
+
+
+const StageHistogram& TickProfiler::GetStage( int stage ) const
+{
+	return Aggregate[ stage ];
+}
+
+
+void TickProfiler::Dump( int topPlayers ) const
+{
+	Msg( "%-26s %10s %9s %9s %9s %9s  (us)\n", "stage", "count", "mean", "p50", "p99", "max" );
+	for ( int s=0; s < MLSTAGE_COUNT; ++s )
+	{
+		const StageHistogram& h = Aggregate[s];
+		Msg( "%-26s %10llu %9.2f %9.2f %9.2f %9.2f\n", StageName( s ), h.Count,
+		     h.Mean() / 1000.0f, h.Percentile( 0.5f ) / 1000.0f, h.Percentile( 0.99f ) / 1000.0f, h.Max / 1000.0f );
+	}
+
+	if ( topPlayers <= 0 )
+	{
+		return;
+	}
+
+	// Slowest players by p99 whole-tick time. Player counts are small, a selection pass is fine.
+	CUtlVector<int> shown;
+	Msg( "\nslowest players (PlayerMove p99):\n" );
+	for ( int n=0; n < topPlayers; ++n )
+	{
+		int   worst    = -1;
+		float worstP99 = -1.0f;
+		for ( int i=0; i < PerPlayer.Count(); ++i )
+		{
+			if ( !PerPlayer[i] || !PerPlayer[i][ MLSTAGE_TICK ].Count || shown.HasElement( i ) )
+			{
+				continue;
+			}
+			float p99 = PerPlayer[i][ MLSTAGE_TICK ].Percentile( 0.99f );
+			if ( p99 > worstP99 )
+			{
+				worst    = i;
+				worstP99 = p99;
+			}
+		}
+		if ( worst < 0 )
+		{
+			break;
+		}
+		shown.AddToTail( worst );
+
+		const StageHistogram* stages = PerPlayer[ worst ];
+		int                   slowStage = 0;
+		for ( int s=1; s < MLSTAGE_TICK; ++s )
+		{
+			if ( stages[s].Percentile( 0.99f ) > stages[ slowStage ].Percentile( 0.99f ) )
+			{
+				slowStage = s;
+			}
+		}
+		Msg( "  player %3d: %8llu ticks, p50 %7.2f, p99 %7.2f, max %7.2f us - worst stage %s\n", worst,
+		     stages[ MLSTAGE_TICK ].Count, stages[ MLSTAGE_TICK ].Percentile( 0.5f ) / 1000.0f,
+		     worstP99 / 1000.0f, stages[ MLSTAGE_TICK ].Max / 1000.0f, StageName( slowStage ) );
+	}
+}
+
+
+// Complete ("X") events, timestamps in us relative to the earliest captured event
+void TickProfiler::WriteChromeTrace( CUtlBuffer& buf, const TickProfiler* const* profilers, int count )
+{
+	uint64 base = (uint64)-1;
+	for ( int p=0; p < count; ++p )
+	{
+		for ( int i=0; i < profilers[p]->Events.Count(); ++i )
+		{
+			base = MIN( base, profilers[p]->Events[i].Start );
+		}
+	}
+
+	buf.SetBufferType( true, false );
+	buf.PutString( "{\"traceEvents\":[\n" );
+	bool first = true;
+	for ( int p=0; p < count; ++p )
+	{
+		const CUtlVector<StageEvent>& events = profilers[p]->Events;
+		for ( int i=0; i < events.Count(); ++i )
+		{
+			const StageEvent& ev = events[i];
+			buf.Printf( "%s{\"name\":\"%s\",\"cat\":\"motionlab\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+			            "\"pid\":1,\"tid\":%d,\"args\":{\"player\":%d}}",
+			            first ? "" : ",\n", StageName( ev.Stage ), CyclesToUs( ev.Start - base ),
+			            CyclesToUs( ev.Cycles ), p, ev.Player );
+			first = false;
+		}
+	}
+	buf.PutString( "\n]}\n" );
+}
+
+#endif // MOTIONLAB_PROFILE
@@ -0,0 +1,144 @@
+#pragma once
+
+// -------------------------------------------------------------------------------------------------
+// Per-stage PlayerMove profiler. Only exists in builds with MOTIONLAB_PROFILE defined - otherwise
+// the macros below collapse to the bare call and none of this gets compiled.
+//
+//   ML_PROFILE_PLAYER( prof, index )       tag the following stages with a player
+//   ML_PROFILE_SCOPE( prof, stage )        time the rest of the enclosing scope
+//   ML_PROFILE_STAGE( prof, stage, call )  time one call
+// -------------------------------------------------------------------------------------------------
+#ifdef MOTIONLAB_PROFILE
+	#define ML_PROFILE_PLAYER( prof, index )       ( prof ).BeginPlayer( index )
+	#define ML_PROFILE_SCOPE( prof, stage )        motionlab::StageTimer mlScopeTimer_( prof, stage )
+	#define ML_PROFILE_STAGE( prof, stage, call )  do { motionlab::StageTimer mlStageTimer_( prof, stage ); call; } while ( 0 )
+#else
+	#define ML_PROFILE_PLAYER( prof, index )
+	#define ML_PROFILE_SCOPE( prof, stage )
+	#define ML_PROFILE_STAGE( prof, stage, call )  call
+#endif
+
+
+#ifdef MOTIONLAB_PROFILE
+
+#include "tier0/fasttimer.h"
+#include "tier1/utlvector.h"
+#include "tier1/utlbuffer.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+// PlayerMove's stages, in pipeline order. The MOVE_ ones are nested inside MLSTAGE_MOVE (and Step's
+// own Slide counts as a Slide too), so don't add them up with the rest.
+enum MotionStage
+{
+	MLSTAGE_TICKSETUP = 0,
+	MLSTAGE_SPAGHETTI,
+	MLSTAGE_MOVEMENTAXES,
+	MLSTAGE_CATEGORIZE,
+	MLSTAGE_MORESPAGHETTI,
+	MLSTAGE_FORCES,
+	MLSTAGE_SYNCVPHYS,
+	MLSTAGE_ACCELERATE,
+	MLSTAGE_MOVE,
+	MLSTAGE_MOVE_SLIDE,
+	MLSTAGE_MOVE_CLIPVELOCITY,
+	MLSTAGE_MOVE_STEP,
+	MLSTAGE_MOVE_STAYONGROUND,
+	MLSTAGE_TICK,  // the whole PlayerMove, stuck ticks included
+
+	MLSTAGE_COUNT
+};
+
+const char* StageName( int stage );
+
+constexpr int PROF_BUCKETS_PER_OCTAVE = 4;
+constexpr int PROF_NUM_BUCKETS        = 100;      // 1ns up to ~33ms at 4 per octave
+constexpr int PROF_MAX_EVENTS         = 1 << 16;  // trace capture ring size
+
+
+// Log-scale duration histogram, quarter-octave buckets (~19% wide)
+class StageHistogram
+{
+	public:
+		StageHistogram();
+		void   Clear();
+		void   Add( float ns );
+		void   Merge( const StageHistogram& other );
+		float  Percentile( float fraction ) const;  // upper edge of the bucket holding that sample, ns
+		float  Mean() const;
+
+		uint32 Buckets[ PROF_NUM_BUCKETS ];
+		uint64 Count;
+		double Total;
+		float  Max;
+};
+
+
+// One timed stage, kept for trace export while capturing
+struct StageEvent
+{
+	uint64 Start;  // cycle counter
+	uint64 Cycles;
+	int    Player;
+	int    Stage;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// One per MotionDriver, so pool workers never share one. Merge() them for a combined report.
+// -------------------------------------------------------------------------------------------------
+class TickProfiler
+{
+	private:
+		StageHistogram              Aggregate[ MLSTAGE_COUNT ];
+		CUtlVector<StageHistogram*> PerPlayer;  // [player][stage], allocated on first sight
+		CUtlVector<StageEvent>      Events;     // ring
+		int                         NextEvent;
+		bool                        Capturing;
+		int                         CurrentPlayer;
+
+		StageHistogram* PlayerStages( int playerIndex );
+
+	public:
+		TickProfiler();
+		~TickProfiler();
+
+		void          Reset();
+		void          SetCapture( bool capture );
+		void          BeginPlayer( int playerIndex );
+		void          Record( int stage, const CCycleCount& start, const CCycleCount& end );
+
+		void          Merge( const TickProfiler& other );  // histograms only, not captured events
+		const StageHistogram& GetStage( int stage ) const; // all players
+		void          Dump( int topPlayers ) const;        // per-stage table, then the slowest players
+
+		// Chrome trace-event JSON (chrome://tracing, Perfetto) for a set of profilers, one thread each
+		static void   WriteChromeTrace( CUtlBuffer& buf, const TickProfiler* const* profilers, int count );
+};
+
+
+class StageTimer
+{
+	private:
+		TickProfiler& Prof;
+		int           Stage;
+		CCycleCount   Start;
+
+	public:
+		StageTimer( TickProfiler& prof, int stage ) : Prof( prof ), Stage( stage )
+		{
+			Start.Sample();
+		}
+
+		~StageTimer()
+		{
+			CCycleCount end;
+			end.Sample();
+			Prof.Record( Stage, Start, end );
+		}
+};
+
+} // namespace motionlab
+
+#endif // MOTIONLAB_PROFILE
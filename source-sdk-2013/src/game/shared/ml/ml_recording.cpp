@@ -0,0 +1,351 @@
+#include "cbase.h"
+#include "igamemovement.h"
+#include "ml_recording.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+static const int RECORDING_FLUSH_BYTES = 256 * 1024;
+
+
+uint32 motionlab::PackOptions( const MotionOptions& options )
+{
+	return ( options.TraceCache    ? 1 : 0 )
+	     | ( options.LocalSnapshot ? 2 : 0 )
+	     | ( options.GroundMemory  ? 4 : 0 )
+	     | ( options.ClosedFormIntegration ? 8 : 0 )
+	     | ( options.PredictiveStep ? 16 : 0 );
+}
+
+
+MotionOptions motionlab::UnpackOptions( uint32 bits )
+{
+	MotionOptions options;
+	options.TraceCache    = ( bits & 1 ) != 0;
+	options.LocalSnapshot = ( bits & 2 ) != 0;
+	options.GroundMemory  = ( bits & 4 ) != 0;
+	options.ClosedFormIntegration = ( bits & 8 ) != 0;
+	options.PredictiveStep = ( bits & 16 ) != 0;
+	return options;
+}
+
+
+// Shared by the recorder and replay, so both sides fill (and zero) exactly the same bytes
+void motionlab::MakeTickEnd( PlayerEntity* pl, const CMoveData* mv, int groundEnt, RecTickEnd& rec )
+{
+	Q_memset( &rec, 0, sizeof( rec ) );
+	rec.Origin          = mv->GetAbsOrigin();
+	rec.Velocity        = mv->m_vecVelocity;
+	rec.BaseVelocity    = pl->GetBaseVelocity();
+	rec.GroundEnt       = groundEnt;
+	rec.FallVelocity    = pl->m_Local.m_flFallVelocity;
+	rec.SurfaceFriction = pl->m_surfaceFriction;
+	rec.TextureType     = pl->m_chPreviousTextureType;
+	rec.OutWishVel      = mv->m_outWishVel;
+	rec.OutJumpVel      = mv->m_outJumpVel;
+	rec.OutStepHeight   = mv->m_outStepHeight;
+}
+
+
+void motionlab::WriteRecordingHeader( CUtlBuffer& buf, const SurfaceTable& surfaces )
+{
+	buf.PutUnsignedInt( RECORDING_MAGIC );
+	buf.PutUnsignedInt( RECORDING_VERSION );
+	buf.PutInt( surfaces.Count() );
+	for ( int i=0; i < surfaces.Count(); ++i )
+	{
+		const SurfaceEntry* srf = surfaces.Get( i );
+		buf.PutFloat( srf->Friction );
+		buf.PutChar( srf->GameMaterial );
+		buf.PutUnsignedShort( srf->StepLeft );
+		buf.PutUnsignedShort( srf->StepRight );
+	}
+}
+
+
+bool motionlab::ReadRecordingHeader( CUtlBuffer& buf, SurfaceTable& surfaces )
+{
+	if ( buf.GetUnsignedInt() != RECORDING_MAGIC || buf.GetUnsignedInt() != RECORDING_VERSION )
+	{
+		return false;
+	}
+
+	surfaces.Clear();
+	int count = buf.GetInt();
+	for ( int i=0; i < count && buf.IsValid(); ++i )
+	{
+		surfacedata srf;
+		Q_memset( &srf, 0, sizeof( srf ) );
+		srf.physics.friction = buf.GetFloat();
+		srf.game.material    = buf.GetChar();
+		srf.sounds.stepleft  = buf.GetUnsignedShort();
+		srf.sounds.stepright = buf.GetUnsignedShort();
+		surfaces.Add( srf );
+	}
+	return buf.IsValid();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// MoveRecorder
+// ------------------------------------------------------------------------------------------------
+
+MoveRecorder::MoveRecorder()
+{
+	Inner         = NULL;
+	WorldEnt      = NULL;
+	TicksRecorded = 0;
+}
+
+
+MoveRecorder::~MoveRecorder()
+{
+	Stop();
+}
+
+
+bool MoveRecorder::Start( const char* path, MotionBackend* inner )
+{
+	Stop();
+
+	if ( !File.Open( path ) )
+	{
+		return false;
+	}
+
+	Inner         = inner;
+	TicksRecorded = 0;
+	WorldEnt      = NULL;
+	Entities.RemoveAll();
+	Buf.Purge();
+	Buf.SetBufferType( false, false );
+	WriteRecordingHeader( Buf, Inner->Surfaces() );
+	return true;
+}
+
+
+void MoveRecorder::Stop()
+{
+	if ( !File.IsOpen() )
+	{
+		return;
+	}
+
+	Flush();
+	File.Close();
+}
+
+
+void MoveRecorder::Flush()
+{
+	if ( Buf.TellPut() > 0 )
+	{
+		File.Write( Buf.Base(), Buf.TellPut() );
+	}
+	Buf.Purge();
+}
+
+
+bool MoveRecorder::IsRecording() const
+{
+	return File.IsOpen();
+}
+
+
+MotionBackend* MoveRecorder::GetInner() const
+{
+	return Inner;
+}
+
+
+void MoveRecorder::SetInner( MotionBackend* inner )
+{
+	Inner = inner;
+}
+
+
+int64 MoveRecorder::TickCount() const
+{
+	return TicksRecorded;
+}
+
+
+// Small per-recording ids instead of pointers. The world gets pinned to REC_ENT_WORLD by the
+// first trace that hits it (until then it's just another entity, which only matters for a
+// ground entity on the very first ticks).
+int MoveRecorder::EntityId( CBaseEntity* ent ) const
+{
+	if ( !ent )
+	{
+		return REC_ENT_NONE;
+	}
+	if ( ent == WorldEnt )
+	{
+		return REC_ENT_WORLD;
+	}
+	int idx = Entities.Find( ent );
+	if ( idx == Entities.InvalidIndex() )
+	{
+		idx = Entities.AddToTail( ent );
+	}
+	return idx + 2;
+}
+
+
+void MoveRecorder::BeginTick( PlayerEntity* pl, const CMoveData* mv, float frameTime, const MotionOptions& options,
+                              const BuildProfile& build, const MovementConfig& config, const Vector& hullMins,
+                              const Vector& hullMaxs )
+{
+	RecTickStart rec;
+	Q_memset( &rec, 0, sizeof( rec ) );
+	rec.Player          = pl->entindex();
+	rec.FrameTime       = frameTime;
+	rec.Options         = PackOptions( options );
+	rec.Mass            = build.Mass;
+	rec.DragCoeff       = build.DragCoeff;
+	rec.BoostForce      = build.BoostForce;
+	rec.JumpForce       = build.JumpForce;
+	rec.Archetype       = build.Archetype;
+	rec.Gravity         = config.Gravity;
+	rec.ForwardSpeed    = config.ForwardSpeed;
+	rec.BackSpeed       = config.BackSpeed;
+	rec.SideSpeed       = config.SideSpeed;
+	rec.ForwardMove     = mv->m_flForwardMove;
+	rec.SideMove        = mv->m_flSideMove;
+	rec.UpMove          = mv->m_flUpMove;
+	rec.Buttons         = mv->m_nButtons;
+	rec.OldButtons      = mv->m_nOldButtons;
+	rec.ViewAngles      = mv->m_vecViewAngles;
+	rec.Origin          = mv->GetAbsOrigin();
+	rec.Velocity        = mv->m_vecVelocity;
+	rec.BaseVelocity    = pl->GetBaseVelocity();
+	rec.GroundEnt       = EntityId( pl->GetGroundEntity() );
+	rec.FallVelocity    = pl->m_Local.m_flFallVelocity;
+	rec.HullMins        = hullMins;
+	rec.HullMaxs        = hullMaxs;
+	rec.StepHeight      = pl->GetStepHeight();
+	rec.Observer        = pl->IsObserver() ? 1 : 0;
+	rec.SurfaceFriction = pl->m_surfaceFriction;
+	rec.TextureType     = pl->m_chPreviousTextureType;
+	rec.OutWishVel      = mv->m_outWishVel;
+	rec.OutJumpVel      = mv->m_outJumpVel;
+	rec.OutStepHeight   = mv->m_outStepHeight;
+
+	Buf.PutUnsignedChar( REC_TICK_START );
+	Buf.Put( &rec, sizeof( rec ) );
+}
+
+
+void MoveRecorder::EndTick( PlayerEntity* pl, const CMoveData* mv )
+{
+	RecTickEnd rec;
+	MakeTickEnd( pl, mv, EntityId( pl->GetGroundEntity() ), rec );
+
+	Buf.PutUnsignedChar( REC_TICK_END );
+	Buf.Put( &rec, sizeof( rec ) );
+	++TicksRecorded;
+
+	if ( Buf.TellPut() >= RECORDING_FLUSH_BYTES )
+	{
+		Flush();
+	}
+}
+
+
+void MoveRecorder::TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                              unsigned int mask, int collisionGroup, hulltrace& tr )
+{
+	Inner->TraceHull( start, end, mins, maxs, mask, collisionGroup, tr );
+
+	RecTrace rec;
+	Q_memset( &rec, 0, sizeof( rec ) );
+	rec.Start        = start;
+	rec.End          = end;
+	rec.Mins         = mins;
+	rec.Maxs         = maxs;
+	rec.Mask         = mask;
+	rec.Fraction     = tr.fraction;
+	rec.EndPos       = tr.endpos;
+	rec.Normal       = tr.plane.normal;
+	rec.Dist         = tr.plane.dist;
+	rec.StartSolid   = tr.startsolid ? 1 : 0;
+	rec.AllSolid     = tr.allsolid ? 1 : 0;
+	rec.Contents     = tr.contents;
+	rec.SurfaceProps = tr.surface.surfaceProps;
+	if ( tr.m_pEnt && Inner->TraceHitWorld( tr ) )
+	{
+		WorldEnt = tr.m_pEnt;
+	}
+	rec.Ent = EntityId( tr.m_pEnt );
+
+	Buf.PutUnsignedChar( REC_TRACE );
+	Buf.Put( &rec, sizeof( rec ) );
+}
+
+
+bool MoveRecorder::TraceHitWorld( const hulltrace& tr ) const
+{
+	return Inner->TraceHitWorld( tr );
+}
+
+
+surfacedata* MoveRecorder::SurfaceData( int surfaceProps ) const
+{
+	return Inner->SurfaceData( surfaceProps );
+}
+
+
+int MoveRecorder::SurfacePropCount() const
+{
+	return Inner->SurfacePropCount();
+}
+
+
+const SurfaceTable& MoveRecorder::Surfaces() const
+{
+	return Inner->Surfaces();
+}
+
+
+Vector MoveRecorder::EntityVelocity( CBaseEntity* ent ) const
+{
+	RecEntityVel rec;
+	Q_memset( &rec, 0, sizeof( rec ) );
+	rec.Ent      = EntityId( ent );
+	rec.Velocity = Inner->EntityVelocity( ent );
+
+	Buf.PutUnsignedChar( REC_ENTITY_VEL );
+	Buf.Put( &rec, sizeof( rec ) );
+	return rec.Velocity;
+}
+
+
+void MoveRecorder::ResetTouchList()
+{
+	Inner->ResetTouchList();
+}
+
+
+bool MoveRecorder::AddToTouched( const hulltrace& tr, const Vector& impactVel )
+{
+	RecTouch rec;
+	rec.Result = Inner->AddToTouched( tr, impactVel ) ? 1 : 0;
+
+	Buf.PutUnsignedChar( REC_TOUCH );
+	Buf.Put( &rec, sizeof( rec ) );
+	return rec.Result != 0;
+}
+
+
+// Snapshots only change how fast traces come back, not what they say - nothing to record
+bool MoveRecorder::BeginLocalQueries( const Vector& mins, const Vector& maxs )
+{
+	return Inner->BeginLocalQueries( mins, maxs );
+}
+
+
+void MoveRecorder::EndLocalQueries()
+{
+	Inner->EndLocalQueries();
+}
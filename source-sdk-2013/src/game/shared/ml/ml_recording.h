@@ -0,0 +1,186 @@
+#pragma once
+
+#include "tier1/utlbuffer.h"
+#include "tier1/utlvector.h"
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_backend.h"
+#include "ml_options.h"
+#include "ml_buildprofile.h"
+#include "ml_moveconfig.h"
+#include "ml_file.h"
+
+class CMoveData;
+
+namespace motionlab {
+
+// -------------------------------------------------------------------------------------------------
+// Movement recording format. A header (magic, version, the surface table), then a flat stream of
+// tagged records - per recorded tick, one RecTickStart, every backend answer the driver got in the
+// order it asked (RecTrace/RecEntityVel/RecTouch), then a RecTickEnd to verify against.
+// Records are raw little-endian PODs, zeroed before filling so padding is deterministic. Bump
+// RECORDING_VERSION whenever one of them changes.
+// -------------------------------------------------------------------------------------------------
+constexpr uint32 RECORDING_MAGIC   = 0x43524C4D;  // "MLRC"
+constexpr uint32 RECORDING_VERSION = 3;
+
+enum RecordTag
+{
+	REC_TICK_START = 'T',
+	REC_TRACE      = 'H',
+	REC_ENTITY_VEL = 'V',
+	REC_TOUCH      = 'A',
+	REC_TICK_END   = 'E',
+};
+
+// Entity ids in recordings. Everything else gets 2 and up, in order of first sight.
+constexpr int REC_ENT_NONE  = 0;
+constexpr int REC_ENT_WORLD = 1;
+
+struct RecTickStart
+{
+	int    Player;
+	float  FrameTime;
+	uint32 Options;  // PackOptions()
+
+	// Player's build (defined fields only, replay re-derives)
+	float  Mass;
+	float  DragCoeff;
+	float  BoostForce;
+	float  JumpForce;
+	int    Archetype;
+
+	// MovementConfig the tick ran with (replay sets the ConVars from these)
+	float  Gravity;
+	float  ForwardSpeed;
+	float  BackSpeed;
+	float  SideSpeed;
+
+	// CMoveData inputs
+	float  ForwardMove;
+	float  SideMove;
+	float  UpMove;
+	int    Buttons;
+	int    OldButtons;
+	QAngle ViewAngles;
+
+	// Kinematic + player state going in
+	Vector Origin;
+	Vector Velocity;
+	Vector BaseVelocity;
+	int    GroundEnt;
+	float  FallVelocity;
+	Vector HullMins;
+	Vector HullMaxs;
+	float  StepHeight;
+	int    Observer;
+	float  SurfaceFriction;
+	int    TextureType;
+	Vector OutWishVel;
+	Vector OutJumpVel;
+	float  OutStepHeight;
+};
+
+struct RecTrace
+{
+	// Query, checked on replay to catch desyncs at the first diverging trace
+	Vector Start;
+	Vector End;
+	Vector Mins;
+	Vector Maxs;
+	uint32 Mask;
+
+	// Everything of the result the driver reads
+	float  Fraction;
+	Vector EndPos;
+	Vector Normal;
+	float  Dist;
+	int    StartSolid;
+	int    AllSolid;
+	int    Contents;
+	int    SurfaceProps;
+	int    Ent;
+};
+
+struct RecEntityVel
+{
+	int    Ent;
+	Vector Velocity;
+};
+
+struct RecTouch
+{
+	int    Result;
+};
+
+struct RecTickEnd
+{
+	Vector Origin;
+	Vector Velocity;
+	Vector BaseVelocity;
+	int    GroundEnt;
+	float  FallVelocity;
+	float  SurfaceFriction;
+	int    TextureType;
+	Vector OutWishVel;
+	Vector OutJumpVel;
+	float  OutStepHeight;
+};
+
+uint32        PackOptions( const MotionOptions& options );
+MotionOptions UnpackOptions( uint32 bits );
+
+void          MakeTickEnd( PlayerEntity* pl, const CMoveData* mv, int groundEnt, RecTickEnd& rec );
+void          WriteRecordingHeader( CUtlBuffer& buf, const SurfaceTable& surfaces );
+bool          ReadRecordingHeader( CUtlBuffer& buf, SurfaceTable& surfaces );  // false on bad magic/version
+
+
+// -------------------------------------------------------------------------------------------------
+// Backend decorator that writes a recording. Sits between MotionDriver and its real backend (see
+// MotionDriver::StartRecording) and logs every answer the real backend gives. The driver brackets
+// each tick with BeginTick/EndTick. Buffered, flushed to disk every so often.
+// Only PlayerMove ticks get recorded - the batched path interleaves players, so it's left out.
+// -------------------------------------------------------------------------------------------------
+class MoveRecorder : public MotionBackend
+{
+	private:
+		MotionBackend*           Inner;
+		OutputFile               File;
+		mutable CUtlBuffer               Buf;
+		mutable CUtlVector<CBaseEntity*> Entities;  // [id - 2]
+		CBaseEntity*                     WorldEnt;
+		int64                            TicksRecorded;
+
+		int          EntityId( CBaseEntity* ent ) const;
+		void         Flush();
+
+	public:
+		MoveRecorder();
+		~MoveRecorder();
+
+		bool           Start( const char* path, MotionBackend* inner );
+		void           Stop();
+		bool           IsRecording() const;
+		MotionBackend* GetInner() const;
+		void           SetInner( MotionBackend* inner );
+		int64          TickCount() const;
+
+		void           BeginTick( PlayerEntity* pl, const CMoveData* mv, float frameTime, const MotionOptions& options,
+		                          const BuildProfile& build, const MovementConfig& config, const Vector& hullMins,
+		                          const Vector& hullMaxs );
+		void           EndTick( PlayerEntity* pl, const CMoveData* mv );
+
+		virtual void         TraceHull( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		                                unsigned int mask, int collisionGroup, hulltrace& tr ) OVERRIDE;
+		virtual bool         TraceHitWorld( const hulltrace& tr ) const OVERRIDE;
+		virtual surfacedata* SurfaceData( int surfaceProps ) const OVERRIDE;
+		virtual int          SurfacePropCount() const OVERRIDE;
+		virtual const SurfaceTable& Surfaces() const OVERRIDE;
+		virtual Vector       EntityVelocity( CBaseEntity* ent ) const OVERRIDE;
+		virtual void         ResetTouchList() OVERRIDE;
+		virtual bool         AddToTouched( const hulltrace& tr, const Vector& impactVel ) OVERRIDE;
+		virtual bool         BeginLocalQueries( const Vector& mins, const Vector& maxs ) OVERRIDE;
+		virtual void         EndLocalQueries() OVERRIDE;
+};
+
+} // namespace motionlab
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <math.h>
+#include "mathlib/vector.h"
+
+// -------------------------------------------------------------------------------------------------
+// 4-lane vector kernels for motionlab's internal math. A Vec4 is a 16-byte aligned xyz + a w lane
+// that's kept at zero, so dots/lengths can just sum all four lanes.
+//
+// x86 builds get SSE (SSE2 is baseline on anything we ship). AVX would add nothing here - these are
+// single 3-vectors, there's no wider data to fill the lanes with. Define MOTIONLAB_SCALAR_MATH to
+// force the plain C path, e.g. to diff results or for targets without SSE.
+//
+// Everything here is IEEE adds, multiplies, sqrt and divide, which come out the same on any x86 -
+// no rsqrt/rcp estimates, those vary by CPU vendor and would break prediction and replays between
+// machines. Dots sum in a different order than the scalar path, so SSE and MOTIONLAB_SCALAR_MATH
+// builds can differ in the last bit (ml_simdbench shows by how much). Client and server need to be
+// built the same way for prediction to match.
+// -------------------------------------------------------------------------------------------------
+
+#if !defined( MOTIONLAB_SCALAR_MATH ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+	#define MOTIONLAB_SSE 1
+	#include <emmintrin.h>
+#endif
+
+namespace motionlab {
+
+#ifdef MOTIONLAB_SSE
+
+struct Vec4
+{
+	__m128 v;
+};
+
+FORCEINLINE Vec4 Vec4Make( __m128 v )                   { Vec4 r; r.v = v; return r; }
+FORCEINLINE Vec4 Vec4Load( const Vector& a )            { return Vec4Make( _mm_setr_ps( a.x, a.y, a.z, 0.0f ) ); }
+FORCEINLINE Vec4 Vec4Zero()                             { return Vec4Make( _mm_setzero_ps() ); }
+FORCEINLINE Vec4 operator+( const Vec4& a, const Vec4& b ) { return Vec4Make( _mm_add_ps( a.v, b.v ) ); }
+FORCEINLINE Vec4 operator-( const Vec4& a, const Vec4& b ) { return Vec4Make( _mm_sub_ps( a.v, b.v ) ); }
+FORCEINLINE Vec4 operator*( const Vec4& a, float s )       { return Vec4Make( _mm_mul_ps( a.v, _mm_set1_ps( s ) ) ); }
+
+FORCEINLINE Vector Vec4Store( const Vec4& a )
+{
+	ALIGN16 float f[4] ALIGN16_POST;
+	_mm_store_ps( f, a.v );
+	return Vector( f[0], f[1], f[2] );
+}
+
+// Dot product in every lane
+FORCEINLINE __m128 Vec4DotSplat( const Vec4& a, const Vec4& b )
+{
+	__m128 m = _mm_mul_ps( a.v, b.v );
+	m = _mm_add_ps( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	return _mm_add_ps( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+}
+
+FORCEINLINE float Vec4Dot( const Vec4& a, const Vec4& b )
+{
+	return _mm_cvtss_f32( Vec4DotSplat( a, b ) );
+}
+
+FORCEINLINE Vec4 Vec4Cross( const Vec4& a, const Vec4& b )
+{
+	// ( a.yzx * b.zxy ) - ( a.zxy * b.yzx ), w stays 0
+	__m128 aYZX = _mm_shuffle_ps( a.v, a.v, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 bYZX = _mm_shuffle_ps( b.v, b.v, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 c    = _mm_sub_ps( _mm_mul_ps( a.v, bYZX ), _mm_mul_ps( aYZX, b.v ) );
+	return Vec4Make( _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 0, 2, 1 ) ) );
+}
+
+// length/|a| in every lane, 0 for a zero vector. Real sqrt + divide, same as the scalar path.
+FORCEINLINE __m128 Vec4ScaleToSplat( const Vec4& a, float length )
+{
+	__m128 lenSqr = Vec4DotSplat( a, a );
+	__m128 scale  = _mm_div_ps( _mm_set1_ps( length ), _mm_sqrt_ps( lenSqr ) );
+	return _mm_and_ps( scale, _mm_cmpgt_ps( lenSqr, _mm_setzero_ps() ) );  // x/0 = inf, mask it off
+}
+
+FORCEINLINE Vec4 Vec4Normalize( const Vec4& a )
+{
+	return Vec4Make( _mm_mul_ps( a.v, Vec4ScaleToSplat( a, 1.0f ) ) );
+}
+
+FORCEINLINE Vec4 Vec4Rescale( const Vec4& a, float length )
+{
+	return Vec4Make( _mm_mul_ps( a.v, Vec4ScaleToSplat( a, length ) ) );
+}
+
+FORCEINLINE float Vec4Length( const Vec4& a )
+{
+	return _mm_cvtss_f32( _mm_sqrt_ss( Vec4DotSplat( a, a ) ) );
+}
+
+// v - ( v·n )n
+FORCEINLINE Vec4 Vec4ProjectOntoPlane( const Vec4& a, const Vec4& n )
+{
+	return Vec4Make( _mm_sub_ps( a.v, _mm_mul_ps( n.v, Vec4DotSplat( a, n ) ) ) );
+}
+
+#else // scalar fallback
+
+struct ALIGN16 Vec4
+{
+	float x, y, z, w;
+} ALIGN16_POST;
+
+FORCEINLINE Vec4 Vec4Make( float x, float y, float z )  { Vec4 r; r.x = x; r.y = y; r.z = z; r.w = 0.0f; return r; }
+FORCEINLINE Vec4 Vec4Load( const Vector& a )            { return Vec4Make( a.x, a.y, a.z ); }
+FORCEINLINE Vec4 Vec4Zero()                             { return Vec4Make( 0.0f, 0.0f, 0.0f ); }
+FORCEINLINE Vector Vec4Store( const Vec4& a )           { return Vector( a.x, a.y, a.z ); }
+FORCEINLINE Vec4 operator+( const Vec4& a, const Vec4& b ) { return Vec4Make( a.x + b.x, a.y + b.y, a.z + b.z ); }
+FORCEINLINE Vec4 operator-( const Vec4& a, const Vec4& b ) { return Vec4Make( a.x - b.x, a.y - b.y, a.z - b.z ); }
+FORCEINLINE Vec4 operator*( const Vec4& a, float s )       { return Vec4Make( a.x * s, a.y * s, a.z * s ); }
+
+FORCEINLINE float Vec4Dot( const Vec4& a, const Vec4& b )
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+FORCEINLINE Vec4 Vec4Cross( const Vec4& a, const Vec4& b )
+{
+	return Vec4Make( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+
+FORCEINLINE float Vec4Length( const Vec4& a )
+{
+	return sqrtf( Vec4Dot( a, a ) );
+}
+
+FORCEINLINE Vec4 Vec4Normalize( const Vec4& a )
+{
+	float len = Vec4Length( a );
+	return len > 0.0f ? a * ( 1.0f / len ) : Vec4Zero();
+}
+
+FORCEINLINE Vec4 Vec4Rescale( const Vec4& a, float length )
+{
+	float len = Vec4Length( a );
+	return len > 0.0f ? a * ( length / len ) : Vec4Zero();
+}
+
+FORCEINLINE Vec4 Vec4ProjectOntoPlane( const Vec4& a, const Vec4& n )
+{
+	return a - n * Vec4Dot( a, n );
+}
+
+#endif // MOTIONLAB_SSE
+
+
+// Clip velocity against a plane: push it out along the normal by overbounce * the into-plane part,
+// then strip any float noise still pointing into the plane
+FORCEINLINE Vec4 Vec4Deflect( const Vec4& vel, const Vec4& normal, float overbounce )
+{
+	Vec4  deflected = vel - normal * ( Vec4Dot( vel, normal ) * overbounce );
+	float adjust    = Vec4Dot( deflected, normal );
+	if ( adjust < 0.0f )
+	{
+		deflected = deflected - normal * adjust;
+	}
+	return deflected;
+}
+
+} // namespace motionlab
@@ -0,0 +1,169 @@
+#include "cbase.h"
+#include "ml_statecodec.h"
+#include "ml_player.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+static const uint8 CODECFLAG_GROUNDED = 1;
+static const uint8 CODECFLAG_CANJUMP  = 2;
+
+static const QuantizedPlayerState s_ZeroBaseline = {};
+
+
+void motionlab::CapturePlayerState( const MLabPlayer& pl, PlayerNetState& out )
+{
+	out.Velocity       = pl.CurrentVelocity();
+	out.GroundNormal   = pl.CurrentGroundNormal;
+	out.GroundFriction = pl.CurrentGroundFriction;
+	out.Grounded       = pl.IsGrounded;
+	out.CanJump        = pl.CanJump;
+}
+
+
+// ----- Quantization ------------------------------------------------------------------------------
+
+static int RoundClamped( float value, float scale, int limit )
+{
+	int q = (int)floorf( value * scale + 0.5f );
+	return clamp( q, -limit, limit );
+}
+
+
+bool QuantizedPlayerState::operator==( const QuantizedPlayerState& other ) const
+{
+	return Vel[0] == other.Vel[0] && Vel[1] == other.Vel[1] && Vel[2] == other.Vel[2]
+	    && Normal[0] == other.Normal[0] && Normal[1] == other.Normal[1] && NormalZNeg == other.NormalZNeg
+	    && Flags == other.Flags && Friction == other.Friction;
+}
+
+
+void motionlab::QuantizePlayerState( const PlayerNetState& in, QuantizedPlayerState& out )
+{
+	const int velLimit    = ( 1 << ( CODEC_VEL_FULL_BITS - 1 ) ) - 1;
+	const int normalLimit = ( 1 << ( CODEC_NORMAL_BITS - 1 ) ) - 1;
+
+	for ( int i=0; i < 3; ++i )
+	{
+		out.Vel[i] = RoundClamped( in.Velocity[i], COORD_DENOMINATOR, velLimit );
+	}
+	out.Normal[0]  = (int16)RoundClamped( in.GroundNormal.x, NORMAL_DENOMINATOR, normalLimit );
+	out.Normal[1]  = (int16)RoundClamped( in.GroundNormal.y, NORMAL_DENOMINATOR, normalLimit );
+	out.NormalZNeg = in.GroundNormal.z < 0.0f ? 1 : 0;
+	out.Flags      = ( in.Grounded ? CODECFLAG_GROUNDED : 0 ) | ( in.CanJump ? CODECFLAG_CANJUMP : 0 );
+	out.Friction   = (uint16)clamp( (int)floorf( in.GroundFriction * CODEC_FRICTION_SCALE + 0.5f ), 0, ( 1 << CODEC_FRICTION_BITS ) - 1 );
+}
+
+
+// Same reconstruction as bf_read::ReadBitVec3Normal: z from the unit length, sign from the bit
+void motionlab::DequantizePlayerState( const QuantizedPlayerState& in, PlayerNetState& out )
+{
+	for ( int i=0; i < 3; ++i )
+	{
+		out.Velocity[i] = in.Vel[i] * COORD_RESOLUTION;
+	}
+	float x     = in.Normal[0] * NORMAL_RESOLUTION;
+	float y     = in.Normal[1] * NORMAL_RESOLUTION;
+	float zSqr  = 1.0f - x * x - y * y;
+	float z     = zSqr > 0.0f ? sqrtf( zSqr ) : 0.0f;
+	out.GroundNormal.Init( x, y, in.NormalZNeg ? -z : z );
+
+	out.GroundFriction = in.Friction * ( 1.0f / CODEC_FRICTION_SCALE );
+	out.Grounded       = ( in.Flags & CODECFLAG_GROUNDED ) != 0;
+	out.CanJump        = ( in.Flags & CODECFLAG_CANJUMP ) != 0;
+}
+
+
+// ----- Bit packing -------------------------------------------------------------------------------
+
+// Per axis: 0 = same as baseline, 10 = small delta, 11 = full value
+void motionlab::WritePlayerStateDelta( bf_write& buf, const QuantizedPlayerState& state, const QuantizedPlayerState* baseline )
+{
+	const QuantizedPlayerState& base = baseline ? *baseline : s_ZeroBaseline;
+	const int deltaLimit = 1 << ( CODEC_VEL_DELTA_BITS - 1 );
+
+	bool velChanged = state.Vel[0] != base.Vel[0] || state.Vel[1] != base.Vel[1] || state.Vel[2] != base.Vel[2];
+	buf.WriteOneBit( velChanged );
+	if ( velChanged )
+	{
+		for ( int i=0; i < 3; ++i )
+		{
+			int delta = state.Vel[i] - base.Vel[i];
+			buf.WriteOneBit( delta != 0 );
+			if ( delta == 0 )
+			{
+				continue;
+			}
+			bool small = delta >= -deltaLimit && delta < deltaLimit;
+			buf.WriteOneBit( !small );
+			if ( small )
+			{
+				buf.WriteSBitLong( delta, CODEC_VEL_DELTA_BITS );
+			}
+			else
+			{
+				buf.WriteSBitLong( state.Vel[i], CODEC_VEL_FULL_BITS );
+			}
+		}
+	}
+
+	bool normalChanged = state.Normal[0] != base.Normal[0] || state.Normal[1] != base.Normal[1] || state.NormalZNeg != base.NormalZNeg;
+	buf.WriteOneBit( normalChanged );
+	if ( normalChanged )
+	{
+		buf.WriteSBitLong( state.Normal[0], CODEC_NORMAL_BITS );
+		buf.WriteSBitLong( state.Normal[1], CODEC_NORMAL_BITS );
+		buf.WriteOneBit( state.NormalZNeg );
+	}
+
+	bool frictionChanged = state.Friction != base.Friction;
+	buf.WriteOneBit( frictionChanged );
+	if ( frictionChanged )
+	{
+		buf.WriteUBitLong( state.Friction, CODEC_FRICTION_BITS );
+	}
+
+	buf.WriteUBitLong( state.Flags, 2 );
+}
+
+
+bool motionlab::ReadPlayerStateDelta( bf_read& buf, QuantizedPlayerState& state, const QuantizedPlayerState* baseline )
+{
+	const QuantizedPlayerState& base = baseline ? *baseline : s_ZeroBaseline;
+	state = base;
+
+	if ( buf.ReadOneBit() )
+	{
+		for ( int i=0; i < 3; ++i )
+		{
+			if ( !buf.ReadOneBit() )
+			{
+				continue;
+			}
+			if ( buf.ReadOneBit() )
+			{
+				state.Vel[i] = buf.ReadSBitLong( CODEC_VEL_FULL_BITS );
+			}
+			else
+			{
+				state.Vel[i] = base.Vel[i] + buf.ReadSBitLong( CODEC_VEL_DELTA_BITS );
+			}
+		}
+	}
+
+	if ( buf.ReadOneBit() )
+	{
+		state.Normal[0]  = (int16)buf.ReadSBitLong( CODEC_NORMAL_BITS );
+		state.Normal[1]  = (int16)buf.ReadSBitLong( CODEC_NORMAL_BITS );
+		state.NormalZNeg = (uint8)buf.ReadOneBit();
+	}
+
+	if ( buf.ReadOneBit() )
+	{
+		state.Friction = (uint16)buf.ReadUBitLong( CODEC_FRICTION_BITS );
+	}
+
+	state.Flags = (uint8)buf.ReadUBitLong( 2 );
+	return !buf.IsOverflowed();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "coordsize.h"     // COORD_DENOMINATOR, NORMAL_DENOMINATOR
+#include "tier1/bitbuf.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+class MLabPlayer;
+
+// Field widths. Velocity deltas small enough for VEL_DELTA_BITS cover a tick of gravity at 64 tick
+// and up; anything bigger (landing, jumping, teleports) goes out at VEL_FULL_BITS instead.
+constexpr int CODEC_VEL_FULL_BITS     = 19;  // signed, COORD_RESOLUTION units -> +-8192 u/s
+constexpr int CODEC_VEL_DELTA_BITS    = 10;  // signed, +-16 u/s from the baseline
+constexpr int CODEC_NORMAL_BITS       = 12;  // signed x/y, NORMAL_RESOLUTION units, plus a z sign bit
+constexpr int CODEC_FRICTION_BITS     = 10;  // 1/256ths, 0..4
+constexpr int CODEC_FRICTION_SCALE    = 256;
+constexpr int CODEC_MAX_BITS          = 1 + 3 * ( 2 + CODEC_VEL_FULL_BITS )   // velocity
+                                      + 1 + 2 * CODEC_NORMAL_BITS + 1         // ground normal
+                                      + 1 + CODEC_FRICTION_BITS               // friction
+                                      + 2;                                    // flags
+
+
+// The motionlab slice of a player's state that gets sent or saved - MLabPlayer's velocity and
+// ground contact. (Origin isn't here, the engine already networks it.)
+struct PlayerNetState
+{
+	Vector Velocity;
+	Vector GroundNormal;
+	float  GroundFriction;
+	bool   Grounded;
+	bool   CanJump;
+};
+
+void CapturePlayerState( const MLabPlayer& pl, PlayerNetState& out );
+
+
+// Quantized form. This is what both ends keep as a baseline - never a raw PlayerNetState - so
+// the encoder deltas against exactly what the decoder has.
+struct QuantizedPlayerState
+{
+	int32  Vel[3];      // COORD_RESOLUTION units
+	int16  Normal[2];   // x/y in NORMAL_RESOLUTION units
+	uint8  NormalZNeg;
+	uint8  Flags;
+	uint16 Friction;    // 1/CODEC_FRICTION_SCALE units
+
+	bool operator==( const QuantizedPlayerState& other ) const;
+};
+
+void QuantizePlayerState( const PlayerNetState& in, QuantizedPlayerState& out );
+void DequantizePlayerState( const QuantizedPlayerState& in, PlayerNetState& out );
+
+
+// -------------------------------------------------------------------------------------------------
+// Bit-packed delta coding on bf_write/bf_read. Each field group gets a changed bit against the
+// baseline, velocity axes go as a small delta when they can, flags always go (2 bits, cheaper than
+// a changed bit for them). A NULL baseline deltas against all zeros. A player standing still
+// costs 5 bits; running on flat ground is typically 1-2 small velocity deltas.
+// Read returns false if the buffer ran out.
+// -------------------------------------------------------------------------------------------------
+void WritePlayerStateDelta( bf_write& buf, const QuantizedPlayerState& state, const QuantizedPlayerState* baseline );
+bool ReadPlayerStateDelta( bf_read& buf, QuantizedPlayerState& state, const QuantizedPlayerState* baseline );
+
+} // namespace motionlab
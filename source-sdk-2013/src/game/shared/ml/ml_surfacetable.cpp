@@ -0,0 +1,89 @@
+#include "cbase.h"
+#include "ml_surfacetable.h"
+#include "ml_backend.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+void SurfaceTable::Clear()
+{
+	Entries.RemoveAll();
+}
+
+
+int SurfaceTable::Add( const surfacedata& srf )
+{
+	SurfaceEntry entry;
+	entry.Friction     = srf.physics.friction;
+	entry.GameMaterial = srf.game.material;
+	entry.StepLeft     = srf.sounds.stepleft;
+	entry.StepRight    = srf.sounds.stepright;
+	return Entries.AddToTail( entry );
+}
+
+
+// Missing props get a default-ish entry so indices still line up with surfaceProps
+void SurfaceTable::Build( const MotionBackend& backend )
+{
+	Clear();
+
+	int count = backend.SurfacePropCount();
+	Entries.EnsureCapacity( count );
+	for ( int i=0; i < count; ++i )
+	{
+		const surfacedata* srf = backend.SurfaceData( i );
+		if ( srf )
+		{
+			Add( *srf );
+		}
+		else
+		{
+			SurfaceEntry& entry = Entries[ Entries.AddToTail() ];
+			entry.Friction      = 1.0f;
+			entry.GameMaterial  = 0;
+			entry.StepLeft      = 0;
+			entry.StepRight     = 0;
+		}
+	}
+}
+
+
+int SurfaceTable::Count() const
+{
+	return Entries.Count();
+}
+
+
+const SurfaceEntry* SurfaceTable::Get( int surfaceProps ) const
+{
+	return Entries.IsValidIndex( surfaceProps ) ? &Entries[ surfaceProps ] : NULL;
+}
+
+
+#ifndef MOTIONLAB_HEADLESS
+
+SurfaceTable motionlab::g_MotionSurfaces;
+
+// Rebuilds g_MotionSurfaces before any entity spawns, so it's ready by the first PlayerMove
+class CMotionSurfaceTableSystem : public CAutoGameSystem
+{
+	public:
+		CMotionSurfaceTableSystem() : CAutoGameSystem( "CMotionSurfaceTableSystem" ) {}
+
+		virtual void LevelInitPreEntity() OVERRIDE
+		{
+			EngineMotionBackend backend;
+			g_MotionSurfaces.Build( backend );
+		}
+
+		virtual void LevelShutdownPostEntity() OVERRIDE
+		{
+			g_MotionSurfaces.Clear();
+		}
+};
+
+static CMotionSurfaceTableSystem g_MotionSurfaceTableSystem;
+
+#endif // MOTIONLAB_HEADLESS
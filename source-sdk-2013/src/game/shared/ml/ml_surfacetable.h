@@ -0,0 +1,47 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+class MotionBackend;
+
+// The handful of surfacedata fields motionlab actually reads, packed together
+struct SurfaceEntry
+{
+	float          Friction;
+	char           GameMaterial;
+	unsigned short StepLeft;   // step sound handles, as in surfacedata sounds
+	unsigned short StepRight;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// Flat copy of the surface property table, indexed by surface.surfaceProps. Ground evaluation
+// touches this every tick for every player, so it's one array load instead of a walk through
+// MoveHelper() and IPhysicsSurfaceProps. The game DLLs rebuild the global one on every level
+// init (surface props can't change mid-map); headless worlds keep their own up to date as
+// surfaces get added.
+// -------------------------------------------------------------------------------------------------
+class SurfaceTable
+{
+	private:
+		CUtlVector<SurfaceEntry> Entries;
+
+	public:
+		void                Clear();
+		int                 Add( const surfacedata& srf );
+		void                Build( const MotionBackend& backend );
+
+		int                 Count() const;
+		const SurfaceEntry* Get( int surfaceProps ) const;  // NULL if out of range
+};
+
+
+#ifndef MOTIONLAB_HEADLESS
+// Rebuilt on level init, what EngineMotionBackend hands out
+extern SurfaceTable g_MotionSurfaces;
+#endif
+
+} // namespace motionlab
@@ -0,0 +1,226 @@
+#include "cbase.h"
+#include "ml_telemetry.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+static const int TELEMETRY_DRAIN_BATCH = 1024;  // records per write
+static const int TELEMETRY_DRAIN_MS    = 20;    // writer wakeup interval
+
+
+// ------------------------------------------------------------------------------------------------
+// TelemetryRing
+// ------------------------------------------------------------------------------------------------
+
+TelemetryRing::TelemetryRing( int capacity )
+{
+	int rounded = SmallestPowerOfTwoGreaterOrEqual( MAX( capacity, 2 ) );
+	Records.SetCount( rounded );
+	Mask           = rounded - 1;
+	Head           = 0;
+	Tail           = 0;
+	PublishedCount = 0;
+	DroppedCount   = 0;
+}
+
+
+// Head/Tail are free-running, the slot is just the low bits. The release on Head is what makes
+// the record visible to Pop; the acquire on Tail is what says Pop is done with the slot we're reusing.
+bool TelemetryRing::Push( const TelemetryRecord& rec )
+{
+	uint32 head = Head.load( std::memory_order_relaxed );
+	uint32 tail = Tail.load( std::memory_order_acquire );
+	if ( head - tail > Mask )
+	{
+		DroppedCount.store( DroppedCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		return false;
+	}
+
+	Records[ head & Mask ] = rec;
+	Head.store( head + 1, std::memory_order_release );
+	PublishedCount.store( PublishedCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	return true;
+}
+
+
+int TelemetryRing::Pop( TelemetryRecord* out, int maxOut )
+{
+	uint32 tail  = Tail.load( std::memory_order_relaxed );
+	uint32 head  = Head.load( std::memory_order_acquire );
+	int    count = MIN( (int)( head - tail ), maxOut );
+	for ( int i=0; i < count; ++i )
+	{
+		out[i] = Records[ ( tail + i ) & Mask ];
+	}
+	Tail.store( tail + count, std::memory_order_release );
+	return count;
+}
+
+
+uint64 TelemetryRing::Published() const
+{
+	return PublishedCount.load( std::memory_order_relaxed );
+}
+
+
+uint64 TelemetryRing::Dropped() const
+{
+	return DroppedCount.load( std::memory_order_relaxed );
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TelemetryStream
+// ------------------------------------------------------------------------------------------------
+
+TelemetryStream::TelemetryStream()
+{
+	RingCapacity = 0;
+	Quit         = false;
+	WrittenCount = 0;
+}
+
+
+TelemetryStream::~TelemetryStream()
+{
+	Stop();
+}
+
+
+bool TelemetryStream::Start( const char* path, int ringCapacity )
+{
+	Stop();
+
+	if ( !File.Open( path ) )
+	{
+		return false;
+	}
+
+	uint32 header[3] = { TELEMETRY_MAGIC, TELEMETRY_VERSION, sizeof( TelemetryRecord ) };
+	File.Write( header, sizeof( header ) );
+
+	RingCapacity = ringCapacity;
+	WrittenCount = 0;
+	Quit         = false;
+	Writer       = std::thread( &TelemetryStream::WriterMain, this );
+	return true;
+}
+
+
+void TelemetryStream::Stop()
+{
+	if ( !File.IsOpen() )
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( WakeMutex );
+		Quit = true;
+	}
+	WakeCond.notify_one();
+	Writer.join();  // drains everything on the way out
+
+	File.Close();
+
+	std::lock_guard<std::mutex> lock( RingsMutex );
+	Rings.PurgeAndDeleteElements();
+}
+
+
+bool TelemetryStream::IsRunning() const
+{
+	return File.IsOpen();
+}
+
+
+TelemetryRing* TelemetryStream::AddProducer()
+{
+	if ( !File.IsOpen() )
+	{
+		return NULL;
+	}
+	std::lock_guard<std::mutex> lock( RingsMutex );
+	TelemetryRing* ring = new TelemetryRing( RingCapacity );
+	Rings.AddToTail( ring );
+	return ring;
+}
+
+
+uint64 TelemetryStream::Published() const
+{
+	std::lock_guard<std::mutex> lock( RingsMutex );
+	uint64 total = 0;
+	for ( int i=0; i < Rings.Count(); ++i )
+	{
+		total += Rings[i]->Published();
+	}
+	return total;
+}
+
+
+uint64 TelemetryStream::Dropped() const
+{
+	std::lock_guard<std::mutex> lock( RingsMutex );
+	uint64 total = 0;
+	for ( int i=0; i < Rings.Count(); ++i )
+	{
+		total += Rings[i]->Dropped();
+	}
+	return total;
+}
+
+
+uint64 TelemetryStream::Written() const
+{
+	return WrittenCount.load( std::memory_order_relaxed );
+}
+
+
+void TelemetryStream::WriteRecords( const TelemetryRecord* recs, int count )
+{
+	File.Write( recs, count * sizeof( TelemetryRecord ) );
+	WrittenCount.fetch_add( count, std::memory_order_relaxed );
+}
+
+
+// One pass over every ring, returns how many records went out
+int TelemetryStream::DrainAll( TelemetryRecord* scratch, int scratchSize )
+{
+	std::lock_guard<std::mutex> lock( RingsMutex );
+	int total = 0;
+	for ( int i=0; i < Rings.Count(); ++i )
+	{
+		int n;
+		while ( ( n = Rings[i]->Pop( scratch, scratchSize ) ) > 0 )
+		{
+			WriteRecords( scratch, n );
+			total += n;
+		}
+	}
+	return total;
+}
+
+
+// Producers never signal us (that'd mean a syscall on the tick path), so just wake up every so often
+void TelemetryStream::WriterMain()
+{
+	CUtlVector<TelemetryRecord> scratch;
+	scratch.SetCount( TELEMETRY_DRAIN_BATCH );
+
+	for ( ;; )
+	{
+		bool quit;
+		{
+			std::unique_lock<std::mutex> lock( WakeMutex );
+			WakeCond.wait_for( lock, std::chrono::milliseconds( TELEMETRY_DRAIN_MS ), [this] { return Quit; } );
+			quit = Quit;
+		}
+		DrainAll( scratch.Base(), scratch.Count() );
+		if ( quit )
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "tier1/utlvector.h"
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_file.h"
+
+namespace motionlab {
+
+// Which way Move() went after its first slide
+enum TelemetryStepPath
+{
+	TELEM_STEP_NONE = 0,  // slide came through clean, no step considered
+	TELEM_STEP_TAKEN,     // stepped path got further
+	TELEM_STEP_STRAIGHT,  // straight slide got further
+	TELEM_STEP_STEEP,     // stepped onto unstandable ground, kept the straight slide
+	TELEM_STEP_SKIPPED,   // blocked, but nothing it hit could be stepped over (PredictiveStep)
+};
+
+constexpr uint8 TELEMFLAG_GROUNDED = 1;
+constexpr uint8 TELEMFLAG_JUMPED   = 2;
+constexpr uint8 TELEMFLAG_CANJUMP  = 4;
+
+
+// One player, one tick, end of PlayerMove. Fixed size POD, written to disk as is.
+struct TelemetryRecord
+{
+	int32  Tick;
+	int16  Player;
+	uint8  Flags;           // TELEMFLAG_*
+	uint8  StepPath;        // TelemetryStepPath
+	uint8  BumpsUsed;       // slide bump traces, Step's second slide included
+	uint8  Pad[3];
+	Vector Position;
+	Vector Velocity;
+	Vector GroundNormal;
+	float  GroundFriction;
+
+	// ForceResult, as the force model left it
+	Vector NetForce;
+	Vector WASDForce;
+	Vector FrictionForce;
+	Vector JumpForce;
+	Vector GravForce;
+};
+
+constexpr uint32 TELEMETRY_MAGIC   = 0x4D544C4D;  // "MLTM"
+constexpr uint32 TELEMETRY_VERSION = 1;
+
+
+// -------------------------------------------------------------------------------------------------
+// Single producer / single consumer ring of telemetry records. The producer is whichever thread
+// owns the MotionDriver it's attached to, the consumer is TelemetryStream's writer thread. Push
+// never blocks or allocates - if the writer has fallen behind the record is dropped and counted.
+// -------------------------------------------------------------------------------------------------
+class TelemetryRing
+{
+	public:
+		explicit TelemetryRing( int capacity );  // rounded up to a power of 2
+
+		bool   Push( const TelemetryRecord& rec );         // producer side, false = dropped
+		int    Pop( TelemetryRecord* out, int maxOut );    // consumer side, returns how many
+
+		uint64 Published() const;
+		uint64 Dropped() const;
+
+	private:
+		CUtlVector<TelemetryRecord> Records;
+		uint32                      Mask;
+
+		// Head only moves on the producer, Tail only on the consumer. Kept on separate cache lines
+		// so the two threads aren't fighting over one.
+		alignas( 64 ) std::atomic<uint32> Head;
+		alignas( 64 ) std::atomic<uint32> Tail;
+		alignas( 64 ) std::atomic<uint64> PublishedCount;
+		std::atomic<uint64>               DroppedCount;
+};
+
+
+// -------------------------------------------------------------------------------------------------
+// A telemetry file plus the background thread that fills it. Give every MotionDriver that should
+// publish its own ring from AddProducer() (MotionDriver::SetTelemetry) - one ring per driver, so
+// one producer per ring, as long as a driver only ever runs on one thread at a time.
+// Stop() drains what's left and frees the rings, so detach every driver from them first.
+// -------------------------------------------------------------------------------------------------
+class TelemetryStream
+{
+	public:
+		TelemetryStream();
+		~TelemetryStream();
+
+		bool           Start( const char* path, int ringCapacity );
+		void           Stop();
+		bool           IsRunning() const;
+		TelemetryRing* AddProducer();  // not for the tick path, takes a lock
+
+		// Totals over every ring
+		uint64         Published() const;
+		uint64         Dropped() const;
+		uint64         Written() const;
+
+	private:
+		OutputFile                  File;
+		int                         RingCapacity;
+		CUtlVector<TelemetryRing*>  Rings;
+		mutable std::mutex          RingsMutex;
+		std::thread                 Writer;
+		std::mutex                  WakeMutex;
+		std::condition_variable     WakeCond;
+		bool                        Quit;
+		std::atomic<uint64>         WrittenCount;
+
+		void           WriterMain();
+		int            DrainAll( TelemetryRecord* scratch, int scratchSize );
+		void           WriteRecords( const TelemetryRecord* recs, int count );
+};
+
+} // namespace motionlab
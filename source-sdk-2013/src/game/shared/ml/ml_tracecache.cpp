@@ -0,0 +1,55 @@
+#include "cbase.h"
+#include "ml_tracecache.h"
+
+using namespace motionlab;
+
+
+TraceCache::TraceCache()
+{
+	Hits   = 0;
+	Misses = 0;
+	Reset();
+}
+
+
+// MDriver calls this on tick entry - results from last tick (or another player) are never valid
+void TraceCache::Reset()
+{
+	Count    = 0;
+	NextSlot = 0;
+}
+
+
+bool TraceCache::Lookup( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                         unsigned int mask, hulltrace& tr )
+{
+	for ( int i=0; i < Count; ++i )
+	{
+		const Entry& e = Entries[i];
+		if ( e.Start == start && e.End == end && e.Mins == mins && e.Maxs == maxs && e.Mask == mask )
+		{
+			tr = e.Result;
+			++Hits;
+			return true;
+		}
+	}
+	++Misses;
+	return false;
+}
+
+
+// Overwrites the oldest entry once full
+void TraceCache::Store( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+                        unsigned int mask, const hulltrace& tr )
+{
+	Entry& e  = Entries[ NextSlot ];
+	e.Start   = start;
+	e.End     = end;
+	e.Mins    = mins;
+	e.Maxs    = maxs;
+	e.Mask    = mask;
+	e.Result  = tr;
+
+	NextSlot = ( NextSlot + 1 ) % TRACE_CACHE_SIZE;
+	Count    = MIN( Count + 1, TRACE_CACHE_SIZE );
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+
+namespace motionlab {
+
+constexpr int TRACE_CACHE_SIZE = 16;  // a worst-case colliding tick does ~25 traces, most unique
+
+// -------------------------------------------------------------------------------------------------
+// Per-tick memo of hull trace results, keyed on (start, end, mins, maxs, mask). MotionDriver resets
+// it on tick entry. Nothing in the world moves during a single PlayerMove, so an identical query
+// within the tick gets an identical answer. Small fixed ring - linear search beats hashing here.
+// -------------------------------------------------------------------------------------------------
+class TraceCache
+{
+	private:
+		struct Entry
+		{
+			Vector       Start;
+			Vector       End;
+			Vector       Mins;
+			Vector       Maxs;
+			unsigned int Mask;
+			hulltrace    Result;
+		};
+
+		Entry Entries[ TRACE_CACHE_SIZE ];
+		int   Count;
+		int   NextSlot;
+
+	public:
+		TraceCache();
+		void  Reset();
+
+		bool  Lookup( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		              unsigned int mask, hulltrace& tr );
+		void  Store( const Vector& start, const Vector& end, const Vector& mins, const Vector& maxs,
+		             unsigned int mask, const hulltrace& tr );
+
+		// Lifetime counters, never reset by Reset()
+		int64 Hits;
+		int64 Misses;
+};
+
+} // namespace motionlab
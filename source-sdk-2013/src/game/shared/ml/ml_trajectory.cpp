@@ -0,0 +1,288 @@
+#include "cbase.h"
+#include "ml_trajectory.h"
+#include "ml_telemetry.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace motionlab;
+
+
+static const char* s_ColumnNames[ TRAJ_COLUMN_COUNT ] =
+{
+	"tick",
+	"player",
+	"pos_x",
+	"pos_y",
+	"pos_z",
+	"vel_x",
+	"vel_y",
+	"vel_z",
+	"speed",
+	"force_x",
+	"force_y",
+	"force_z",
+	"normal_x",
+	"normal_y",
+	"normal_z",
+	"friction",
+	"flags",
+	"steppath",
+	"bumps",
+};
+
+
+const char* motionlab::TrajColumnName( int column )
+{
+	return ( column >= 0 && column < TRAJ_COLUMN_COUNT ) ? s_ColumnNames[ column ] : "?";
+}
+
+
+TrajColumnType motionlab::TrajColumnTypeOf( int column )
+{
+	switch ( column )
+	{
+		case TRAJ_TICK:
+		case TRAJ_PLAYER:
+			return TRAJTYPE_INT32;
+		case TRAJ_FLAGS:
+		case TRAJ_STEPPATH:
+		case TRAJ_BUMPS:
+			return TRAJTYPE_UINT8;
+		default:
+			return TRAJTYPE_FLOAT;
+	}
+}
+
+
+int motionlab::TrajColumnSize( int column )
+{
+	return TrajColumnTypeOf( column ) == TRAJTYPE_UINT8 ? 1 : 4;
+}
+
+
+void motionlab::SampleFromTelemetry( const TelemetryRecord& rec, TrajectorySample& out )
+{
+	out.Tick           = rec.Tick;
+	out.Player         = rec.Player;
+	out.Position       = rec.Position;
+	out.Velocity       = rec.Velocity;
+	out.NetForce       = rec.NetForce;
+	out.GroundNormal   = rec.GroundNormal;
+	out.GroundFriction = rec.GroundFriction;
+	out.Flags          = rec.Flags;
+	out.StepPath       = rec.StepPath;
+	out.Bumps          = rec.BumpsUsed;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TrajectoryWriter
+// ------------------------------------------------------------------------------------------------
+
+TrajectoryWriter::TrajectoryWriter()
+{
+	ChunkRows  = 0;
+	StagedRows = 0;
+	FileOffset = 0;
+	Rows       = 0;
+}
+
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+	Close();
+}
+
+
+bool TrajectoryWriter::Open( const char* path, int chunkRows )
+{
+	Close();
+
+	if ( !File.Open( path ) )
+	{
+		return false;
+	}
+
+	ChunkRows  = MAX( chunkRows, 1 );
+	StagedRows = 0;
+	FileOffset = 0;
+	Rows       = 0;
+	ChunkOffsets.RemoveAll();
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		Columns[c].SetCount( ChunkRows * TrajColumnSize( c ) );
+	}
+
+	TrajFileHeader header;
+	header.Magic       = TRAJ_MAGIC;
+	header.Version     = TRAJ_VERSION;
+	header.ColumnCount = TRAJ_COLUMN_COUNT;
+	header.Align       = TRAJ_ALIGN;
+	Write( &header, sizeof( header ) );
+	Pad();
+	return true;
+}
+
+
+void TrajectoryWriter::Close()
+{
+	if ( !File.IsOpen() )
+	{
+		return;
+	}
+
+	FlushChunk();
+
+	TrajFooter footer;
+	footer.IndexOffset = FileOffset;
+	footer.ChunkCount  = ChunkOffsets.Count();
+	footer.Magic       = TRAJ_FOOTER_MAGIC;
+	if ( ChunkOffsets.Count() )
+	{
+		Write( ChunkOffsets.Base(), ChunkOffsets.Count() * sizeof( uint64 ) );
+	}
+	Write( &footer, sizeof( footer ) );
+
+	File.Close();
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		Columns[c].Purge();
+	}
+}
+
+
+bool TrajectoryWriter::IsOpen() const
+{
+	return File.IsOpen();
+}
+
+
+int64 TrajectoryWriter::RowsWritten() const
+{
+	return Rows;
+}
+
+
+int TrajectoryWriter::ChunksWritten() const
+{
+	return ChunkOffsets.Count();
+}
+
+
+// (AlignValue goes through uintp, which would chop 64-bit offsets on 32-bit builds)
+static inline uint64 AlignOffset( uint64 offset )
+{
+	return ( offset + TRAJ_ALIGN - 1 ) & ~(uint64)( TRAJ_ALIGN - 1 );
+}
+
+
+template <typename T>
+static inline void PutValue( CUtlVector<uint8>& column, int row, T value )
+{
+	( (T*)column.Base() )[ row ] = value;
+}
+
+
+void TrajectoryWriter::Append( const TrajectorySample& s )
+{
+	if ( !File.IsOpen() )
+	{
+		return;
+	}
+
+	int row = StagedRows;
+	PutValue<int32>( Columns[ TRAJ_TICK ],     row, s.Tick );
+	PutValue<int32>( Columns[ TRAJ_PLAYER ],   row, s.Player );
+	for ( int i=0; i < 3; ++i )
+	{
+		PutValue<float>( Columns[ TRAJ_POS_X + i ],    row, s.Position[i] );
+		PutValue<float>( Columns[ TRAJ_VEL_X + i ],    row, s.Velocity[i] );
+		PutValue<float>( Columns[ TRAJ_FORCE_X + i ],  row, s.NetForce[i] );
+		PutValue<float>( Columns[ TRAJ_NORMAL_X + i ], row, s.GroundNormal[i] );
+	}
+	PutValue<float>( Columns[ TRAJ_SPEED ],    row, s.Velocity.Length() );
+	PutValue<float>( Columns[ TRAJ_FRICTION ], row, s.GroundFriction );
+	PutValue<uint8>( Columns[ TRAJ_FLAGS ],    row, s.Flags );
+	PutValue<uint8>( Columns[ TRAJ_STEPPATH ], row, s.StepPath );
+	PutValue<uint8>( Columns[ TRAJ_BUMPS ],    row, s.Bumps );
+
+	if ( ++StagedRows == ChunkRows )
+	{
+		FlushChunk();
+	}
+}
+
+
+void TrajectoryWriter::Write( const void* data, int bytes )
+{
+	File.Write( data, bytes );
+	FileOffset += bytes;
+}
+
+
+void TrajectoryWriter::Pad()
+{
+	static const uint8 zeros[ TRAJ_ALIGN ] = {};
+	int pad = (int)( AlignOffset( FileOffset ) - FileOffset );
+	if ( pad )
+	{
+		Write( zeros, pad );
+	}
+}
+
+
+static double ColumnValue( const CUtlVector<uint8>& column, TrajColumnType type, int row )
+{
+	switch ( type )
+	{
+		case TRAJTYPE_INT32: return ( (const int32*)column.Base() )[ row ];
+		case TRAJTYPE_UINT8: return column[ row ];
+		default:             return ( (const float*)column.Base() )[ row ];
+	}
+}
+
+
+// Header first (offsets and stats are all known up front), then each column padded out to TRAJ_ALIGN
+void TrajectoryWriter::FlushChunk()
+{
+	if ( !StagedRows )
+	{
+		return;
+	}
+
+	TrajChunkHeader header;
+	Q_memset( &header, 0, sizeof( header ) );
+	header.Magic = TRAJ_CHUNK_MAGIC;
+	header.Rows  = StagedRows;
+
+	uint64 offset = AlignOffset( sizeof( header ) );
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		TrajColumnType type = TrajColumnTypeOf( c );
+		double lo = ColumnValue( Columns[c], type, 0 );
+		double hi = lo;
+		for ( int row=1; row < StagedRows; ++row )
+		{
+			double v = ColumnValue( Columns[c], type, row );
+			lo = MIN( lo, v );
+			hi = MAX( hi, v );
+		}
+		header.Min[c]          = lo;
+		header.Max[c]          = hi;
+		header.ColumnOffset[c] = offset;
+		offset                 = AlignOffset( offset + (uint64)StagedRows * TrajColumnSize( c ) );
+	}
+	header.Size = offset;
+
+	ChunkOffsets.AddToTail( FileOffset );
+	Write( &header, sizeof( header ) );
+	Pad();
+	for ( int c=0; c < TRAJ_COLUMN_COUNT; ++c )
+	{
+		Write( Columns[c].Base(), StagedRows * TrajColumnSize( c ) );
+		Pad();
+	}
+
+	Rows      += StagedRows;
+	StagedRows = 0;
+}
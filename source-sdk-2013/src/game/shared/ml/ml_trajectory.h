@@ -0,0 +1,148 @@
+#pragma once
+
+#include "tier1/utlvector.h"
+#include "mathlib/vector.h"
+#include "ml_defs.h"
+#include "ml_file.h"
+
+namespace motionlab {
+
+struct TelemetryRecord;
+
+// -------------------------------------------------------------------------------------------------
+// Trajectory file format (.mltj). Columnar and chunked, so analysis can map the file and read
+// straight out of it:
+//
+//   TrajFileHeader
+//   chunk*     TrajChunkHeader, then each column's values as a packed array
+//   index      uint64 file offset of every chunk
+//   TrajFooter
+//
+// Chunks and every column inside them start on TRAJ_ALIGN bytes, so a mapped column is a plain
+// aligned float*/int32*/uint8*. Each chunk header carries per-column min/max, so a query can skip
+// whole chunks without touching their data. Everything is little-endian and written as is.
+// A file whose writer died early has no index/footer but is still readable by walking the chunks.
+// Bump TRAJ_VERSION whenever any of this changes.
+// -------------------------------------------------------------------------------------------------
+constexpr uint32 TRAJ_MAGIC         = 0x4A544C4D;  // "MLTJ"
+constexpr uint32 TRAJ_CHUNK_MAGIC   = 0x4B434C4D;  // "MLCK"
+constexpr uint32 TRAJ_FOOTER_MAGIC  = 0x46544C4D;  // "MLTF"
+constexpr uint32 TRAJ_VERSION       = 1;
+constexpr int    TRAJ_ALIGN         = 64;
+constexpr int    TRAJ_DEFAULT_CHUNK = 8192;        // rows
+
+// One row per player per tick
+enum TrajColumn
+{
+	TRAJ_TICK = 0,
+	TRAJ_PLAYER,
+	TRAJ_POS_X,
+	TRAJ_POS_Y,
+	TRAJ_POS_Z,
+	TRAJ_VEL_X,
+	TRAJ_VEL_Y,
+	TRAJ_VEL_Z,
+	TRAJ_SPEED,     // |velocity|, stored so speed queries can prune on it
+	TRAJ_FORCE_X,   // net force
+	TRAJ_FORCE_Y,
+	TRAJ_FORCE_Z,
+	TRAJ_NORMAL_X,  // ground normal
+	TRAJ_NORMAL_Y,
+	TRAJ_NORMAL_Z,
+	TRAJ_FRICTION,
+	TRAJ_FLAGS,     // TELEMFLAG_*
+	TRAJ_STEPPATH,  // TelemetryStepPath
+	TRAJ_BUMPS,
+
+	TRAJ_COLUMN_COUNT
+};
+
+enum TrajColumnType
+{
+	TRAJTYPE_INT32 = 0,
+	TRAJTYPE_FLOAT,
+	TRAJTYPE_UINT8,
+};
+
+const char*    TrajColumnName( int column );
+TrajColumnType TrajColumnTypeOf( int column );
+int            TrajColumnSize( int column );  // bytes per value
+
+
+struct TrajFileHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 ColumnCount;
+	uint32 Align;
+};
+
+struct TrajChunkHeader
+{
+	uint32 Magic;
+	uint32 Rows;
+	uint64 Size;                              // header + columns + padding, i.e. offset of the next chunk
+	uint64 ColumnOffset[ TRAJ_COLUMN_COUNT ]; // from the start of this chunk
+	double Min[ TRAJ_COLUMN_COUNT ];
+	double Max[ TRAJ_COLUMN_COUNT ];
+};
+
+struct TrajFooter
+{
+	uint64 IndexOffset;
+	uint32 ChunkCount;
+	uint32 Magic;
+};
+
+
+// Unpacked row
+struct TrajectorySample
+{
+	int    Tick;
+	int    Player;
+	Vector Position;
+	Vector Velocity;
+	Vector NetForce;
+	Vector GroundNormal;
+	float  GroundFriction;
+	uint8  Flags;
+	uint8  StepPath;
+	uint8  Bumps;
+};
+
+void SampleFromTelemetry( const TelemetryRecord& rec, TrajectorySample& out );
+
+
+// -------------------------------------------------------------------------------------------------
+// Streaming writer. Rows are staged column by column in memory and go out a chunk at a time, so
+// memory use is one chunk whatever the file size. Close() writes the index and footer.
+// -------------------------------------------------------------------------------------------------
+class TrajectoryWriter
+{
+	public:
+		TrajectoryWriter();
+		~TrajectoryWriter();
+
+		bool   Open( const char* path, int chunkRows = TRAJ_DEFAULT_CHUNK );
+		void   Close();
+		bool   IsOpen() const;
+
+		void   Append( const TrajectorySample& sample );
+		int64  RowsWritten() const;  // flushed rows, not counting the chunk being staged
+		int    ChunksWritten() const;
+
+	private:
+		OutputFile         File;
+		int                ChunkRows;
+		int                StagedRows;
+		CUtlVector<uint8>  Columns[ TRAJ_COLUMN_COUNT ];
+		CUtlVector<uint64> ChunkOffsets;
+		uint64             FileOffset;
+		int64              Rows;
+
+		void   Write( const void* data, int bytes );
+		void   Pad();  // zeros up to the next TRAJ_ALIGN
+		void   FlushChunk();
+};
+
+} // namespace motionlab